@@ -0,0 +1,491 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Replay a recorded log of control inputs and measurements (u, z) through a
+// Kalman estimator, optionally with a bi-quad low-pass filter on z, writing
+// the estimates as they are computed and reporting the samples per second.
+//
+// Logs:
+// - binary: records of two doubles u, z in native byte order, memory-mapped
+//   where available (POSIX), otherwise read in blocks;
+// - CSV: lines 'u,z', lines starting with '#' are skipped, read buffered.
+//
+// Estimates, in the format of the input:
+// - binary: records of three doubles t, position, velocity;
+// - CSV: lines 't,position,velocity'.
+//
+// The model is that of kalman-sim.e.cpp: a constant velocity system with
+// position measurement and commanded acceleration. Use --generate to write
+// a synthetic log of that system to replay.
+
+#include "dsp/filter.hpp"
+#include "dsp/biquad-cascade.hpp"
+#include "dsp/kalman.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+# define ke_HAVE_MMAP  1
+#else
+# define ke_HAVE_MMAP  0
+#endif
+
+// Kalman estimator type, filter cascade type:
+
+using kalman = num::kalman
+<
+#ifdef KE_NUMERIC_TYPE
+    KE_NUMERIC_TYPE
+#else
+    double  // numeric type for computations
+#endif
+    , 2     // 2d system
+    , 1     // single measurement
+    , 1     // single control input
+>;
+
+using real_t  = kalman::real_t;
+using cascade = dsp::BiQuadCascadeT<real_t, 2>;
+
+// Size of the I/O buffers:
+
+const std::size_t io_buffer_size = 1 << 20;
+
+// Options:
+
+enum class format { csv, binary };
+
+struct options
+{
+    std::string input;              // log to replay, "-" for stdin
+    std::string output = "-";       // estimates, "-" for stdout
+    format fmt = format::binary;    // format of log and estimates
+    bool explicit_format = false;   // format given with -f
+    double dt = 1;                  // time step [s]
+    double measnoise = 10;          // position measurement noise [m]
+    double accelnoise = 0.2;        // acceleration noise [m/s^2]
+    double lowpass = 0;             // cut-off frequency of filter on z [Hz], 0: none
+    long generate = 0;              // number of samples of synthetic log to write
+};
+
+int usage( char const * name )
+{
+    std::fprintf( stderr,
+        "Usage: %s [options] input [output]\n"
+        "\n"
+        "Replay log 'input' of (u, z) through a Kalman estimator, write the estimates\n"
+        "to 'output', default stdout; use '-' for stdin or stdout.\n"
+        "\n"
+        "Options:\n"
+        "  -f csv|bin       format of log and estimates, default by extension of input\n"
+        "  --dt s           time step [s], default 1\n"
+        "  --measnoise m    position measurement noise [m], default 10\n"
+        "  --accelnoise a   acceleration noise [m/s^2], default 0.2\n"
+        "  --lowpass fc     filter z with a 2-section low-pass of cut-off fc [Hz] first\n"
+        "  --generate n     write a synthetic log of n samples to 'input', do not replay\n"
+        , name );
+    return 2;
+}
+
+bool ends_with( std::string const & text, char const * tail )
+{
+    const auto n = std::strlen( tail );
+    return text.size() >= n && text.compare( text.size() - n, n, tail ) == 0;
+}
+
+bool parse( int argc, char * argv[], options & opt )
+{
+    int pos = 0;
+
+    for ( int i = 1; i < argc; ++i )
+    {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if      ( arg == "-f"           && has_value ) { opt.fmt = std::string( argv[++i] ) == "csv" ? format::csv : format::binary; opt.explicit_format = true; }
+        else if ( arg == "--dt"         && has_value ) { opt.dt         = std::atof( argv[++i] ); }
+        else if ( arg == "--measnoise"  && has_value ) { opt.measnoise  = std::atof( argv[++i] ); }
+        else if ( arg == "--accelnoise" && has_value ) { opt.accelnoise = std::atof( argv[++i] ); }
+        else if ( arg == "--lowpass"    && has_value ) { opt.lowpass    = std::atof( argv[++i] ); }
+        else if ( arg == "--generate"   && has_value ) { opt.generate   = std::atol( argv[++i] ); }
+        else if ( arg.size() > 1 && arg[0] == '-'    ) { return false; }
+        else if ( pos == 0 ) { opt.input  = arg; ++pos; }
+        else if ( pos == 1 ) { opt.output = arg; ++pos; }
+        else                 { return false; }
+    }
+
+    if ( !opt.explicit_format )
+    {
+        opt.fmt = ends_with( opt.input, ".csv" ) || ends_with( opt.input, ".txt" ) ? format::csv : format::binary;
+    }
+    return pos >= 1 && opt.dt > 0;
+}
+
+// Create the estimator from the options:
+
+kalman make_estimator( options const & opt )
+{
+    const real_t dt = opt.dt;
+
+    const kalman::A_t A = { 1, dt,
+                            0, 1 };
+    const kalman::B_t B = { dt * dt / 2,
+                            dt };
+    const kalman::H_t H = { 1, 0 };
+
+    const real_t R = opt.measnoise * opt.measnoise;
+
+    const auto Q = real_t( opt.accelnoise * opt.accelnoise ) * kalman::Q_t(
+        { dt*dt*dt*dt/4, dt*dt*dt/2,
+             dt*dt*dt/2, dt*dt } );
+
+    return kalman( dt, A, B, H, Q, R, Q, kalman::xhat_t( 0 ) );
+}
+
+// Create the measurement filter from the options, empty if none:
+
+cascade make_filter( options const & opt )
+{
+    cascade filter;
+
+    if ( opt.lowpass > 0 )
+    {
+        // Fourth order Butterworth low-pass as two second order sections:
+        const double fs = 1 / opt.dt;
+
+        filter.append( dsp::make_biquad( dsp::biquad_design<dsp::FilterResponse::low_pass>( 0, opt.lowpass, fs, 0.54119610 ) ) );
+        filter.append( dsp::make_biquad( dsp::biquad_design<dsp::FilterResponse::low_pass>( 0, opt.lowpass, fs, 1.30656296 ) ) );
+    }
+    return filter;
+}
+
+// Read-only memory-mapped file; an empty file is open, but not mapped:
+
+class mapped_file
+{
+public:
+    explicit mapped_file( char const * name )
+    {
+#if ke_HAVE_MMAP
+        const int fd = name ? ::open( name, O_RDONLY ) : -1;
+        struct stat st;
+
+        open_ = fd >= 0 && ::fstat( fd, &st ) == 0;
+
+        if ( open_ && st.st_size > 0 )
+        {
+            void * p = ::mmap( nullptr, static_cast<std::size_t>( st.st_size ), PROT_READ, MAP_PRIVATE, fd, 0 );
+
+            if ( p != MAP_FAILED )
+            {
+                ::madvise( p, static_cast<std::size_t>( st.st_size ), MADV_SEQUENTIAL );
+
+                ptr   = static_cast<unsigned char const *>( p );
+                size_ = static_cast<std::size_t>( st.st_size );
+            }
+        }
+        if ( fd >= 0 )
+        {
+            ::close( fd );
+        }
+#else
+        (void) name;
+#endif
+    }
+
+    ~mapped_file()
+    {
+#if ke_HAVE_MMAP
+        if ( ptr )
+        {
+            ::munmap( const_cast<unsigned char *>( ptr ), size_ );
+        }
+#endif
+    }
+
+    mapped_file( mapped_file const & ) = delete;
+    mapped_file & operator=( mapped_file const & ) = delete;
+
+    explicit operator bool() const { return ptr != nullptr; }
+
+    bool is_open() const { return open_; }
+
+    unsigned char const * data() const { return ptr; }
+    std::size_t size() const { return size_; }
+
+private:
+    unsigned char const * ptr = nullptr;
+    std::size_t size_ = 0;
+    bool open_ = false;
+};
+
+// Readers, call fn( u, z ) per sample, return false on a read error:
+
+struct sample
+{
+    double u;
+    double z;
+};
+
+template< typename F >
+bool read_binary( mapped_file const & file, F && fn )
+{
+    const std::size_t n = file.size() / sizeof( sample );
+
+    for ( std::size_t i = 0; i < n; ++i )
+    {
+        sample s;
+        std::memcpy( &s, file.data() + i * sizeof s, sizeof s );
+        fn( s.u, s.z );
+    }
+    return file.size() % sizeof( sample ) == 0;
+}
+
+template< typename F >
+bool read_binary( std::FILE * in, F && fn )
+{
+    std::vector<sample> block( io_buffer_size / sizeof( sample ) );
+
+    for ( std::size_t n; ( n = std::fread( block.data(), sizeof( sample ), block.size(), in ) ) > 0; )
+    {
+        for ( std::size_t i = 0; i < n; ++i )
+        {
+            fn( block[i].u, block[i].z );
+        }
+    }
+    return !std::ferror( in );
+}
+
+template< typename F >
+bool read_csv( std::FILE * in, F && fn )
+{
+    char line[256];
+
+    while ( std::fgets( line, sizeof line, in ) )
+    {
+        if ( line[0] == '#' || line[0] == '\n' || line[0] == '\r' )
+        {
+            continue;
+        }
+
+        char * end;
+        const double u = std::strtod( line, &end );
+
+        if ( *end != ',' )
+        {
+            return false;
+        }
+
+        fn( u, std::strtod( end + 1, nullptr ) );
+    }
+    return !std::ferror( in );
+}
+
+// Writers of an estimate:
+
+void write_binary( std::FILE * out, double t, double pos, double vel )
+{
+    const double record[] = { t, pos, vel };
+    std::fwrite( record, sizeof record, 1, out );
+}
+
+void write_csv( std::FILE * out, double t, double pos, double vel )
+{
+    std::fprintf( out, "%.9g,%.9g,%.9g\n", t, pos, vel );
+}
+
+// Write a synthetic log of the model, see kalman-sim.e.cpp:
+
+int generate( options const & opt )
+{
+    std::FILE * out = std::fopen( opt.input.c_str(), opt.fmt == format::csv ? "w" : "wb" );
+
+    if ( !out )
+    {
+        std::fprintf( stderr, "kalman-replay: cannot create '%s'\n", opt.input.c_str() );
+        return 1;
+    }
+
+    std::setvbuf( out, nullptr, _IOFBF, io_buffer_size );
+
+    std::default_random_engine generator;
+    std::normal_distribution<double> dist( 0.0, 1.0 );
+
+    const double dt = opt.dt;
+    double pos = 0;
+    double vel = 0;
+
+    if ( opt.fmt == format::csv )
+    {
+        std::fprintf( out, "# u,z\n" );
+    }
+
+    for ( long i = 0; i < opt.generate; ++i )
+    {
+        // Commanded acceleration alternates direction every 1000 samples:
+        const double u = ( i / 1000 ) % 2 ? -1 : 1;
+
+        const double a = u + opt.accelnoise * dist( generator );
+
+        pos += vel * dt + a * dt * dt / 2;
+        vel += a * dt;
+
+        const double z = pos + opt.measnoise * dist( generator );
+
+        if ( opt.fmt == format::csv )
+        {
+            std::fprintf( out, "%.9g,%.9g\n", u, z );
+        }
+        else
+        {
+            const sample s = { u, z };
+            std::fwrite( &s, sizeof s, 1, out );
+        }
+    }
+
+    return std::fclose( out ) == 0 ? 0 : 1;
+}
+
+// Replay the log through the filter and the estimator:
+
+int replay( options const & opt )
+{
+    const bool from_stdin = opt.input  == "-";
+    const bool to_stdout  = opt.output == "-";
+
+    // Open the input first, so that a missing input does not cost the output,
+    // which may be the same file; an empty or unmappable binary log is read
+    // via stdio:
+
+    const bool mapping = opt.fmt == format::binary && !from_stdin && ke_HAVE_MMAP;
+
+    mapped_file file( mapping ? opt.input.c_str() : nullptr );
+
+    std::FILE * in = nullptr;
+
+    if ( !mapping || ( file.is_open() && !file ) )
+    {
+        in = from_stdin ? stdin : std::fopen( opt.input.c_str(), opt.fmt == format::csv ? "r" : "rb" );
+    }
+
+    if ( !file && !in )
+    {
+        std::fprintf( stderr, "kalman-replay: cannot open '%s'\n", opt.input.c_str() );
+        return 1;
+    }
+
+    std::FILE * out = to_stdout ? stdout : std::fopen( opt.output.c_str(), opt.fmt == format::csv ? "w" : "wb" );
+
+    if ( !out )
+    {
+        std::fprintf( stderr, "kalman-replay: cannot create '%s'\n", opt.output.c_str() );
+
+        if ( in && !from_stdin )
+        {
+            std::fclose( in );
+        }
+        return 1;
+    }
+
+    std::vector<char> out_buffer( io_buffer_size );
+    std::setvbuf( out, out_buffer.data(), _IOFBF, out_buffer.size() );
+
+    auto estim  = make_estimator( opt );
+    auto filter = make_filter( opt );
+
+    const bool filtered = filter.size() > 0;
+    long samples = 0;
+
+    auto process = [&]( double u, double z )
+    {
+        if ( filtered )
+        {
+            z = step( filter, z );
+        }
+
+        estim.update( kalman::u_t( real_t( u ) ), real_t( z ) );
+
+        const auto x = estim.system_state();
+
+        if ( opt.fmt == format::csv )
+        {
+            write_csv( out, double( estim.time() ), double( x(0) ), double( x(1) ) );
+        }
+        else
+        {
+            write_binary( out, double( estim.time() ), double( x(0) ), double( x(1) ) );
+        }
+        ++samples;
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+
+    bool ok = false;
+
+    if ( file )
+    {
+        ok = read_binary( file, process );
+    }
+    else
+    {
+        std::vector<char> in_buffer( io_buffer_size );
+        std::setvbuf( in, in_buffer.data(), _IOFBF, in_buffer.size() );
+
+        ok = opt.fmt == format::csv ? read_csv( in, process ) : read_binary( in, process );
+
+        if ( !from_stdin )
+        {
+            std::fclose( in );
+        }
+    }
+
+    ok = std::fflush( out ) == 0 && ok;
+
+    const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    if ( !to_stdout )
+    {
+        ok = std::fclose( out ) == 0 && ok;
+    }
+
+    if ( ok && samples == 0 )
+    {
+        std::fprintf( stderr, "kalman-replay: '%s' is empty\n", opt.input.c_str() );
+        return 0;
+    }
+
+    std::fprintf( stderr, "kalman-replay: %ld samples in %.3f s, %.3g samples/s%s%s\n",
+        samples, seconds, seconds > 0 ? samples / seconds : 0.0,
+        filtered ? ", low-pass filtered" : "", ok ? "" : ", read or write error" );
+
+    return ok ? 0 : 1;
+}
+
+int main( int argc, char * argv[] )
+{
+    options opt;
+
+    if ( !parse( argc, argv, opt ) )
+    {
+        return usage( argv[0] );
+    }
+
+    return opt.generate > 0 ? generate( opt ) : replay( opt );
+}
+
+// cl -std:c++17 -permissive- -EHsc -O2 -I../../include kalman-replay.e.cpp && kalman-replay.e.exe --generate 1000000 log.bin && kalman-replay.e.exe log.bin est.bin
+// g++ -std=c++17 -Wall -O2 -I../../include -o kalman-replay.e.exe kalman-replay.e.cpp && ./kalman-replay.e.exe --generate 1000000 log.bin && ./kalman-replay.e.exe log.bin est.bin
@@ -0,0 +1,486 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Tune the process and measurement noise of a Kalman estimator to a recorded
+// log of control inputs and measurements (u, z).
+//
+// Each candidate (measnoise, accelnoise) replays the log through its own
+// estimator; candidates run in parallel on a worker pool. A candidate is
+// scored by the consistency of its innovations e = z - H xhat with their
+// predicted covariance S, ignoring the first samples (--skip):
+//
+// - nis:       ln( mean( e^2 / S ) )^2, zero if the normalized innovation
+//              squared averages one, the measurement dimension;
+// - whiteness: sum of the squared autocorrelation of e at lags 1..L (--lags),
+//              zero for white innovations;
+// - both:      the sum of the two (default).
+//
+// Candidates are taken from a logarithmic grid over the ranges (--search
+// grid), or found by a coordinate search in the logarithm of the parameters
+// (--search coordinate), which evaluates 2 * --points candidates along one
+// parameter at a time and halves the step when no candidate improves.
+//
+// The log and model are those of kalman-replay.e.cpp, e.g. use
+// 'kalman-replay.e --generate 100000 log.bin' to create a log to tune to.
+
+#include "dsp/kalman.hpp"
+#include "num/worker-pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Kalman estimator type:
+
+using kalman = num::kalman
+<
+#ifdef KE_NUMERIC_TYPE
+    KE_NUMERIC_TYPE
+#else
+    double  // numeric type for computations
+#endif
+    , 2     // 2d system
+    , 1     // single measurement
+    , 1     // single control input
+>;
+
+using real_t = kalman::real_t;
+
+// Options:
+
+enum class format { csv, binary };
+enum class search { grid, coordinate };
+enum class score_by { nis, whiteness, both };
+
+struct range
+{
+    double lo;
+    double hi;
+    int n;
+};
+
+struct options
+{
+    std::string input;                      // log to tune to
+    format fmt = format::binary;            // format of log
+    bool explicit_format = false;           // format given with -f
+    double dt = 1;                          // time step [s]
+    range measnoise  = { 1, 100, 16 };      // position measurement noise [m]
+    range accelnoise = { 0.01, 1, 16 };     // acceleration noise [m/s^2]
+    search method = search::grid;           // candidate generation
+    score_by scoring = score_by::both;      // candidate score
+    int points = 4;                         // coordinate search: candidates per direction
+    int rounds = 50;                        // coordinate search: maximum number of batches
+    int skip = 100;                         // number of samples not scored
+    int lags = 10;                          // whiteness: number of autocorrelation lags
+    int threads = 0;                        // number of threads, 0: all cores
+    int show = 5;                           // number of best candidates reported
+};
+
+int usage( char const * name )
+{
+    std::fprintf( stderr,
+        "Usage: %s [options] input\n"
+        "\n"
+        "Tune measurement and acceleration noise of a Kalman estimator to log 'input' of (u, z).\n"
+        "\n"
+        "Options:\n"
+        "  -f csv|bin                 format of log, default by extension of input\n"
+        "  --dt s                     time step [s], default 1\n"
+        "  --measnoise lo hi n        range [m] and grid points, default 1 100 16\n"
+        "  --accelnoise lo hi n       range [m/s^2] and grid points, default 0.01 1 16\n"
+        "  --search grid|coordinate   candidate generation, default grid\n"
+        "  --points n                 coordinate search: candidates per direction, default 4\n"
+        "  --rounds n                 coordinate search: maximum number of batches, default 50\n"
+        "  --score nis|whiteness|both candidate score, default both\n"
+        "  --skip n                   number of initial samples not scored, default 100\n"
+        "  --lags n                   whiteness: number of autocorrelation lags, default 10\n"
+        "  --threads n                number of threads, default all cores\n"
+        "  --show n                   number of best candidates reported, default 5\n"
+        , name );
+    return 2;
+}
+
+bool ends_with( std::string const & text, char const * tail )
+{
+    const auto n = std::strlen( tail );
+    return text.size() >= n && text.compare( text.size() - n, n, tail ) == 0;
+}
+
+bool parse( int argc, char * argv[], options & opt )
+{
+    int pos = 0;
+
+    for ( int i = 1; i < argc; ++i )
+    {
+        const std::string arg = argv[i];
+        const bool has_value  = i + 1 < argc;
+        const bool has_range  = i + 3 < argc;
+
+        if      ( arg == "-f"           && has_value ) { opt.fmt = std::string( argv[++i] ) == "csv" ? format::csv : format::binary; opt.explicit_format = true; }
+        else if ( arg == "--dt"         && has_value ) { opt.dt      = std::atof( argv[++i] ); }
+        else if ( arg == "--points"     && has_value ) { opt.points  = std::atoi( argv[++i] ); }
+        else if ( arg == "--rounds"     && has_value ) { opt.rounds  = std::atoi( argv[++i] ); }
+        else if ( arg == "--skip"       && has_value ) { opt.skip    = std::atoi( argv[++i] ); }
+        else if ( arg == "--lags"       && has_value ) { opt.lags    = std::atoi( argv[++i] ); }
+        else if ( arg == "--threads"    && has_value ) { opt.threads = std::atoi( argv[++i] ); }
+        else if ( arg == "--show"       && has_value ) { opt.show    = std::atoi( argv[++i] ); }
+        else if ( arg == "--search"     && has_value ) { opt.method  = std::string( argv[++i] ) == "coordinate" ? search::coordinate : search::grid; }
+        else if ( arg == "--score"      && has_value )
+        {
+            const std::string s = argv[++i];
+            opt.scoring = s == "nis" ? score_by::nis : s == "whiteness" ? score_by::whiteness : score_by::both;
+        }
+        else if ( arg == "--measnoise"  && has_range ) { opt.measnoise  = { std::atof( argv[i+1] ), std::atof( argv[i+2] ), std::atoi( argv[i+3] ) }; i += 3; }
+        else if ( arg == "--accelnoise" && has_range ) { opt.accelnoise = { std::atof( argv[i+1] ), std::atof( argv[i+2] ), std::atoi( argv[i+3] ) }; i += 3; }
+        else if ( arg.size() > 1 && arg[0] == '-'    ) { return false; }
+        else if ( pos == 0 ) { opt.input = arg; ++pos; }
+        else                 { return false; }
+    }
+
+    if ( !opt.explicit_format )
+    {
+        opt.fmt = ends_with( opt.input, ".csv" ) || ends_with( opt.input, ".txt" ) ? format::csv : format::binary;
+    }
+
+    const auto valid = []( range const & r ) { return r.lo > 0 && r.lo <= r.hi && r.n >= 1; };
+
+    return pos == 1 && opt.dt > 0 && valid( opt.measnoise ) && valid( opt.accelnoise )
+        && opt.points >= 1 && opt.lags >= 1 && opt.skip >= 0;
+}
+
+// Read the log into memory, it is replayed once per candidate:
+
+struct sample
+{
+    double u;
+    double z;
+};
+
+bool read_log( options const & opt, std::vector<sample> & log )
+{
+    std::FILE * in = std::fopen( opt.input.c_str(), opt.fmt == format::csv ? "r" : "rb" );
+
+    if ( !in )
+    {
+        return false;
+    }
+
+    if ( opt.fmt == format::csv )
+    {
+        char line[256];
+
+        while ( std::fgets( line, sizeof line, in ) )
+        {
+            if ( line[0] == '#' || line[0] == '\n' || line[0] == '\r' )
+            {
+                continue;
+            }
+
+            char * end;
+            const double u = std::strtod( line, &end );
+
+            if ( *end == ',' )
+            {
+                log.push_back( { u, std::strtod( end + 1, nullptr ) } );
+            }
+        }
+    }
+    else
+    {
+        sample block[4096];
+
+        for ( std::size_t n; ( n = std::fread( block, sizeof( sample ), 4096, in ) ) > 0; )
+        {
+            log.insert( log.end(), block, block + n );
+        }
+    }
+
+    const bool ok = !std::ferror( in );
+    std::fclose( in );
+    return ok;
+}
+
+// Candidate and its score:
+
+struct candidate
+{
+    double measnoise;
+    double accelnoise;
+    double nis = 0;         // Mean normalized innovation squared
+    double whiteness = 0;   // Sum of squared autocorrelation at lags 1..L
+    double score = 0;       // Score, smaller is better
+};
+
+// Create the estimator for a candidate, the model of kalman-replay.e.cpp:
+
+kalman make_estimator( double dt_, candidate const & c )
+{
+    const real_t dt = dt_;
+
+    const kalman::A_t A = { 1, dt,
+                            0, 1 };
+    const kalman::B_t B = { dt * dt / 2,
+                            dt };
+    const kalman::H_t H = { 1, 0 };
+
+    const real_t R = c.measnoise * c.measnoise;
+
+    const auto Q = real_t( c.accelnoise * c.accelnoise ) * kalman::Q_t(
+        { dt*dt*dt*dt/4, dt*dt*dt/2,
+             dt*dt*dt/2, dt*dt } );
+
+    return kalman( dt, A, B, H, Q, R, Q, kalman::xhat_t( 0 ) );
+}
+
+// Replay the log through the candidate's estimator and score it:
+
+void evaluate( options const & opt, std::vector<sample> const & log, candidate & c )
+{
+    auto estim = make_estimator( opt.dt, c );
+
+    const int L = opt.lags;
+
+    std::vector<double> recent( L, 0.0 );   // Last L innovations, ring buffer
+    std::vector<double> lagged( L, 0.0 );   // Sum of e[n] * e[n-l], l = 1..L
+
+    double nis_sum = 0;
+    double energy  = 0;                     // Sum of e[n]^2
+    long scored = 0;
+
+    for ( std::size_t n = 0; n < log.size(); ++n )
+    {
+        const kalman::z_t z = { real_t( log[n].z ) };
+
+        estim.predict( kalman::u_t{ real_t( log[n].u ) } );
+
+        const auto e = estim.innovation( z );
+        const auto S = estim.innovation_covariance();
+
+        estim.correct( z );
+
+        if ( static_cast<long>( n ) < opt.skip )
+        {
+            continue;
+        }
+
+        const double en = double( e(0) );
+
+        nis_sum += double( mahalanobis_squared( S, e ) );
+        energy  += en * en;
+
+        for ( int l = 1; l <= L && l <= scored; ++l )
+        {
+            lagged[l - 1] += en * recent[ ( scored - l ) % L ];
+        }
+
+        recent[ scored % L ] = en;
+        ++scored;
+    }
+
+    c.nis = scored > 0 ? nis_sum / scored : 0;
+    c.whiteness = 0;
+
+    for ( int l = 0; l < L && energy > 0; ++l )
+    {
+        const double rho = lagged[l] / energy;
+        c.whiteness += rho * rho;
+    }
+
+    const double nis_score = c.nis > 0 ? std::log( c.nis ) * std::log( c.nis ) : HUGE_VAL;
+
+    c.score = opt.scoring == score_by::nis       ? nis_score
+            : opt.scoring == score_by::whiteness ? c.whiteness
+            :                                      nis_score + c.whiteness;
+}
+
+// Evaluate candidates in parallel:
+
+class tuner
+{
+public:
+    tuner( options const & opt_, std::vector<sample> const & log_, num::worker_pool & pool_ )
+        : opt( opt_)
+        , log( log_)
+        , pool( pool_)
+    {}
+
+    void evaluate( std::vector<candidate> & batch )
+    {
+        pool.for_each( static_cast<int>( batch.size() ), [&]( int b, int e )
+        {
+            for ( int i = b; i < e; ++i )
+            {
+                ::evaluate( opt, log, batch[i] );
+            }
+        });
+
+        all.insert( all.end(), batch.begin(), batch.end() );
+    }
+
+    std::vector<candidate> const & evaluated() const
+    {
+        return all;
+    }
+
+private:
+    options const & opt;
+    std::vector<sample> const & log;
+    num::worker_pool & pool;
+    std::vector<candidate> all;     // Candidates evaluated
+};
+
+double log_point( range const & r, int i )
+{
+    return r.n == 1 ? r.lo : r.lo * std::pow( r.hi / r.lo, double( i ) / ( r.n - 1 ) );
+}
+
+void grid_search( options const & opt, tuner & t )
+{
+    std::vector<candidate> batch;
+
+    for ( int i = 0; i < opt.measnoise.n; ++i )
+    {
+        for ( int k = 0; k < opt.accelnoise.n; ++k )
+        {
+            batch.push_back( { log_point( opt.measnoise, i ), log_point( opt.accelnoise, k ) } );
+        }
+    }
+
+    t.evaluate( batch );
+}
+
+void coordinate_search( options const & opt, tuner & t )
+{
+    // Parameters in logarithm, starting at the centre of the ranges with a
+    // step of a quarter of the range, or of a decade for an empty range:
+
+    const range * ranges[] = { &opt.measnoise, &opt.accelnoise };
+
+    double p[2];
+    double step[2];
+
+    for ( int d = 0; d < 2; ++d )
+    {
+        p[d]    = 0.5 * ( std::log( ranges[d]->lo ) + std::log( ranges[d]->hi ) );
+        step[d] = ranges[d]->lo < ranges[d]->hi ? 0.25 * ( std::log( ranges[d]->hi ) - std::log( ranges[d]->lo ) ) : std::log( 10.0 );
+    }
+
+    std::vector<candidate> batch = { { std::exp( p[0] ), std::exp( p[1] ) } };
+    t.evaluate( batch );
+
+    double best = batch[0].score;
+    int unimproved = 0;
+
+    for ( int round = 0; round < opt.rounds && unimproved < 2; ++round )
+    {
+        const int d = round % 2;
+
+        batch.clear();
+
+        for ( int k = -opt.points; k <= opt.points; ++k )
+        {
+            if ( k != 0 )
+            {
+                double q[2] = { p[0], p[1] };
+                q[d] += k * step[d] / opt.points;
+                batch.push_back( { std::exp( q[0] ), std::exp( q[1] ) } );
+            }
+        }
+
+        t.evaluate( batch );
+
+        const auto it = std::min_element( batch.begin(), batch.end(), []( candidate const & a, candidate const & b ) { return a.score < b.score; } );
+
+        if ( it->score < best )
+        {
+            best = it->score;
+            p[0] = std::log( it->measnoise );
+            p[1] = std::log( it->accelnoise );
+            unimproved = 0;
+        }
+        else
+        {
+            step[d] *= 0.5;
+            ++unimproved;
+        }
+    }
+}
+
+int main( int argc, char * argv[] )
+{
+    options opt;
+
+    if ( !parse( argc, argv, opt ) )
+    {
+        return usage( argv[0] );
+    }
+
+    std::vector<sample> log;
+
+    if ( !read_log( opt, log ) || log.size() <= static_cast<std::size_t>( opt.skip ) )
+    {
+        std::fprintf( stderr, "kalman-tune: cannot read '%s' or it has no more than %d samples\n", opt.input.c_str(), opt.skip );
+        return 1;
+    }
+
+    num::worker_pool pool( opt.threads );
+    tuner t( opt, log, pool );
+
+    const auto start = std::chrono::steady_clock::now();
+
+    if ( opt.method == search::grid )
+    {
+        grid_search( opt, t );
+    }
+    else
+    {
+        coordinate_search( opt, t );
+    }
+
+    const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    const double candidates = static_cast<double>( t.evaluated().size() );
+
+    // Best candidates first, once, as coordinate search may revisit a candidate,
+    // with the same score:
+
+    auto result = t.evaluated();
+
+    std::sort( result.begin(), result.end(), []( candidate const & a, candidate const & b )
+    {
+        return a.score < b.score;
+    });
+
+    result.erase( std::unique( result.begin(), result.end(), []( candidate const & a, candidate const & b )
+    {
+        return std::fabs( a.measnoise - b.measnoise ) <= 1e-9 * a.measnoise && std::fabs( a.accelnoise - b.accelnoise ) <= 1e-9 * a.accelnoise;
+    }), result.end() );
+
+    const int shown = std::min( opt.show, static_cast<int>( result.size() ) );
+
+    std::printf( "%12s %12s %12s %12s %12s\n", "measnoise", "accelnoise", "mean NIS", "whiteness", "score" );
+
+    for ( int i = 0; i < shown; ++i )
+    {
+        auto const & c = result[i];
+        std::printf( "%12.6g %12.6g %12.6g %12.6g %12.6g\n", c.measnoise, c.accelnoise, c.nis, c.whiteness, c.score );
+    }
+
+    std::printf( "\nbest: --measnoise %g --accelnoise %g\n", result[0].measnoise, result[0].accelnoise );
+    std::printf( "%s search: %.0f candidates of %zu samples in %.3f s on %d threads, %.3g candidates/s, %.3g samples/s\n",
+        opt.method == search::grid ? "grid" : "coordinate", candidates, log.size(), seconds, pool.threads(),
+        seconds > 0 ? candidates / seconds : 0.0, seconds > 0 ? candidates * log.size() / seconds : 0.0 );
+}
+
+// cl -std:c++17 -permissive- -EHsc -O2 -I../../include kalman-tune.e.cpp && kalman-tune.e.exe log.bin
+// g++ -std=c++17 -Wall -O2 -pthread -I../../include -o kalman-tune.e.exe kalman-tune.e.cpp && ./kalman-tune.e.exe log.bin
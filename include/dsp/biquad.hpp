@@ -233,6 +233,13 @@ public:
         w = W{};
     }
 
+    // set state, e.g. from a checkpoint:
+
+    void set_state( W w_ )
+    {
+        w = w_;
+    }
+
     auto step( value_type x )
     {
         return step_df2( x );
@@ -0,0 +1,353 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef NUM_CHECKPOINT_HPP_INCLUDED
+#define NUM_CHECKPOINT_HPP_INCLUDED
+
+// Desktop: binary checkpoint of estimator and filter state, for a warm restart.
+
+#include "dsp/biquad-cascade.hpp"
+#include "dsp/kalman.hpp"
+#include "num/fixed-point.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace num {
+
+//
+// A checkpoint record is a 32-byte header followed by the state as scalars
+// of type T in the byte order of the writer, padded to a multiple of 8 bytes:
+//
+//   kalman<T,S,M,U>:    xhat (S), P packed upper triangle (S(S+1)/2), K (S x M), t
+//   BiQuadCascadeT<T,N>: v1, v2 per section
+//
+// Records of filters of the same type have the same size, so a fleet of
+// filters can be stored back to back in a single file. Reading takes the
+// scalars straight from the buffer, e.g. a memory-mapped file, into the
+// filter; a record written with the other byte order is byte-swapped while
+// reading. A record is rejected (false, filter unchanged) if its magic,
+// version, kind, scalar size, scalar type or dimensions do not match the
+// filter. The scalar type tag tells float, double and the fixed_point
+// formats apart, which may have the same size:
+//
+//   floating point:  0x01'00'00'dd, dd: mantissa digits, e.g. 24 for float
+//   integral:        0x02'0s'00'dd, s: signed, dd: value digits
+//   fixed_point:     0x03'00'ii'ff, ii: integer bits, ff: fraction bits
+//
+
+struct checkpoint_header
+{
+    char          magic[4];     // "KECP"
+    std::uint16_t version;      // Format version, checkpoint_version
+    std::uint16_t endian;       // 0x0102, as stored by the writer
+    std::uint16_t kind;         // checkpoint_kind
+    std::uint16_t scalar;       // Size of scalar type T in bytes
+    std::uint32_t dims[2];      // kalman: S, M; cascade: sections, 2
+    std::uint32_t count;        // Number of scalars that follow
+    std::uint32_t type;         // Scalar type tag, checkpoint_scalar_type
+    std::uint32_t reserved;     // Zero
+};
+
+static_assert( sizeof( checkpoint_header ) == 32, "checkpoint_header: expect 32 bytes" );
+
+constexpr std::uint16_t checkpoint_version = 2;
+
+enum checkpoint_kind : std::uint16_t
+{
+    checkpoint_kalman = 1,
+    checkpoint_biquad_cascade = 2,
+};
+
+// Scalar type tag:
+
+template< typename T >
+struct checkpoint_scalar_type
+{
+    static_assert( std::is_arithmetic<T>::value, "checkpoint_scalar_type: requires a floating point, integral or fixed_point type" );
+
+    static constexpr std::uint32_t value =
+        ( std::is_floating_point<T>::value ? 0x01u : 0x02u ) << 24
+        | ( std::is_signed<T>::value && !std::is_floating_point<T>::value ? 0x01u : 0x00u ) << 16
+        | static_cast<std::uint32_t>( std::numeric_limits<T>::digits );
+};
+
+template< typename R, int I, int F >
+struct checkpoint_scalar_type< fixed_point<R,I,F> >
+{
+    static constexpr std::uint32_t value = 0x03u << 24 | static_cast<std::uint32_t>( I ) << 8 | static_cast<std::uint32_t>( F );
+};
+
+namespace detail {
+
+constexpr std::uint16_t checkpoint_endian = 0x0102;
+constexpr std::uint16_t checkpoint_swapped = 0x0201;
+
+constexpr std::size_t checkpoint_record_size( std::size_t count, std::size_t scalar )
+{
+    return sizeof( checkpoint_header ) + ( count * scalar + 7 ) / 8 * 8;
+}
+
+template< typename V >
+V byte_swapped( V v )
+{
+    unsigned char bytes[ sizeof(V) ];
+
+    std::memcpy( bytes, &v, sizeof(V) );
+
+    for ( std::size_t i = 0; i < sizeof(V) / 2; ++i )
+    {
+        const unsigned char b = bytes[i];
+        bytes[i] = bytes[ sizeof(V) - 1 - i ];
+        bytes[ sizeof(V) - 1 - i ] = b;
+    }
+
+    std::memcpy( &v, bytes, sizeof(V) );
+    return v;
+}
+
+// Sequential writer of scalars into a record:
+
+class checkpoint_writer
+{
+public:
+    checkpoint_writer( void * buffer, checkpoint_kind kind, std::uint16_t scalar, std::uint32_t type, std::uint32_t d0, std::uint32_t d1, std::uint32_t count )
+        : pos( static_cast<unsigned char *>( buffer ) + sizeof( checkpoint_header ) )
+    {
+        const checkpoint_header h = { { 'K', 'E', 'C', 'P' }, checkpoint_version, checkpoint_endian, kind, scalar, { d0, d1 }, count, type, 0 };
+
+        std::memcpy( buffer, &h, sizeof h );
+        std::memset( pos, 0, checkpoint_record_size( count, scalar ) - sizeof h );
+    }
+
+    template< typename V >
+    void put( V const & v )
+    {
+        std::memcpy( pos, &v, sizeof(V) );
+        pos += sizeof(V);
+    }
+
+    template< typename It >
+    void put( It first, It last )
+    {
+        for ( ; first != last; ++first )
+        {
+            put( *first );
+        }
+    }
+
+private:
+    unsigned char * pos;
+};
+
+// Sequential reader of scalars from a record, validating its header:
+
+class checkpoint_reader
+{
+public:
+    checkpoint_reader( void const * buffer, std::size_t size, checkpoint_kind kind, std::uint16_t scalar, std::uint32_t type, std::uint32_t d0, std::uint32_t d1, std::uint32_t count )
+        : pos( static_cast<unsigned char const *>( buffer ) + sizeof( checkpoint_header ) )
+    {
+        if ( size < sizeof( checkpoint_header ) )
+        {
+            return;
+        }
+
+        checkpoint_header h;
+        std::memcpy( &h, buffer, sizeof h );
+
+        if ( std::memcmp( h.magic, "KECP", 4 ) != 0 )
+        {
+            return;
+        }
+
+        swap = h.endian == checkpoint_swapped;
+
+        if ( !swap && h.endian != checkpoint_endian )
+        {
+            return;
+        }
+
+        // Version 1 records lack the scalar type tag:
+
+        valid =
+               get_( h.version ) == checkpoint_version
+            && get_( h.kind    ) == kind
+            && get_( h.scalar  ) == scalar
+            && get_( h.type    ) == type
+            && get_( h.dims[0] ) == d0
+            && get_( h.dims[1] ) == d1
+            && get_( h.count   ) == count
+            && size >= checkpoint_record_size( count, scalar );
+    }
+
+    bool is_valid() const
+    {
+        return valid;
+    }
+
+    template< typename V >
+    V get()
+    {
+        V v;
+        std::memcpy( &v, pos, sizeof(V) );
+        pos += sizeof(V);
+        return get_( v );
+    }
+
+    template< typename It >
+    void get( It first, It last )
+    {
+        for ( ; first != last; ++first )
+        {
+            *first = get< std20::remove_cv_t< std20::remove_reference_t< decltype(*first) > > >();
+        }
+    }
+
+private:
+    template< typename V >
+    V get_( V v ) const
+    {
+        return swap ? byte_swapped( v ) : v;
+    }
+
+private:
+    unsigned char const * pos;
+    bool swap  = false;
+    bool valid = false;
+};
+
+} // namespace detail
+
+// Kalman estimator: xhat, P, K and t.
+
+template< typename T, int S, int M, int U, typename Structure, typename Telemetry >
+constexpr std::size_t checkpoint_size( kalman<T,S,M,U,Structure,Telemetry> const & )
+{
+    return detail::checkpoint_record_size( S + S * (S + 1) / 2 + S * M + 1, sizeof(T) );
+}
+
+// Write checkpoint into buffer, return its size, or 0 if it does not fit:
+
+template< typename T, int S, int M, int U, typename Structure, typename Telemetry >
+std::size_t write_checkpoint( kalman<T,S,M,U,Structure,Telemetry> const & estim, void * buffer, std::size_t size )
+{
+    static_assert( !is_mixed_precision_v<T>, "write_checkpoint: requires a single numeric type" );
+    static_assert( std::is_trivially_copyable<T>::value, "write_checkpoint: requires a trivially copyable numeric type" );
+
+    const auto n = checkpoint_size( estim );
+
+    if ( size < n )
+    {
+        return 0;
+    }
+
+    const auto s = estim.snapshot();
+
+    detail::checkpoint_writer w( buffer, checkpoint_kalman, sizeof(T), checkpoint_scalar_type<T>::value, S, M, S + S * (S + 1) / 2 + S * M + 1 );
+
+    w.put( s.xhat.begin(), s.xhat.end() );
+    w.put( s.P.begin(), s.P.end() );
+    w.put( s.K.begin(), s.K.end() );
+    w.put( s.t );
+
+    return n;
+}
+
+// Restore estimator from checkpoint in buffer, return false if it does not match:
+
+template< typename T, int S, int M, int U, typename Structure, typename Telemetry >
+bool read_checkpoint( kalman<T,S,M,U,Structure,Telemetry> & estim, void const * buffer, std::size_t size )
+{
+    static_assert( !is_mixed_precision_v<T>, "read_checkpoint: requires a single numeric type" );
+    static_assert( std::is_trivially_copyable<T>::value, "read_checkpoint: requires a trivially copyable numeric type" );
+
+    detail::checkpoint_reader r( buffer, size, checkpoint_kalman, sizeof(T), checkpoint_scalar_type<T>::value, S, M, S + S * (S + 1) / 2 + S * M + 1 );
+
+    if ( !r.is_valid() )
+    {
+        return false;
+    }
+
+    auto s = estim.snapshot();
+
+    r.get( s.xhat.begin(), s.xhat.end() );
+    r.get( s.P.begin(), s.P.end() );
+    r.get( s.K.begin(), s.K.end() );
+    s.t = r.get<T>();
+
+    estim.restore( s );
+
+    return true;
+}
+
+// Bi-quad filter cascade: the state of its sections.
+
+template< typename T, int N >
+std::size_t checkpoint_size( dsp::BiQuadCascadeT<T,N> const & filters )
+{
+    return detail::checkpoint_record_size( 2 * filters.size(), sizeof(T) );
+}
+
+template< typename T, int N >
+std::size_t write_checkpoint( dsp::BiQuadCascadeT<T,N> const & filters, void * buffer, std::size_t size )
+{
+    static_assert( std::is_trivially_copyable<T>::value, "write_checkpoint: requires a trivially copyable numeric type" );
+
+    const auto n = checkpoint_size( filters );
+
+    if ( size < n )
+    {
+        return 0;
+    }
+
+    const auto sections = static_cast<std::uint32_t>( filters.size() );
+
+    detail::checkpoint_writer w( buffer, checkpoint_biquad_cascade, sizeof(T), checkpoint_scalar_type<T>::value, sections, 2, 2 * sections );
+
+    for ( auto const & bq : filters )
+    {
+        const auto state = bq.state();
+
+        w.put( state.v1 );
+        w.put( state.v2 );
+    }
+    return n;
+}
+
+template< typename T, int N >
+bool read_checkpoint( dsp::BiQuadCascadeT<T,N> & filters, void const * buffer, std::size_t size )
+{
+    static_assert( std::is_trivially_copyable<T>::value, "read_checkpoint: requires a trivially copyable numeric type" );
+
+    const auto sections = static_cast<std::uint32_t>( filters.size() );
+
+    detail::checkpoint_reader r( buffer, size, checkpoint_biquad_cascade, sizeof(T), checkpoint_scalar_type<T>::value, sections, 2, 2 * sections );
+
+    if ( !r.is_valid() )
+    {
+        return false;
+    }
+
+    for ( auto & bq : filters )
+    {
+        auto state = bq.state();
+
+        state.v1 = r.get<T>();
+        state.v2 = r.get<T>();
+
+        bq.set_state( state );
+    }
+    return true;
+}
+
+} // namespace num
+
+#endif // NUM_CHECKPOINT_HPP_INCLUDED
@@ -0,0 +1,438 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef NUM_KALMAN_BANK_HPP_INCLUDED
+#define NUM_KALMAN_BANK_HPP_INCLUDED
+
+#include "dsp/kalman.hpp"
+
+namespace num {
+
+//
+// Bank of N independent Kalman estimators.
+//
+// Matrices are stored as structure-of-arrays: element (r,c) of all N
+// instances is contiguous, so that every step of the update runs as an
+// inner loop across instances the compiler can vectorize. Per instance,
+// the arithmetic is performed in the same order as num::kalman<>::update(),
+// which makes the results identical to those of N separate estimators.
+//
+template
+<
+    typename T      // Numeric type
+    , int S         // System dimension
+    , int M         // Number of measurements
+    , int U         // Number of control inputs
+    , int N         // Number of instances
+>
+class kalman_bank
+{
+public:
+    using kalman_t = num::kalman<T,S,M,U>;
+
+    using real_t = T;                       // Numeric type for computations
+    using A_t    = typename kalman_t::A_t;  // System dynamics matrix: state-k-1 => state-k
+    using B_t    = typename kalman_t::B_t;  // Control input matrix: control => state
+    using H_t    = typename kalman_t::H_t;  // Measurement output matrix: state => measurement estimation
+    using Q_t    = typename kalman_t::Q_t;  // Process noise covariance
+    using R_t    = typename kalman_t::R_t;  // Measurement noise covariance
+    using P_t    = typename kalman_t::P_t;  // Estimate error covariance
+    using K_t    = typename kalman_t::K_t;  // Kalman gain
+    using xhat_t = typename kalman_t::xhat_t; // System state estimate
+
+    // Without control input, the control arrays keep one unused row, as
+    // num::matrix keeps one element for an empty shape:
+
+    static constexpr int Uc = U > 0 ? U : 1;
+
+    using u_bank_t = T[Uc][N];              // Control inputs, per instance
+    using z_bank_t = T[M][N];               // Measurement inputs, per instance
+
+    // Constructor, all instances share model and initial state:
+
+    kalman_bank(
+        real_t const dt_        // Time step
+        , A_t const & A_        // System dynamics matrix: state-k-1 => state-k
+        , B_t const & B_        // Control input matrix: control => state
+        , H_t const & H_        // Measurement output matrix: state => measurement estimation
+        , Q_t const & Q_        // Process noise covariance
+        , R_t const & R_        // Measurement noise covariance
+        , P_t const & P_        // Initial estimate error covariance
+        , xhat_t const & xhat_  // Initial system state estimate
+    )
+        : t(  0  )
+        , dt( dt_)
+    {
+        for ( int i = 0; i < N; ++i )
+        {
+            assign( i, A_, B_, H_, Q_, R_, P_, xhat_ );
+        }
+    }
+
+    // Number of instances:
+
+    static constexpr int size()
+    {
+        return N;
+    }
+
+    // Set model and state of instance i:
+
+    void assign(
+        int i
+        , A_t const & A_
+        , B_t const & B_
+        , H_t const & H_
+        , Q_t const & Q_
+        , R_t const & R_
+        , P_t const & P_
+        , xhat_t const & xhat_
+    )
+    {
+        scatter( A, A_, i );
+        if constexpr ( U > 0 )
+        {
+            scatter( B, B_, i );
+        }
+        scatter( H, H_, i );
+        scatter_symmetric( Q, Q_, i );
+        scatter( R, R_, i );
+        scatter_symmetric( P, P_, i );
+        scatter( K, K_t(0), i );
+        scatter( xhat, xhat_, i );
+    }
+
+    // Update all estimators for dt:
+
+    void update( u_bank_t const & u, z_bank_t const & z )
+    {
+        // Update the time:
+        t += dt;
+
+        // The inversion contains a conditional division that would keep the
+        // compiler from vectorizing the loop it is in, so it runs separately:
+
+        for ( int n = 0; n < N; ++n )
+        {
+            predict_lane( n, u );
+        }
+
+        for ( int n = 0; n < N; ++n )
+        {
+            invert_lane( n );
+        }
+
+        for ( int n = 0; n < N; ++n )
+        {
+            correct_lane( n, z );
+        }
+    }
+
+    // Observers, per instance:
+
+    xhat_t system_state( int i ) const
+    {
+        return gather<xhat_t>( xhat, i );
+    }
+
+    K_t kalman_gain( int i ) const
+    {
+        return gather<K_t>( K, i );
+    }
+
+    P_t estimation_error_covariance( int i ) const
+    {
+        return gather<P_t>( P, i );
+    }
+
+    real_t time() const
+    {
+        return t;
+    }
+
+private:
+    // Instance n, steps 1a to 2a up to the inversion; follows num::kalman<>::update().
+    // All loops have compile-time bounds, so that the loop across instances
+    // in update() is the one that remains and that is vectorized:
+
+    void predict_lane( int const n, u_bank_t const & u )
+    {
+        T x  [S];       // A * xhat
+        T tmp[S][S];    // A * P
+        T pht[S][M];    // P * transposed(H)
+
+        // --------------------------------------
+        // 1. Predict (time update)
+
+        // 1a: Project the state ahead:
+
+        for ( int r = 0; r < S; ++r )
+        {
+            x[r] = T(0);
+            for ( int c = 0; c < S; ++c )
+            {
+                x[r] += A[r][c][n] * xhat[c][0][n];
+            }
+        }
+
+        for ( int r = 0; r < S; ++r )
+        {
+            if constexpr ( U > 0 )
+            {
+                T bu = T(0);
+                for ( int c = 0; c < U; ++c )
+                {
+                    bu += B[r][c][n] * u[c][n];
+                }
+                xhat[r][0][n] = x[r] + bu;
+            }
+            else
+            {
+                xhat[r][0][n] = x[r];
+            }
+        }
+
+        // 1b: Project the error covariance ahead, A * P * transposed(A) + Q; each
+        // element (r,c) is computed as the upper triangle element (min, max),
+        // which keeps the loops rectangular, so that they unroll and the loop
+        // across instances vectorizes:
+
+        for ( int r = 0; r < S; ++r )
+        {
+            for ( int c = 0; c < S; ++c )
+            {
+                tmp[r][c] = T(0);
+                for ( int k = 0; k < S; ++k )
+                {
+                    tmp[r][c] += A[r][k][n] * P[k][c][n];
+                }
+            }
+        }
+
+        for ( int r = 0; r < S; ++r )
+        {
+            for ( int c = 0; c < S; ++c )
+            {
+                const int i = r < c ? r : c;
+                const int j = r < c ? c : r;
+
+                T apat = T(0);
+                for ( int k = 0; k < S; ++k )
+                {
+                    apat += tmp[i][k] * A[j][k][n];
+                }
+                P[r][c][n] = apat + Q[i][j][n];
+            }
+        }
+
+        // --------------------------------------
+        // 2. Correct (measurement update)
+
+        // 2a: Compute the Kalman gain, H * P * transposed(H) + R:
+
+        phts( n, pht );
+
+        for ( int m = 0; m < M; ++m )
+        {
+            for ( int l = 0; l < M; ++l )
+            {
+                T hpht = T(0);
+                for ( int k = 0; k < S; ++k )
+                {
+                    hpht += H[m][k][n] * pht[k][l];
+                }
+                inv[m][l][n] = R[m][l][n] + hpht;
+            }
+        }
+    }
+
+    // Instance n, steps 2a from the inversion to 2c:
+
+    void correct_lane( int const n, z_bank_t const & z )
+    {
+        T x  [S];       // K * (z - H * xhat)
+        T pht[S][M];    // P * transposed(H)
+        T inn[M];       // z - H * xhat
+
+        // 2a: Compute the Kalman gain, P * transposed(H) * inverted(...):
+
+        phts( n, pht );
+
+        for ( int r = 0; r < S; ++r )
+        {
+            for ( int m = 0; m < M; ++m )
+            {
+                if constexpr ( M == 1 )
+                {
+                    K[r][m][n] = pht[r][m] * inv[0][0][n];
+                }
+                else
+                {
+                    T k_ = T(0);
+                    for ( int k = 0; k < M; ++k )
+                    {
+                        k_ += pht[r][k] * inv[k][m][n];
+                    }
+                    K[r][m][n] = k_;
+                }
+            }
+        }
+
+        // 2b: Update estimate with measurement:
+
+        for ( int m = 0; m < M; ++m )
+        {
+            T hx = T(0);
+            for ( int k = 0; k < S; ++k )
+            {
+                hx += H[m][k][n] * xhat[k][0][n];
+            }
+            inn[m] = z[m][n] - hx;
+        }
+
+        for ( int r = 0; r < S; ++r )
+        {
+            if constexpr ( M == 1 )
+            {
+                x[r] = K[r][0][n] * inn[0];
+            }
+            else
+            {
+                x[r] = T(0);
+                for ( int m = 0; m < M; ++m )
+                {
+                    x[r] += K[r][m][n] * inn[m];
+                }
+            }
+            xhat[r][0][n] = xhat[r][0][n] + x[r];
+        }
+
+        // 2c: Update the error covariance, upper triangle of P - K * transposed(P * transposed(H)),
+        // mirrored to the lower triangle:
+
+        for ( int r = 0; r < S; ++r )
+        {
+            for ( int c = r; c < S; ++c )
+            {
+                T kph = T(0);
+                for ( int m = 0; m < M; ++m )
+                {
+                    kph += K[r][m][n] * pht[c][m];
+                }
+                P[r][c][n] = P[c][r][n] = P[r][c][n] - kph;
+            }
+        }
+    }
+
+    // P * transposed(H) of instance n, as num::operator*( symmatrix, matrix ):
+
+    void phts( int const n, T (&pht)[S][M] ) const
+    {
+        for ( int r = 0; r < S; ++r )
+        {
+            for ( int m = 0; m < M; ++m )
+            {
+                pht[r][m] = T(0);
+                for ( int k = 0; k < S; ++k )
+                {
+                    pht[r][m] += P[r][k][n] * H[m][k][n];
+                }
+            }
+        }
+    }
+
+    // Invert innovation covariance of instance n in place, as num::inverted();
+    // in closed form for up to two measurements, else per instance by the
+    // Gauss-Jordan elimination of num::inverted():
+
+    void invert_lane( int const n )
+    {
+        if constexpr ( M == 1 )
+        {
+            inv[0][0][n] = inverted( inv[0][0][n] );
+        }
+        else if constexpr ( M == 2 )
+        {
+            const T a0 = inv[0][0][n], a1 = inv[0][1][n];
+            const T a2 = inv[1][0][n], a3 = inv[1][1][n];
+
+            const auto det = 1 / ( a0 * a3 - a1 * a2 );
+
+            inv[0][0][n] = + det * a3;
+            inv[0][1][n] = - det * a1;
+            inv[1][0][n] = - det * a2;
+            inv[1][1][n] = + det * a0;
+        }
+        else
+        {
+            scatter( inv, inverted( gather<R_t>( inv, n ) ), n );
+        }
+    }
+
+    // Copy matrix of instance i into and out of lane storage:
+
+    template< int R, int C >
+    static void scatter( T (&lanes)[R][C][N], matrix<T,R,C> const & m, int i )
+    {
+        for ( int r = 0; r < R; ++r )
+        {
+            for ( int c = 0; c < C; ++c )
+            {
+                lanes[r][c][i] = m(r,c);
+            }
+        }
+    }
+
+    // Copy the upper triangle of a covariance into both triangles of lane
+    // storage, as num::symmatrix( matrix ) of num::kalman keeps the upper:
+
+    static void scatter_symmetric( T (&lanes)[S][S][N], P_t const & m, int i )
+    {
+        for ( int r = 0; r < S; ++r )
+        {
+            for ( int c = r; c < S; ++c )
+            {
+                lanes[r][c][i] = lanes[c][r][i] = m(r,c);
+            }
+        }
+    }
+
+    template< typename Matrix, int R, int C >
+    static Matrix gather( T const (&lanes)[R][C][N], int i )
+    {
+        Matrix result(0);
+
+        for ( int r = 0; r < R; ++r )
+        {
+            for ( int c = 0; c < C; ++c )
+            {
+                result(r,c) = lanes[r][c][i];
+            }
+        }
+        return result;
+    }
+
+private:
+    T A[S][S][N];       // System dynamics matrix
+    T B[S][Uc][N];      // Control input matrix
+    T H[M][S][N];       // Measurement output matrix
+    T Q[S][S][N];       // Process noise covariance
+    T R[M][M][N];       // Measurement noise covariance
+
+    T K[S][M][N];       // Kalman gain
+    T P[S][S][N];       // Estimate error covariance
+    T xhat[S][1][N];    // System state estimate
+
+    T inv[M][M][N];     // Inverted innovation covariance
+
+    real_t t;           // Elapsed time
+    real_t dt;          // Time-step
+};
+
+} // namespace num
+
+#endif // NUM_KALMAN_BANK_HPP_INCLUDED
@@ -0,0 +1,444 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef NUM_KALMAN_ENSEMBLE_HPP_INCLUDED
+#define NUM_KALMAN_ENSEMBLE_HPP_INCLUDED
+
+// Desktop: ensemble Kalman estimator for large systems.
+
+#include "dsp/kalman.hpp"
+#include "num/worker-pool.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace num {
+
+//
+// Ensemble Kalman estimator (stochastic EnKF, perturbed measurements).
+//
+// The error covariance is represented by N members, stored contiguously,
+// member after member. Members are propagated by the process model in
+// parallel on a worker_pool and the Kalman gain is formed from the ensemble
+// anomalies, which avoids the O(S^3) covariance propagation.
+//
+// The random perturbations are a function of the seed, time-step, member and
+// component only, and all sums are taken in member order, so that the
+// estimate for a given seed does not depend on the number of threads.
+//
+// The models are function objects for a single member:
+//
+//   colvec<T,S> Process::operator()( colvec<T,S> const & x, colvec<T,U> const & u ) const;
+//   colvec<T,M> Measure::operator()( colvec<T,S> const & x ) const;
+//
+template
+<
+    typename T          // Numeric type
+    , int S             // System dimension
+    , int M             // Number of measurements
+    , int U             // Number of control inputs
+    , typename Process  // Process model: state-k-1, control => state-k
+    , typename Measure  // Measurement model: state => measurement estimation
+>
+class kalman_ensemble
+{
+public:
+    using kalman_t = num::kalman<T,S,M,U>;
+
+    using real_t = T;                       // Numeric type for computations
+    using Q_t    = typename kalman_t::Q_t;  // Process noise covariance
+    using R_t    = typename kalman_t::R_t;  // Measurement noise covariance
+    using P_t    = typename kalman_t::P_t;  // Estimate error covariance
+    using K_t    = typename kalman_t::K_t;  // Kalman gain
+    using u_t    = typename kalman_t::u_t;  // Control inputs
+    using z_t    = typename kalman_t::z_t;  // Measurements inputs
+    using xhat_t = typename kalman_t::xhat_t; // System state estimate
+
+    // Constructor, drawing the initial ensemble from N(xhat, P):
+
+    kalman_ensemble(
+        worker_pool & pool_     // Threads to propagate and update members
+        , real_t const dt_      // Time step
+        , Process const & f_    // Process model
+        , Measure const & h_    // Measurement model
+        , Q_t const & Q_        // Process noise covariance
+        , R_t const & R_        // Measurement noise covariance
+        , P_t const & P_        // Initial estimate error covariance
+        , xhat_t const & xhat_  // Initial system state estimate
+        , int const members     // Number of ensemble members, N
+        , std::uint64_t seed_ = 1 // Seed of the random perturbations
+    )
+        : pool( pool_)
+        , f( f_)
+        , h( h_)
+        , N( members )
+        , seed( seed_)
+        , R( R_)
+        , Lq( factor( Q_ ) )
+        , Lr( cholesky( symmatrix<T,M>( R_ ) ) )
+        , X( static_cast<std::size_t>( N ) * S )
+        , HX( static_cast<std::size_t>( N ) * M )
+        , K( 0 )
+        , t(  0  )
+        , dt( dt_)
+        , k(  0  )
+    {
+        const auto Lp = factor( P_ );
+
+        pool.for_each( N, [&]( int b, int e )
+        {
+            for ( int i = b; i < e; ++i )
+            {
+                put( X.data() + index( i, S ), xhat_ + perturbation<S>( Lp, i, 0 ) );
+            }
+        });
+    }
+
+    // Update estimator for dt, predict and correct:
+
+    void update( u_t const & u, z_t const & z )
+    {
+        predict( u );
+        correct( z );
+    }
+
+    // --------------------------------------
+    // 1. Predict (time update) for dt, propagate each member with process noise:
+
+    void predict( u_t const & u )
+    {
+        // Update the time:
+        t += dt;
+        ++k;
+
+        pool.for_each( N, [&]( int b, int e )
+        {
+            for ( int i = b; i < e; ++i )
+            {
+                T * x = X.data() + index( i, S );
+
+                put( x, f( get<S>( x ), u ) + perturbation<S>( Lq, i, 0 ) );
+            }
+        });
+    }
+
+    // --------------------------------------
+    // 2. Correct (measurement update), each member with a perturbed measurement:
+
+    void correct( z_t const & z )
+    {
+        // Predicted measurements of the members:
+        pool.for_each( N, [&]( int b, int e )
+        {
+            for ( int i = b; i < e; ++i )
+            {
+                put( HX.data() + index( i, M ), h( get<S>( X.data() + index( i, S ) ) ) );
+            }
+        });
+
+        // 2a: Compute the Kalman gain from the anomalies, Pxz * inverted(Pzz + R):
+        const auto xm = mean<S>( X );
+        const auto zm = mean<M>( HX );
+
+        K_t Pxz(0);
+
+        pool.for_each( S, [&]( int b, int e )
+        {
+            for ( int r = b; r < e; ++r )
+            {
+                for ( int i = 0; i < N; ++i )
+                {
+                    const T dx = X[ index( i, S ) + r ] - xm(r);
+
+                    for ( int c = 0; c < M; ++c )
+                    {
+                        Pxz(r,c) += dx * ( HX[ index( i, M ) + c ] - zm(c) );
+                    }
+                }
+            }
+        });
+
+        R_t Pzz(0);
+
+        for ( int i = 0; i < N; ++i )
+        {
+            for ( int r = 0; r < M; ++r )
+            {
+                const T dr = HX[ index( i, M ) + r ] - zm(r);
+
+                for ( int c = r; c < M; ++c )
+                {
+                    Pzz(r,c) += dr * ( HX[ index( i, M ) + c ] - zm(c) );
+                }
+            }
+        }
+
+        const T scale = T(1) / T( N - 1 );
+
+        for ( int r = 0; r < M; ++r )
+        {
+            for ( int c = r; c < M; ++c )
+            {
+                Pzz(r,c) = Pzz(c,r) = scale * Pzz(r,c) + R(r,c);
+            }
+        }
+
+        K = scale * Pxz * inverted( Pzz );
+
+        // 2b, 2c: Update the members with perturbed measurements:
+        pool.for_each( N, [&]( int b, int e )
+        {
+            for ( int i = b; i < e; ++i )
+            {
+                T * x = X.data() + index( i, S );
+
+                z_t innovation = perturbation<M>( Lr, i, S );
+
+                for ( int m = 0; m < M; ++m )
+                {
+                    innovation(m) += z(m) - HX[ index( i, M ) + m ];
+                }
+
+                put( x, get<S>( x ) + K * innovation );
+            }
+        });
+    }
+
+    // Observers:
+
+    // Ensemble mean:
+
+    xhat_t system_state() const
+    {
+        return mean<S>( X );
+    }
+
+    K_t kalman_gain() const
+    {
+        return K;
+    }
+
+    // Ensemble covariance, from the anomalies of the members, row by row in
+    // parallel; the returned matrix is the only S x S object:
+
+    P_t estimation_error_covariance() const
+    {
+        const auto xm = mean<S>( X );
+
+        std::vector<T> D( X.size() );
+
+        for ( int i = 0; i < N; ++i )
+        {
+            for ( int r = 0; r < S; ++r )
+            {
+                D[ index( i, S ) + r ] = X[ index( i, S ) + r ] - xm(r);
+            }
+        }
+
+        const T scale = T(1) / T( N - 1 );
+
+        P_t result(0);
+
+        pool.for_each( S, [&]( int b, int e )
+        {
+            for ( int r = b; r < e; ++r )
+            {
+                for ( int i = 0; i < N; ++i )
+                {
+                    const T dr = D[ index( i, S ) + r ];
+
+                    for ( int c = r; c < S; ++c )
+                    {
+                        result(r,c) += dr * D[ index( i, S ) + c ];
+                    }
+                }
+
+                for ( int c = r; c < S; ++c )
+                {
+                    result(r,c) = scale * result(r,c);
+                }
+            }
+        });
+
+        for ( int r = 0; r < S; ++r )
+        {
+            for ( int c = 0; c < r; ++c )
+            {
+                result(r,c) = result(c,r);
+            }
+        }
+        return result;
+    }
+
+    xhat_t member( int const i ) const
+    {
+        return get<S>( X.data() + index( i, S ) );
+    }
+
+    int members() const
+    {
+        return N;
+    }
+
+    real_t time() const
+    {
+        return t;
+    }
+
+private:
+    using L_t = std::vector<T>;  // Lower triangular Cholesky factor, row-major SxS
+
+    // Cholesky factor of the upper triangle of P, computed in place on the
+    // heap as cholesky() does, without S x S temporaries on the stack:
+
+    static L_t factor( P_t const & P )
+    {
+        L_t L( index( S, S ), T(0) );
+
+        for ( int j = 0; j < S; ++j )
+        {
+            T d = P(j,j);
+
+            for ( int k = 0; k < j; ++k )
+            {
+                d -= element( L, j, k ) * element( L, j, k );
+            }
+
+            if ( !( T(0) < d ) )
+            {
+                continue;
+            }
+
+            const T ljj = square_root( d );
+
+            L[ index( j, S ) + j ] = ljj;
+
+            for ( int i = j + 1; i < S; ++i )
+            {
+                T p = P(j,i);
+
+                for ( int k = 0; k < j; ++k )
+                {
+                    p -= element( L, i, k ) * element( L, j, k );
+                }
+                L[ index( i, S ) + j ] = p / ljj;
+            }
+        }
+        return L;
+    }
+
+    static std::size_t index( int const i, int const D )
+    {
+        return static_cast<std::size_t>( i ) * D;
+    }
+
+    template< int D >
+    static colvec<T,D> get( T const * p )
+    {
+        colvec<T,D> result(0);
+        std20::copy( p, p + D, result.begin() );
+        return result;
+    }
+
+    template< int D >
+    static void put( T * p, colvec<T,D> const & v )
+    {
+        std20::copy( v.begin(), v.end(), p );
+    }
+
+    // Mean of the members' vectors:
+
+    template< int D >
+    colvec<T,D> mean( std::vector<T> const & V ) const
+    {
+        colvec<T,D> result(0);
+
+        for ( int i = 0; i < N; ++i )
+        {
+            for ( int r = 0; r < D; ++r )
+            {
+                result(r) += V[ index( i, D ) + r ];
+            }
+        }
+        return ( T(1) / T( N ) ) * result;
+    }
+
+    // Draw L * n, n standard normal, for member i at the current time-step:
+
+    template< int D, typename L >
+    colvec<T,D> perturbation( L const & Lf, int const i, int const offset ) const
+    {
+        colvec<T,D> n(0);
+
+        for ( int j = 0; j < D; ++j )
+        {
+            n(j) = normal( i, offset + j );
+        }
+
+        colvec<T,D> result(0);
+
+        for ( int r = 0; r < D; ++r )
+        {
+            for ( int c = 0; c <= r; ++c )
+            {
+                result(r) += element( Lf, r, c ) * n(c);
+            }
+        }
+        return result;
+    }
+
+    static T element( L_t const & L, int r, int c ) { return L[ index( r, S ) + c ]; }
+    static T element( matrix<T,M,M> const & L, int r, int c ) { return L(r,c); }
+
+    // Standard normal variate, a function of seed, time-step, member and
+    // component (counter-based: splitmix64 and Box-Muller):
+
+    T normal( int const i, int const j ) const
+    {
+        const std::uint64_t a = mix( mix( mix( seed + k ) + static_cast<std::uint64_t>( i ) ) + static_cast<std::uint64_t>( j ) );
+        const std::uint64_t b = mix( a );
+
+        const double u1 = ( ( a >> 11 ) + 1 ) * ( 1.0 / 9007199254740993.0 );
+        const double u2 = ( b >> 11 ) * ( 1.0 / 9007199254740992.0 );
+
+        return T( std::sqrt( -2 * std::log( u1 ) ) * std::cos( 6.283185307179586 * u2 ) );
+    }
+
+    static std::uint64_t mix( std::uint64_t z )
+    {
+        z += 0x9e3779b97f4a7c15ull;
+        z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ull;
+        z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebull;
+        return z ^ ( z >> 31 );
+    }
+
+private:
+    worker_pool & pool; // Threads to propagate and update members
+    Process const f;    // Process model
+    Measure const h;    // Measurement model
+
+    int const N;                // Number of members
+    std::uint64_t const seed;   // Seed of the random perturbations
+
+    R_t const R;                // Measurement noise covariance
+    L_t const Lq;               // Process noise covariance, Cholesky factor
+    matrix<T,M,M> const Lr;     // Measurement noise covariance, Cholesky factor
+
+    std::vector<T> X;   // Members, N x S
+    std::vector<T> HX;  // Predicted measurements of members, N x M
+
+    K_t K;              // Kalman gain
+
+    real_t t;           // Elapsed time
+    real_t dt;          // Time-step
+    std::uint64_t k;    // Time-step count
+};
+
+} // namespace num
+
+#endif // NUM_KALMAN_ENSEMBLE_HPP_INCLUDED
@@ -0,0 +1,166 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef NUM_KALMAN_EXTENDED_HPP_INCLUDED
+#define NUM_KALMAN_EXTENDED_HPP_INCLUDED
+
+#include "dsp/kalman.hpp"
+#include "num/dual.hpp"
+
+namespace num {
+
+//
+// Extended Kalman estimator for nonlinear process and measurement models.
+//
+// The models are function objects with a call operator templated on the
+// numeric type V, which is either T or num::dual<T,S>:
+//
+//   template< typename V >
+//   colvec<V,S> Process::operator()( colvec<V,S> const & x, colvec<T,U> const & u ) const;
+//
+//   template< typename V >
+//   colvec<V,M> Measure::operator()( colvec<V,S> const & x ) const;
+//
+// A single evaluation with dual numbers yields both the model's value and
+// its Jacobian (forward-mode automatic differentiation), so that neither
+// hand-written Jacobians nor finite differences are needed.
+//
+template
+<
+    typename T          // Numeric type
+    , int S             // System dimension
+    , int M             // Number of measurements
+    , int U             // Number of control inputs
+    , typename Process  // Process model: state-k-1, control => state-k
+    , typename Measure  // Measurement model: state => measurement estimation
+>
+class kalman_extended
+{
+public:
+    using kalman_t = num::kalman<T,S,M,U>;
+
+    using real_t = T;                       // Numeric type for computations
+    using F_t    = typename kalman_t::A_t;  // Jacobian of process model
+    using H_t    = typename kalman_t::H_t;  // Jacobian of measurement model
+    using Q_t    = typename kalman_t::Q_t;  // Process noise covariance
+    using R_t    = typename kalman_t::R_t;  // Measurement noise covariance
+    using P_t    = typename kalman_t::P_t;  // Estimate error covariance
+    using K_t    = typename kalman_t::K_t;  // Kalman gain
+    using u_t    = typename kalman_t::u_t;  // Control inputs
+    using z_t    = typename kalman_t::z_t;  // Measurements inputs
+    using xhat_t = typename kalman_t::xhat_t; // System state estimate
+    using Psym_t = typename kalman_t::Psym_t; // Covariance, packed symmetric storage
+
+    using dual_t = num::dual<T,S>;          // Numeric type for differentiation
+
+    // Constructor
+
+    kalman_extended(
+        real_t const dt_        // Time step
+        , Process const & f_    // Process model
+        , Measure const & h_    // Measurement model
+        , Q_t const & Q_        // Process noise covariance
+        , R_t const & R_        // Measurement noise covariance
+        , P_t const & P_        // Initial estimate error covariance
+        , xhat_t const & xhat_  // Initial system state estimate
+    )
+        : f( f_)
+        , h( h_)
+        , Q( Q_)
+        , R( R_)
+        , K( 0 )
+        , P( P_)
+        , xhat( xhat_)
+        , t(  0  )
+        , dt( dt_)
+    {}
+
+    // Update estimator for dt, predict and correct:
+
+    void update( u_t const & u, z_t const & z )
+    {
+        predict( u );
+        correct( z );
+    }
+
+    // --------------------------------------
+    // 1. Predict (time update) for dt:
+
+    void predict( u_t const & u )
+    {
+        // Update the time:
+        t += dt;
+
+        // 1a: Project the state ahead, with F = df/dx at xhat:
+        const auto fx = f( seed( xhat ), u );
+
+        const F_t F = jacobian( fx );
+        xhat = values( fx );
+
+        // 1b: Project the error covariance ahead, F * P * transposed(F) + Q:
+        P = congruence( F, P ) + Q;
+    }
+
+    // --------------------------------------
+    // 2. Correct (measurement update), with H = dh/dx at xhat:
+
+    void correct( z_t const & z )
+    {
+        const auto hx = h( seed( xhat ) );
+
+        const H_t H = jacobian( hx );
+
+        // 2a: Compute the Kalman gain:
+        const auto PHt = P * transposed(H);
+        K = PHt * inverted(H * PHt + R);
+
+        // 2c: Update the error covariance, (I - K * H) * P:
+        P = rank_downdate( P, K, PHt );
+
+        // 2b: Update estimate with measurement:
+        xhat = xhat + K * (z - values( hx ));
+    }
+
+    // Observers:
+
+    xhat_t system_state() const
+    {
+        return xhat;
+    }
+
+    K_t kalman_gain() const
+    {
+        return K;
+    }
+
+    P_t estimation_error_covariance() const
+    {
+        return to_matrix( P );
+    }
+
+    real_t time() const
+    {
+        return t;
+    }
+
+private:
+    Process const f;    // Process model
+    Measure const h;    // Measurement model
+    Psym_t Q;           // Process noise covariance
+    R_t R;              // Measurement noise covariance
+
+    K_t K;              // Kalman gain
+    Psym_t P;           // Estimate error covariance
+    xhat_t xhat;        // System state estimate
+
+    real_t t;           // Elapsed time
+    real_t dt;          // Time-step
+};
+
+} // namespace num
+
+#endif // NUM_KALMAN_EXTENDED_HPP_INCLUDED
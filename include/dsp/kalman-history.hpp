@@ -0,0 +1,195 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef NUM_KALMAN_HISTORY_HPP_INCLUDED
+#define NUM_KALMAN_HISTORY_HPP_INCLUDED
+
+#include "dsp/kalman.hpp"
+
+namespace num {
+
+//
+// Kalman estimator that remembers its last N time-steps, to apply a
+// measurement that arrives late (out of sequence).
+//
+// Per time-step, a fixed-capacity ring holds the estimator state before
+// the step, the control input and up to Z measurements; there is no heap
+// use. correct_at(k, z) rewinds to time-step k, applies z in addition to
+// the measurements of that step and re-propagates the steps since then
+// with their recorded inputs and measurements. The snapshot restores the
+// Kalman gain mode and the rejection and automatic gain fixing counters of
+// time-step k, so that the replay counts as if the measurements arrived in
+// sequence; the replay is kept out of the telemetry record.
+//
+template
+<
+    typename Kalman     // Estimator, e.g. num::kalman<T,S,M,U>
+    , int N             // Number of time-steps remembered
+    , int Z = 2         // Number of measurements per time-step
+>
+class kalman_history : public Kalman
+{
+    static_assert( N >= 1, "kalman_history: requires a history of at least one time-step" );
+    static_assert( Z >= 1, "kalman_history: requires at least one measurement per time-step" );
+
+public:
+    using typename Kalman::u_t;
+    using typename Kalman::z_t;
+    using typename Kalman::snapshot_t;
+
+    // Constructors of estimator:
+
+    using Kalman::Kalman;
+
+    // Number of time-steps remembered:
+
+    static constexpr int capacity()
+    {
+        return N;
+    }
+
+    // Number of time-steps taken:
+
+    long step() const
+    {
+        return steps;
+    }
+
+    // Oldest time-step that correct_at() accepts:
+
+    long oldest_step() const
+    {
+        return steps - ( steps < N ? steps : N ) + 1;
+    }
+
+    // Update estimator for dt, predict and correct:
+
+    bool update( u_t const & u, z_t const & z )
+    {
+        predict( u );
+        return correct( z );
+    }
+
+    // Predict for dt, starting a new time-step:
+
+    void predict( u_t const & u )
+    {
+        entry & e = ring[ ++steps % N ];
+
+        e.state = Kalman::snapshot();
+        e.u     = u;
+        e.nz    = 0;
+
+        Kalman::predict( u );
+    }
+
+    // Correct with a measurement of the current time-step; returns false if
+    // the estimator rejects it, or, leaving the estimator unchanged, if the
+    // time-step already has Z measurements, as these could not be replayed:
+
+    bool correct( z_t const & z )
+    {
+        entry & e = ring[ steps % N ];
+
+        if ( e.nz >= Z )
+        {
+            return false;
+        }
+
+        e.z[ e.nz++ ] = z;
+
+        return Kalman::correct( z );
+    }
+
+    // Correct with measurement z of earlier time-step k, oldest_step() <= k <= step(),
+    // re-propagating time-steps k+1 up to step(); returns false, leaving the
+    // estimator unchanged, if k is outside the history or time-step k already
+    // has Z measurements:
+
+    bool correct_at( long k, z_t const & z )
+    {
+        if ( k < oldest_step() || k > steps || ring[ k % N ].nz >= Z )
+        {
+            return false;
+        }
+
+        entry & ek = ring[ k % N ];
+
+        ek.z[ ek.nz++ ] = z;
+
+        replay( k );
+
+        return true;
+    }
+
+private:
+    // Re-propagate time-steps k up to step() from the state before time-step k:
+
+    void replay( long k )
+    {
+        if constexpr ( has_telemetry<Kalman>::value )
+        {
+            const auto record = Kalman::telemetry();
+
+            propagate( k );
+
+            Kalman::restore_telemetry( record );
+        }
+        else
+        {
+            propagate( k );
+        }
+    }
+
+    void propagate( long k )
+    {
+        for ( long j = k; j <= steps; ++j )
+        {
+            entry & e = ring[ j % N ];
+
+            if ( j == k )
+            {
+                Kalman::restore( e.state );
+            }
+            else
+            {
+                e.state = Kalman::snapshot();
+            }
+
+            Kalman::predict( e.u );
+
+            for ( int i = 0; i < e.nz; ++i )
+            {
+                Kalman::correct( e.z[i] );
+            }
+        }
+    }
+
+    // Estimators with a telemetry record, see kalman::restore_telemetry():
+
+    template< typename E, typename = void >
+    struct has_telemetry : std20::false_type {};
+
+    template< typename E >
+    struct has_telemetry< E, decltype( void( &E::restore_telemetry ) ) > : std20::true_type {};
+
+    struct entry
+    {
+        snapshot_t state;   // Estimator state before the time-step
+        u_t u;              // Control input
+        z_t z[Z];           // Measurements
+        int nz;             // Number of measurements
+    };
+
+private:
+    entry ring[N] = {}; // Last N time-steps
+    long steps = 0;     // Number of time-steps taken
+};
+
+} // namespace num
+
+#endif // NUM_KALMAN_HISTORY_HPP_INCLUDED
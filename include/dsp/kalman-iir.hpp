@@ -0,0 +1,221 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef NUM_KALMAN_IIR_HPP_INCLUDED
+#define NUM_KALMAN_IIR_HPP_INCLUDED
+
+#include "dsp/biquad-cascade.hpp"
+#include "dsp/kalman.hpp"
+
+namespace num {
+
+//
+// With a fixed Kalman gain K, predict and correct of num::kalman reduce to
+// the linear time-invariant recursion
+//
+//   xhat[n] = F xhat[n-1] + G u[n] + K z[n],  F = (I - K H) A,  G = (I - K H) B
+//
+// The conversions below turn a steady-state estimator into a filter that
+// runs this recursion, for long measurement streams. The filter reproduces
+// the estimator as long as every measurement is accepted (see gate()).
+//
+
+//
+// State-space IIR filter: the recursion of the estimator, F, G and K
+// computed once.
+//
+template< typename T, int S, int M, int U >
+class state_space_filter
+{
+public:
+    using real_t = T;
+    using F_t    = num::matrix<T,S,S>;  // State transition of the estimate
+    using G_t    = num::matrix<T,S,U>;  // Control input matrix
+    using K_t    = num::matrix<T,S,M>;  // Kalman gain
+    using u_t    = num::colvec<T,U>;    // Control inputs
+    using z_t    = num::colvec<T,M>;    // Measurements inputs
+    using xhat_t = num::colvec<T,S>;    // System state estimate
+
+    constexpr state_space_filter( F_t const & F_, G_t const & G_, K_t const & K_, xhat_t const & xhat_ )
+        : F( F_)
+        , G( G_)
+        , K( K_)
+        , xhat( xhat_)
+    {}
+
+    // Step filter, return the estimate:
+
+    xhat_t const & step( u_t const & u, z_t const & z )
+    {
+        xhat_t next( 0 );
+
+        for ( int r = 0; r < S; ++r )
+        {
+            for ( int c = 0; c < S; ++c )
+            {
+                next(r) += F(r,c) * xhat(c);
+            }
+            for ( int c = 0; c < U; ++c )
+            {
+                next(r) += G(r,c) * u(c);
+            }
+            for ( int c = 0; c < M; ++c )
+            {
+                next(r) += K(r,c) * z(c);
+            }
+        }
+        xhat = next;
+        return xhat;
+    }
+
+    xhat_t const & step( z_t const & z )
+    {
+        return step( u_t( 0 ), z );
+    }
+
+    // Filter the measurements [first, last) without control input, writing
+    // the estimates to out; return the end of the output:
+
+    template< typename InputIt, typename OutputIt >
+    OutputIt step( InputIt first, InputIt last, OutputIt out )
+    {
+        for ( ; first != last; ++first, ++out )
+        {
+            *out = step( z_t( *first ) );
+        }
+        return out;
+    }
+
+    // Observers:
+
+    xhat_t system_state() const
+    {
+        return xhat;
+    }
+
+    F_t state_transition_matrix() const
+    {
+        return F;
+    }
+
+    // Modifiers:
+
+    void reset( xhat_t const & xhat_ )
+    {
+        xhat = xhat_;
+    }
+
+private:
+    F_t const F;    // State transition of the estimate, (I - K H) A
+    G_t const G;    // Control input matrix, (I - K H) B
+    K_t const K;    // Kalman gain
+    xhat_t xhat;    // System state estimate
+};
+
+namespace detail {
+
+// I - K H, loops also for 1x1:
+
+template< typename T, int S, int M >
+matrix<T,S,S> gain_complement( matrix<T,S,M> const & K, matrix<T,M,S> const & H )
+{
+    matrix<T,S,S> result = eye<T,S>();
+
+    for ( int r = 0; r < S; ++r )
+    {
+        for ( int c = 0; c < S; ++c )
+        {
+            for ( int m = 0; m < M; ++m )
+            {
+                result(r,c) -= K(r,m) * H(m,c);
+            }
+        }
+    }
+    return result;
+}
+
+// Product of a square and a rectangular matrix, loops also for 1x1:
+
+template< typename T, int S, int N >
+matrix<T,S,N> product_loop( matrix<T,S,S> const & A, matrix<T,S,N> const & B )
+{
+    matrix<T,S,N> result( 0 );
+
+    for ( int r = 0; r < S; ++r )
+    {
+        for ( int c = 0; c < N; ++c )
+        {
+            for ( int k = 0; k < S; ++k )
+            {
+                result(r,c) += A(r,k) * B(k,c);
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace detail
+
+// State-space IIR filter of the steady-state estimator, starting at its
+// current estimate:
+
+template< typename T, int S, int M, int U, typename Structure, typename Telemetry >
+auto to_state_space( kalman<T,S,M,U,Structure,Telemetry> const & estim )
+{
+    static_assert( !is_mixed_precision_v<T>, "to_state_space: requires a single numeric type" );
+
+    assert( estim.is_gain_fixed() );
+
+    const auto IKH = detail::gain_complement( estim.kalman_gain(), estim.measurement_output_matrix() );
+
+    return state_space_filter<T,S,M,U>(
+        detail::product_loop( IKH, estim.system_dynamics_matrix() )
+        , detail::product_loop( IKH, estim.control_input_matrix() )
+        , estim.kalman_gain()
+        , estim.system_state()
+    );
+}
+
+//
+// Bi-quad filter cascade of the steady-state estimator of a single
+// measurement, from z to estimate component i, for two states:
+//
+//             e_i' adj(I - F z^-1) K
+//   X_i(z) = ---------------------- Z(z)
+//              det(I - F z^-1)
+//
+// A single section with denominator 1 - tr(F) z^-1 + det(F) z^-2. The
+// cascade starts at rest: it reproduces the estimator started with a zero
+// estimate and without control input (u = 0).
+//
+template< int N = 1, typename T, int S, int M, int U, typename Structure, typename Telemetry >
+auto to_biquad_cascade( kalman<T,S,M,U,Structure,Telemetry> const & estim, int const i = 0 )
+{
+    static_assert( S == 2, "to_biquad_cascade: requires two states, use to_state_space()" );
+    static_assert( M == 1, "to_biquad_cascade: requires a single measurement" );
+    static_assert( N >= 1, "to_biquad_cascade: requires room for a section" );
+    static_assert( !is_mixed_precision_v<T>, "to_biquad_cascade: requires a single numeric type" );
+
+    assert( estim.is_gain_fixed() && 0 <= i && i < S );
+
+    using BiQuad = dsp::BiQuadT<T>;
+
+    const auto F = detail::product_loop( detail::gain_complement( estim.kalman_gain(), estim.measurement_output_matrix() ), estim.system_dynamics_matrix() );
+    const auto K = estim.kalman_gain();
+
+    const int j = 1 - i;
+
+    const T b1 = F(i,j) * K(j,0) - F(j,j) * K(i,0);
+    const T a1 = -( F(0,0) + F(1,1) );
+    const T a2 = F(0,0) * F(1,1) - F(0,1) * F(1,0);
+
+    return dsp::BiQuadCascadeT<T,N>( BiQuad{ { K(i,0), b1, T(0) }, { a1, a2 } } );
+}
+
+} // namespace num
+
+#endif // NUM_KALMAN_IIR_HPP_INCLUDED
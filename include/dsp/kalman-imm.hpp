@@ -0,0 +1,343 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef NUM_KALMAN_IMM_HPP_INCLUDED
+#define NUM_KALMAN_IMM_HPP_INCLUDED
+
+#include "dsp/kalman.hpp"
+
+namespace num {
+
+// Exponential by squaring the Taylor series of e^(x/2^k), |x/2^k| <= 1/2,
+// for floating point and fixed_point types alike:
+
+template< typename T >
+constexpr T exponential( T x )
+{
+    int k = 0;
+
+    while ( T(0.5) < x || x < T(-0.5) )
+    {
+        x = x * T(0.5);
+        ++k;
+    }
+
+    T term(1);
+    T result(1);
+
+    for ( int n = 1; n <= 10; ++n )
+    {
+        term = term * x / T(n);
+        result += term;
+    }
+
+    while ( k-- > 0 )
+    {
+        result = result * result;
+    }
+    return result;
+}
+
+// Executor that runs for_each( n, fn ) as fn( 0, n ) on the calling thread;
+// num::worker_pool provides the same interface to run in parallel:
+
+struct inline_executor
+{
+    template< typename F >
+    void for_each( int const n, F && fn )
+    {
+        fn( 0, n );
+    }
+};
+
+namespace detail {
+
+// Compile-time list of models, visited by run-time index:
+
+template< typename... Models >
+struct model_list
+{
+    template< typename F > void apply( int, F && ) {}
+    template< typename F > void apply( int, F && ) const {}
+};
+
+template< typename Model, typename... Models >
+struct model_list< Model, Models... >
+{
+    Model head;
+    model_list< Models... > tail;
+
+    model_list( Model const & m, Models const &... ms )
+        : head( m )
+        , tail( ms... )
+    {}
+
+    template< typename F >
+    void apply( int const i, F && f )
+    {
+        if ( i == 0 ) f( head ); else tail.apply( i - 1, f );
+    }
+
+    template< typename F >
+    void apply( int const i, F && f ) const
+    {
+        if ( i == 0 ) f( head ); else tail.apply( i - 1, f );
+    }
+};
+
+} // namespace detail
+
+//
+// Interacting Multiple Model (IMM) estimator.
+//
+// Runs a compile-time list of kalman estimators with equal dimensions, e.g.
+// a quiet and a manoeuvring process noise model, and a Markov chain of the
+// switching between them, transition(i,j) the probability to switch from
+// model i to model j per time-step. Each update mixes the model estimates,
+// updates each model with the mixed initial condition and updates the model
+// probabilities from the likelihood of the measurement under each model.
+//
+// The models update independently, on the calling thread or in parallel via
+// an executor, e.g. a num::worker_pool, and without heap allocation. Models
+// must update their Kalman gain (no fixed or automatically fixed gain).
+//
+template< typename Model, typename... Models >
+class kalman_imm
+{
+    static_assert( ( std20::is_same_v< typename Model::xhat_t, typename Models::xhat_t > && ... )
+                && ( std20::is_same_v< typename Model::z_t, typename Models::z_t > && ... )
+                && ( std20::is_same_v< typename Model::u_t, typename Models::u_t > && ... ),
+                "kalman_imm: requires models with equal numeric type and dimensions" );
+
+public:
+    static constexpr int N = 1 + sizeof...(Models);   // Number of models
+
+    using real_t = typename Model::real_t;
+    using u_t    = typename Model::u_t;
+    using z_t    = typename Model::z_t;
+    using xhat_t = typename Model::xhat_t;
+    using P_t    = typename Model::P_t;
+    using Psym_t = typename Model::Psym_t;
+
+    using mu_t   = num::colvec<real_t,N>;       // Model probabilities
+    using Pi_t   = num::matrix<real_t,N,N>;     // Model transition probabilities
+
+    // Constructor
+
+    kalman_imm(
+        Pi_t const & transition_    // Model transition probabilities, rows sum to 1
+        , mu_t const & mu_          // Initial model probabilities, sum to 1
+        , Model const & model       // Models
+        , Models const &... models
+    )
+        : models( model, models... )
+        , transition( transition_)
+        , mu( mu_)
+    {}
+
+    // Update estimator, models in sequence:
+
+    void update( u_t const & u, z_t const & z )
+    {
+        inline_executor ex;
+        update( u, z, ex );
+    }
+
+    // Update estimator, models via executor ex, e.g. a worker_pool:
+
+    template< typename Executor >
+    void update( u_t const & u, z_t const & z, Executor & ex )
+    {
+        // Mixing: predicted model probabilities c(j) and weights mu(i|j):
+        mu_t c(0);
+        Pi_t w(0);
+
+        for ( int j = 0; j < N; ++j )
+        {
+            for ( int i = 0; i < N; ++i )
+            {
+                c(j) += transition(i,j) * mu(i);
+            }
+
+            for ( int i = 0; i < N; ++i )
+            {
+                w(i,j) = c(j) == real_t(0) ? real_t( i == j ) : transition(i,j) * mu(i) / c(j);
+            }
+        }
+
+        // Estimates of the models:
+        xhat_t x[N];
+        Psym_t P[N];
+
+        for ( int i = 0; i < N; ++i )
+        {
+            models.apply( i, [&]( auto const & m )
+            {
+                const auto s = m.snapshot();
+                x[i] = s.xhat;
+                P[i] = s.P;
+            });
+        }
+
+        // Update each model from its mixed initial condition, recording the
+        // exponent and determinant of the likelihood of z under the model:
+        real_t exponent[N];
+        real_t det[N];
+
+        ex.for_each( N, [&]( int b, int e )
+        {
+            for ( int j = b; j < e; ++j )
+            {
+                models.apply( j, [&]( auto & m )
+                {
+                    auto s = m.snapshot();
+                    s.xhat = mixed( x, P, w, j, s.P );
+                    m.restore( s );
+
+                    m.predict( u );
+
+                    const auto S = m.innovation_covariance();
+
+                    exponent[j] = real_t(-0.5) * mahalanobis_squared( S, m.innovation( z ) );
+                    det[j] = determinant( S );
+
+                    m.correct( z );
+                });
+            }
+        });
+
+        // Model probabilities, c(j) * likelihood(j), normalized; likelihoods
+        // relative to the largest exponent to avoid underflow:
+        real_t largest = exponent[0];
+
+        for ( int j = 1; j < N; ++j )
+        {
+            largest = largest < exponent[j] ? exponent[j] : largest;
+        }
+
+        mu_t next(0);
+        real_t sum(0);
+
+        for ( int j = 0; j < N; ++j )
+        {
+            next(j) = det[j] > real_t(0) ? c(j) * exponential( exponent[j] - largest ) / square_root( det[j] ) : real_t(0);
+            sum += next(j);
+        }
+
+        if ( sum > real_t(0) )
+        {
+            for ( int j = 0; j < N; ++j )
+            {
+                mu(j) = next(j) / sum;
+            }
+        }
+        else
+        {
+            mu = c;
+        }
+    }
+
+    // Observers:
+
+    // Combined estimate, weighted by the model probabilities:
+
+    xhat_t system_state() const
+    {
+        xhat_t result(0);
+
+        for ( int i = 0; i < N; ++i )
+        {
+            models.apply( i, [&]( auto const & m )
+            {
+                result = result + mu(i) * m.system_state();
+            });
+        }
+        return result;
+    }
+
+    P_t estimation_error_covariance() const
+    {
+        const auto xc = system_state();
+
+        P_t result(0);
+
+        for ( int i = 0; i < N; ++i )
+        {
+            models.apply( i, [&]( auto const & m )
+            {
+                const auto d = m.system_state() - xc;
+
+                result = result + mu(i) * ( m.estimation_error_covariance() + d * transposed( d ) );
+            });
+        }
+        return result;
+    }
+
+    mu_t model_probabilities() const
+    {
+        return mu;
+    }
+
+    template< int I >
+    auto const & model() const
+    {
+        return get<I>( models );
+    }
+
+    real_t time() const
+    {
+        return get<0>( models ).time();
+    }
+
+private:
+    template< int I, typename List >
+    static auto const & get( List const & list )
+    {
+        if constexpr ( I == 0 ) return list.head; else return get<I - 1>( list.tail );
+    }
+
+    // Mixed initial condition of model j, estimate returned, covariance in Pj:
+
+    static xhat_t mixed( xhat_t const * x, Psym_t const * P, Pi_t const & w, int const j, Psym_t & Pj )
+    {
+        xhat_t x0(0);
+
+        for ( int i = 0; i < N; ++i )
+        {
+            x0 = x0 + w(i,j) * x[i];
+        }
+
+        Pj = Psym_t(0);
+
+        for ( int i = 0; i < N; ++i )
+        {
+            const auto d = x[i] - x0;
+
+            auto pos = Pj.begin();
+            auto pi  = P[i].begin();
+
+            for ( int r = 0; r < d.rows(); ++r )
+            {
+                for ( int c = r; c < d.rows(); ++c, ++pos, ++pi )
+                {
+                    *pos += w(i,j) * ( *pi + d(r) * d(c) );
+                }
+            }
+        }
+        return x0;
+    }
+
+private:
+    detail::model_list< Model, Models... > models;  // Models
+
+    Pi_t const transition;  // Model transition probabilities
+    mu_t mu;                // Model probabilities
+};
+
+} // namespace num
+
+#endif // NUM_KALMAN_IMM_HPP_INCLUDED
@@ -0,0 +1,352 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef NUM_KALMAN_SMOOTHER_HPP_INCLUDED
+#define NUM_KALMAN_SMOOTHER_HPP_INCLUDED
+
+// Desktop: Rauch-Tung-Striebel smoother for recorded runs.
+
+#include "dsp/kalman.hpp"
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Configuration:
+
+// Provide the memory-mapped moment store (1), or not (0):
+
+#ifndef  KE_HAVE_MMAP
+# if defined( __unix__ ) || defined( __APPLE__ )
+#  define KE_HAVE_MMAP  1
+# else
+#  define KE_HAVE_MMAP  0
+# endif
+#endif
+
+#if KE_HAVE_MMAP
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+namespace num {
+
+//
+// Predicted and filtered moments of one time-step, with packed covariances.
+// The record is trivially copyable, so that a store can keep it in a flat
+// array or a memory-mapped file:
+//
+template< typename T, int S >
+struct kalman_moments
+{
+    colvec<T,S>    xp;  // Predicted state estimate
+    symmatrix<T,S> Pp;  // Predicted estimate error covariance
+    colvec<T,S>    xf;  // Filtered, after smoothing: smoothed, state estimate
+    symmatrix<T,S> Pf;  // Filtered, after smoothing: smoothed, estimate error covariance
+};
+
+//
+// Moment store in memory, a single contiguous array of records:
+//
+template< typename Record >
+class vector_store
+{
+public:
+    using record_t = Record;
+
+    void push_back( record_t const & r )
+    {
+        records.push_back( r );
+    }
+
+    record_t & operator[]( std::size_t k )
+    {
+        return records[k];
+    }
+
+    std::size_t size() const
+    {
+        return records.size();
+    }
+
+    void clear()
+    {
+        records.clear();
+    }
+
+private:
+    std::vector<record_t> records;
+};
+
+#if KE_HAVE_MMAP
+
+//
+// Moment store in a memory-mapped file, which grows by doubling; only the
+// pages in use occupy memory, so that its size is limited by disk space:
+//
+template< typename Record >
+class mapped_store
+{
+    static_assert( std::is_trivially_copyable<Record>::value, "mapped_store: requires a trivially copyable record" );
+
+public:
+    using record_t = Record;
+
+    explicit mapped_store( std::string const & path, std::size_t initial_capacity = 4096 )
+        : fd( ::open( path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 ) )
+    {
+        if ( fd < 0 )
+        {
+            throw std::runtime_error( "mapped_store: cannot open '" + path + "'" );
+        }
+
+        // The destructor does not run for a failed constructor:
+
+        try
+        {
+            reserve( initial_capacity > 0 ? initial_capacity : 1 );
+        }
+        catch ( ... )
+        {
+            ::close( fd );
+            throw;
+        }
+    }
+
+    mapped_store( mapped_store const & ) = delete;
+    mapped_store & operator=( mapped_store const & ) = delete;
+
+    ~mapped_store()
+    {
+        unmap();
+        ::close( fd );
+    }
+
+    void push_back( record_t const & r )
+    {
+        if ( count == capacity )
+        {
+            reserve( 2 * capacity );
+        }
+        records[ count++ ] = r;
+    }
+
+    record_t & operator[]( std::size_t k )
+    {
+        return records[k];
+    }
+
+    std::size_t size() const
+    {
+        return count;
+    }
+
+    void clear()
+    {
+        count = 0;
+    }
+
+private:
+    // Grow the file and map it anew before releasing the old mapping, so
+    // that the store remains usable if either fails, e.g. on a full disk:
+
+    void reserve( std::size_t n )
+    {
+        if ( ::ftruncate( fd, static_cast<off_t>( n * sizeof( record_t ) ) ) != 0 )
+        {
+            throw std::runtime_error( "mapped_store: cannot grow file" );
+        }
+
+        void * p = ::mmap( nullptr, n * sizeof( record_t ), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+
+        if ( p == MAP_FAILED )
+        {
+            throw std::runtime_error( "mapped_store: cannot map file" );
+        }
+
+        unmap();
+
+        records  = static_cast<record_t *>( p );
+        capacity = n;
+    }
+
+    void unmap()
+    {
+        if ( records )
+        {
+            ::munmap( records, capacity * sizeof( record_t ) );
+            records = nullptr;
+        }
+    }
+
+private:
+    int fd;
+    record_t * records = nullptr;
+    std::size_t capacity = 0;
+    std::size_t count = 0;
+};
+
+#endif // KE_HAVE_MMAP
+
+//
+// Rauch-Tung-Striebel smoother.
+//
+// The forward pass runs a num::kalman and appends the predicted and filtered
+// moments of every time-step to the store. The backward pass replaces the
+// filtered moments by smoothed ones in place, from the last time-step to
+// the first:
+//
+//   C  = Pf(k) * transposed(A) * inverted(Pp(k+1))
+//   xs = xf(k) + C * (xs(k+1) - xp(k+1))
+//   Ps = Pf(k) + C * (Ps(k+1) - Pp(k+1)) * transposed(C)
+//
+// Beyond the store, both passes use memory for a single time-step only.
+// The estimator must update its Kalman gain, see num::kalman<>::update_gain().
+//
+template
+<
+    typename T      // Numeric type
+    , int S         // System dimension
+    , int M         // Number of measurements
+    , int U         // Number of control inputs
+    , typename Store = vector_store< kalman_moments<T,S> >
+>
+class kalman_smoother
+{
+public:
+    using kalman_t = num::kalman<T,S,M,U>;
+
+    using real_t = T;                       // Numeric type for computations
+    using A_t    = typename kalman_t::A_t;  // System dynamics matrix: state-k-1 => state-k
+    using B_t    = typename kalman_t::B_t;  // Control input matrix: control => state
+    using H_t    = typename kalman_t::H_t;  // Measurement output matrix: state => measurement estimation
+    using Q_t    = typename kalman_t::Q_t;  // Process noise covariance
+    using R_t    = typename kalman_t::R_t;  // Measurement noise covariance
+    using P_t    = typename kalman_t::P_t;  // Estimate error covariance
+    using u_t    = typename kalman_t::u_t;  // Control inputs
+    using z_t    = typename kalman_t::z_t;  // Measurements inputs
+    using xhat_t = typename kalman_t::xhat_t; // System state estimate
+
+    using record_t = kalman_moments<T,S>;
+    using store_t  = Store;
+
+    // Constructor, the smoother records into store:
+
+    kalman_smoother(
+        store_t & store_        // Moment store
+        , real_t const dt_      // Time step
+        , A_t const & A_        // System dynamics matrix: state-k-1 => state-k
+        , B_t const & B_        // Control input matrix: control => state
+        , H_t const & H_        // Measurement output matrix: state => measurement estimation
+        , Q_t const & Q_        // Process noise covariance
+        , R_t const & R_        // Measurement noise covariance
+        , P_t const & P_        // Initial estimate error covariance
+        , xhat_t const & xhat_  // Initial system state estimate
+    )
+        : store( store_ )
+        , estim( dt_, A_, B_, H_, Q_, R_, P_, xhat_ )
+        , A( A_ )
+    {}
+
+    // Forward pass, one time-step with measurement:
+
+    void update( u_t const & u, z_t const & z )
+    {
+        estim.predict( u );
+
+        const auto prior = estim.snapshot();
+
+        estim.correct( z );
+
+        const auto posterior = estim.snapshot();
+
+        store.push_back( { prior.xhat, prior.P, posterior.xhat, posterior.P } );
+    }
+
+    // Forward pass, one time-step without measurement:
+
+    void predict( u_t const & u )
+    {
+        estim.predict( u );
+
+        const auto prior = estim.snapshot();
+
+        store.push_back( { prior.xhat, prior.P, prior.xhat, prior.P } );
+    }
+
+    // Backward pass:
+
+    void smooth()
+    {
+        const auto n = store.size();
+
+        if ( n < 2 )
+        {
+            return;
+        }
+
+        const auto At = transposed( A );
+
+        auto xs = store[ n - 1 ].xf;
+        auto Ps = store[ n - 1 ].Pf;
+
+        for ( auto k = n - 1; k-- > 0; )
+        {
+            record_t & next = store[ k + 1 ];
+            record_t & curr = store[ k ];
+
+            const auto C = to_matrix( curr.Pf ) * At * inverted( to_matrix( next.Pp ) );
+
+            xs = curr.xf + C * ( xs - next.xp );
+            Ps = curr.Pf + congruence( C, Ps - next.Pp );
+
+            curr.xf = xs;
+            curr.Pf = Ps;
+        }
+    }
+
+    // Observers:
+
+    // The filtering estimator:
+
+    kalman_t const & estimator() const
+    {
+        return estim;
+    }
+
+    // Number of time-steps recorded:
+
+    std::size_t size() const
+    {
+        return store.size();
+    }
+
+    // Filtered, or after smooth(), smoothed estimate of time-step k:
+
+    xhat_t system_state( std::size_t k ) const
+    {
+        return store[k].xf;
+    }
+
+    P_t estimation_error_covariance( std::size_t k ) const
+    {
+        return to_matrix( store[k].Pf );
+    }
+
+private:
+    store_t & store;    // Moment store
+    kalman_t estim;     // Filtering estimator
+    A_t const A;        // System dynamics matrix
+};
+
+} // namespace num
+
+#endif // NUM_KALMAN_SMOOTHER_HPP_INCLUDED
@@ -0,0 +1,147 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef NUM_KALMAN_TELEMETRY_HPP_INCLUDED
+#define NUM_KALMAN_TELEMETRY_HPP_INCLUDED
+
+#include "num/matrix.hpp"
+
+namespace num {
+
+//
+// Telemetry policies of num::kalman.
+//
+// A policy provides recorder<T,M>, of which the estimator derives, so that
+// a recorder without data takes no space. The estimator calls:
+//
+//   unsigned long ticks() const;       // Clock for the phase durations
+//   void on_predict( unsigned long predict );
+//   void on_correct( colvec<T,M> const & innovation, T nis, bool gain_fixed,
+//                    bool accepted, unsigned long gain, unsigned long correct );
+//
+// on_correct() closes a time-step, with the innovation and its normalized
+// square (see kalman::gate()), whether the Kalman gain is fixed, whether the
+// measurement was accepted and the ticks spent in computing the gain and in
+// correcting the estimate.
+//
+
+// No telemetry (default), compiles to nothing:
+
+struct no_telemetry
+{
+    template< typename T, int M >
+    struct recorder
+    {
+        static constexpr bool enabled = false;
+
+        static constexpr unsigned long ticks() { return 0; }
+
+        constexpr void on_predict( unsigned long ) {}
+
+        template< typename... Args >
+        constexpr void on_correct( Args const &... ) {}
+    };
+};
+
+// Clock that does not count, phase durations are not recorded:
+
+struct no_clock
+{
+    static constexpr unsigned long now() { return 0; }
+};
+
+//
+// Telemetry of the last N time-steps in a fixed-size ring buffer; the
+// phase durations are in ticks of Clock::now(), e.g. a cycle counter or
+// timer register of the target:
+//
+template< int N, typename Clock = no_clock >
+struct ring_telemetry
+{
+    static_assert( N >= 1, "ring_telemetry: requires at least one entry" );
+
+    template< typename T, int M >
+    class recorder
+    {
+    public:
+        static constexpr bool enabled = true;
+
+        // Record of a time-step:
+
+        struct entry
+        {
+            colvec<T,M> innovation;     // Measurement minus predicted measurement
+            T nis;                      // Normalized innovation squared
+            bool gain_fixed;            // Kalman gain fixed after the step
+            bool accepted;              // Measurement passed the gate
+            unsigned long predict;      // Ticks of predict()
+            unsigned long gain;         // Ticks of computing gain and covariance
+            unsigned long correct;      // Ticks of correcting the estimate
+        };
+
+        unsigned long ticks() const
+        {
+            return Clock::now();
+        }
+
+        void on_predict( unsigned long predict )
+        {
+            predict_ticks = predict;
+        }
+
+        void on_correct( colvec<T,M> const & innovation, T nis, bool gain_fixed, bool accepted, unsigned long gain, unsigned long correct )
+        {
+            ring[ steps++ % N ] = entry{ innovation, nis, gain_fixed, accepted, predict_ticks, gain, correct };
+            predict_ticks = 0;
+        }
+
+        // Observers:
+
+        static constexpr int capacity()
+        {
+            return N;
+        }
+
+        // Number of time-steps recorded, and of those, retained:
+
+        long recorded() const
+        {
+            return steps;
+        }
+
+        int size() const
+        {
+            return steps < N ? static_cast<int>( steps ) : N;
+        }
+
+        // Retained time-step i, 0 the oldest, size() - 1 the latest:
+
+        entry const & operator[]( int i ) const
+        {
+            return ring[ ( steps - size() + i ) % N ];
+        }
+
+        entry const & latest() const
+        {
+            return (*this)[ size() - 1 ];
+        }
+
+        void clear()
+        {
+            steps = 0;
+        }
+
+    private:
+        entry ring[N] = {};             // Time-steps recorded
+        long steps = 0;                 // Number of time-steps recorded
+        unsigned long predict_ticks = 0; // Ticks of the pending predict()
+    };
+};
+
+} // namespace num
+
+#endif // NUM_KALMAN_TELEMETRY_HPP_INCLUDED
@@ -0,0 +1,574 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef NUM_KALMAN_TRACKER_HPP_INCLUDED
+#define NUM_KALMAN_TRACKER_HPP_INCLUDED
+
+// Desktop: multi-target tracker for many objects seen by one sensor.
+
+#include "dsp/kalman.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace num {
+
+// Optimal assignment of rows to columns of the n x n cost matrix, stored
+// row after row, with minimal total cost; Hungarian algorithm with row and
+// column potentials, O(n^3). Returns the column of each row:
+
+template< typename T >
+std::vector<int> hungarian_assignment( std::vector<T> const & cost, int const n )
+{
+    const T inf = std::numeric_limits<T>::max();
+
+    std::vector<T> u( n + 1, T(0) );    // Row potentials
+    std::vector<T> v( n + 1, T(0) );    // Column potentials
+    std::vector<T> minv( n + 1 );       // Smallest reduced cost per column
+    std::vector<int> p( n + 1, 0 );     // Row assigned to column, 1-based
+    std::vector<int> way( n + 1, 0 );   // Previous column on augmenting path
+    std::vector<char> used( n + 1 );
+
+    for ( int i = 1; i <= n; ++i )
+    {
+        p[0] = i;
+        int j0 = 0;
+
+        std::fill( minv.begin(), minv.end(), inf );
+        std::fill( used.begin(), used.end(), char(0) );
+
+        do
+        {
+            used[j0] = 1;
+
+            const int i0 = p[j0];
+            T delta = inf;
+            int j1 = 0;
+
+            for ( int j = 1; j <= n; ++j )
+            {
+                if ( !used[j] )
+                {
+                    const T cur = cost[ ( i0 - 1 ) * n + ( j - 1 ) ] - u[i0] - v[j];
+
+                    if ( cur < minv[j] )
+                    {
+                        minv[j] = cur;
+                        way[j] = j0;
+                    }
+                    if ( minv[j] < delta )
+                    {
+                        delta = minv[j];
+                        j1 = j;
+                    }
+                }
+            }
+
+            for ( int j = 0; j <= n; ++j )
+            {
+                if ( used[j] )
+                {
+                    u[ p[j] ] += delta;
+                    v[j] -= delta;
+                }
+                else
+                {
+                    minv[j] -= delta;
+                }
+            }
+            j0 = j1;
+        }
+        while ( p[j0] != 0 );
+
+        do
+        {
+            const int j1 = way[j0];
+            p[j0] = p[j1];
+            j0 = j1;
+        }
+        while ( j0 != 0 );
+    }
+
+    std::vector<int> result( n );
+
+    for ( int j = 1; j <= n; ++j )
+    {
+        result[ p[j] - 1 ] = j - 1;
+    }
+    return result;
+}
+
+//
+// Multi-target tracker: a num::kalman per track, with the same model for
+// all tracks, fed with unlabeled detections per scan.
+//
+// Per scan, update() predicts all tracks, gates the detections with the
+// normalized innovation squared of each track, assigns detections to tracks
+// by global nearest neighbour and corrects the assigned tracks. Unassigned
+// detections start tentative tracks; a track is confirmed after a number of
+// hits and deleted after a number of consecutive misses, a tentative track
+// after its first miss.
+//
+// Gating looks up the detections in a grid over the first two measurement
+// components, so that a track only visits the cells its gate overlaps and
+// gating is linear in the number of tracks for a bounded density of
+// detections. The cell size is best about the width of a typical gate.
+//
+// The assignment maximizes the number of gated track-detection pairs, then
+// minimizes the sum of their normalized innovation squared. The Hungarian
+// solver runs per cluster of tracks and detections connected by the gates,
+// O(n^3) in the size of the cluster rather than in the number of tracks.
+//
+// New tracks start at transposed(H) z with the initial error covariance,
+// i.e. at the measured components with the others zero, for an H that
+// selects state components.
+//
+template
+<
+    typename T      // Numeric type
+    , int S         // System dimension
+    , int M         // Number of measurements
+    , int U         // Number of control inputs
+    , typename Structure = dense_structure  // Sparsity patterns of A, B, H
+>
+class kalman_tracker
+{
+    static_assert( !is_mixed_precision_v<T>, "kalman_tracker: requires a single numeric type" );
+
+    static constexpr int G = M < 2 ? M : 2; // Dimension of the grid
+
+public:
+    using kalman_t = num::kalman<T,S,M,U,Structure>;
+
+    using real_t = T;                       // Numeric type for computations
+    using A_t    = typename kalman_t::A_t;  // System dynamics matrix: state-k-1 => state-k
+    using B_t    = typename kalman_t::B_t;  // Control input matrix: control => state
+    using H_t    = typename kalman_t::H_t;  // Measurement output matrix: state => measurement estimation
+    using Q_t    = typename kalman_t::Q_t;  // Process noise covariance
+    using R_t    = typename kalman_t::R_t;  // Measurement noise covariance
+    using P_t    = typename kalman_t::P_t;  // Estimate error covariance
+    using u_t    = typename kalman_t::u_t;  // Control inputs
+    using z_t    = typename kalman_t::z_t;  // Measurements inputs
+    using xhat_t = typename kalman_t::xhat_t; // System state estimate
+
+    struct track_t
+    {
+        long id;            // Track identifier, unique per tracker
+        kalman_t estim;     // Estimator of the track
+        int hits;           // Number of assigned detections
+        int misses;         // Number of consecutive scans without detection
+    };
+
+    // Constructor, model of all tracks, gating and track maintenance:
+
+    kalman_tracker(
+        real_t const dt_        // Time step
+        , A_t const & A_        // System dynamics matrix: state-k-1 => state-k
+        , B_t const & B_        // Control input matrix: control => state
+        , H_t const & H_        // Measurement output matrix: state => measurement estimation
+        , Q_t const & Q_        // Process noise covariance
+        , R_t const & R_        // Measurement noise covariance
+        , P_t const & P_        // Initial estimate error covariance of new tracks
+        , real_t const gate_    // Largest normalized innovation squared of an assignment, e.g. chi_square_quantile( M, 0.99 )
+        , real_t const cell_    // Size of the grid cells in measurement space
+        , int const confirm_ = 3 // Number of hits to confirm a track
+        , int const coast_   = 5 // Number of consecutive misses to delete a confirmed track
+    )
+        : dt( dt_)
+        , A( A_)
+        , B( B_)
+        , H( H_)
+        , Q( Q_)
+        , R( R_)
+        , P( P_)
+        , gate( gate_)
+        , cell( cell_)
+        , confirm( confirm_)
+        , coast( coast_)
+    {
+        assert( gate > real_t(0) && cell > real_t(0) && confirm > 0 && coast > 0 );
+    }
+
+    // Process the detections of a scan:
+
+    void update( u_t const & u, std::vector<z_t> const & detections )
+    {
+        // 1. Predict all tracks:
+
+        for ( auto & trk : tracks_ )
+        {
+            trk.estim.predict( u );
+        }
+
+        // 2. Gate the detections, per track via the grid:
+
+        index_detections( detections );
+
+        candidates.clear();
+
+        for ( int i = 0; i < track_count(); ++i )
+        {
+            gate_track( i, detections );
+        }
+
+        // 3. Assign detections to tracks, per cluster:
+
+        assign( static_cast<int>( detections.size() ) );
+
+        // 4. Correct the assigned tracks, maintain and start tracks:
+
+        for ( int i = 0; i < track_count(); ++i )
+        {
+            auto & trk = tracks_[i];
+
+            if ( detection_of[i] >= 0 )
+            {
+                trk.estim.correct( detections[ detection_of[i] ] );
+                ++trk.hits;
+                trk.misses = 0;
+            }
+            else
+            {
+                ++trk.misses;
+            }
+        }
+
+        // kalman is not assignable, copy the surviving tracks:
+
+        survivors.clear();
+
+        for ( auto const & trk : tracks_ )
+        {
+            if ( trk.misses < ( is_confirmed( trk ) ? coast : 1 ) )
+            {
+                survivors.push_back( trk );
+            }
+        }
+
+        tracks_.swap( survivors );
+
+        for ( std::size_t j = 0; j < detections.size(); ++j )
+        {
+            if ( !assigned[j] )
+            {
+                start_track( detections[j] );
+            }
+        }
+    }
+
+    // Observers:
+
+    std::vector<track_t> const & tracks() const
+    {
+        return tracks_;
+    }
+
+    int track_count() const
+    {
+        return static_cast<int>( tracks_.size() );
+    }
+
+    bool is_confirmed( track_t const & trk ) const
+    {
+        return trk.hits >= confirm;
+    }
+
+    int confirmed_count() const
+    {
+        return static_cast<int>( std::count_if( tracks_.begin(), tracks_.end(), [this]( track_t const & trk ) { return is_confirmed( trk ); } ) );
+    }
+
+    // Number of gated track-detection pairs of the last scan:
+
+    int gated_count() const
+    {
+        return static_cast<int>( candidates.size() );
+    }
+
+private:
+    struct candidate
+    {
+        int track;          // Index of track
+        int detection;      // Index of detection
+        real_t cost;        // Normalized innovation squared
+        int cluster;        // Root of the tracks and detections connected by gates
+    };
+
+    using key_t = std::int64_t;
+
+    // Cell of a measurement component:
+
+    int cell_of( real_t const v ) const
+    {
+        return static_cast<int>( std::floor( v / cell ) );
+    }
+
+    // Grid key, ordered by the first component, then the second:
+
+    static key_t key( int const c0, int const c1 )
+    {
+        return ( key_t( c0 ) << 32 ) + ( key_t( c1 ) + ( key_t(1) << 31 ) );
+    }
+
+    // Sort the detections by cell:
+
+    void index_detections( std::vector<z_t> const & detections )
+    {
+        cells.clear();
+
+        for ( std::size_t j = 0; j < detections.size(); ++j )
+        {
+            auto const & z = detections[j];
+
+            cells.emplace_back( key( cell_of( z(0) ), G > 1 ? cell_of( z(G - 1) ) : 0 ), static_cast<int>( j ) );
+        }
+
+        std::sort( cells.begin(), cells.end() );
+
+        lo0 = cells.empty() ? 0 : static_cast<int>( cells.front().first >> 32 );
+        hi0 = cells.empty() ? 0 : static_cast<int>( cells.back().first >> 32 );
+    }
+
+    // Gate the detections in the cells that the gate of track i overlaps, the
+    // ellipse transposed(y) inverted(S) y <= gate with half-width sqrt(gate S(d,d)):
+
+    void gate_track( int const i, std::vector<z_t> const & detections )
+    {
+        if ( cells.empty() )
+        {
+            return;
+        }
+
+        auto const & estim = tracks_[i].estim;
+
+        const auto Sy = estim.innovation_covariance();
+        const auto L  = cholesky( Sy );
+        const auto x  = estim.system_state();
+
+        real_t Hx[M];
+
+        for ( int m = 0; m < M; ++m )
+        {
+            Hx[m] = real_t(0);
+            for ( int k = 0; k < S; ++k )
+            {
+                Hx[m] += H(m,k) * x(k);
+            }
+        }
+
+        int lo[2] = { 0, 0 };
+        int hi[2] = { 0, 0 };
+
+        for ( int d = 0; d < G; ++d )
+        {
+            const auto half = std::sqrt( gate * Sy(d,d) );
+
+            lo[d] = cell_of( Hx[d] - half );
+            hi[d] = cell_of( Hx[d] + half );
+        }
+
+        // Skip the columns of the grid without detections:
+
+        lo[0] = std::max( lo[0], lo0 );
+        hi[0] = std::min( hi[0], hi0 );
+
+        for ( int c0 = lo[0]; c0 <= hi[0]; ++c0 )
+        {
+            auto first = std::lower_bound( cells.begin(), cells.end(), std::make_pair( key( c0, lo[1] ), 0 ) );
+            auto last  = std::lower_bound( first, cells.end(), std::make_pair( key( c0, hi[1] + 1 ), 0 ) );
+
+            for ( ; first != last; ++first )
+            {
+                const int j = first->second;
+
+                // Squared Mahalanobis distance by forward substitution with L:
+
+                real_t w[M];
+                real_t d2(0);
+
+                for ( int m = 0; m < M; ++m )
+                {
+                    real_t v = detections[j](m) - Hx[m];
+
+                    for ( int k = 0; k < m; ++k )
+                    {
+                        v -= L(m,k) * w[k];
+                    }
+                    w[m] = L(m,m) == real_t(0) ? real_t(0) : v / L(m,m);
+                    d2 += w[m] * w[m];
+                }
+
+                if ( d2 <= gate )
+                {
+                    candidates.push_back( { i, j, d2, 0 } );
+                }
+            }
+        }
+    }
+
+    // Cluster the candidates by the tracks and detections they connect and
+    // assign per cluster:
+
+    void assign( int const nd )
+    {
+        const int nt = track_count();
+
+        detection_of.assign( nt, -1 );
+        assigned.assign( nd, char(0) );
+
+        // Union-find, tracks [0,nt), detections [nt,nt+nd):
+
+        parent.resize( nt + nd );
+
+        for ( int k = 0; k < nt + nd; ++k )
+        {
+            parent[k] = k;
+        }
+
+        for ( auto const & c : candidates )
+        {
+            parent[ root( c.track ) ] = root( nt + c.detection );
+        }
+
+        for ( auto & c : candidates )
+        {
+            c.cluster = root( c.track );
+        }
+
+        std::sort( candidates.begin(), candidates.end(), []( candidate const & a, candidate const & b )
+        {
+            return a.cluster < b.cluster;
+        });
+
+        for ( auto first = candidates.begin(); first != candidates.end(); )
+        {
+            auto last = std::find_if( first, candidates.end(), [&]( candidate const & c ) { return c.cluster != first->cluster; } );
+
+            assign_cluster( first, last );
+
+            first = last;
+        }
+    }
+
+    // Assign a cluster by the Hungarian solver; pairs outside the gate cost
+    // more than any set of gated pairs:
+
+    template< typename Iter >
+    void assign_cluster( Iter first, Iter last )
+    {
+        if ( last - first == 1 )
+        {
+            detection_of[ first->track ] = first->detection;
+            assigned[ first->detection ] = 1;
+            return;
+        }
+
+        rows.clear();
+        cols.clear();
+
+        for ( auto it = first; it != last; ++it )
+        {
+            rows.push_back( it->track );
+            cols.push_back( it->detection );
+        }
+
+        std::sort( rows.begin(), rows.end() ); rows.erase( std::unique( rows.begin(), rows.end() ), rows.end() );
+        std::sort( cols.begin(), cols.end() ); cols.erase( std::unique( cols.begin(), cols.end() ), cols.end() );
+
+        const int n = static_cast<int>( std::max( rows.size(), cols.size() ) );
+
+        const real_t forbidden = gate * real_t( n + 1 );
+
+        cost.assign( std::size_t( n ) * n, forbidden );
+
+        for ( auto it = first; it != last; ++it )
+        {
+            const auto r = std::lower_bound( rows.begin(), rows.end(), it->track ) - rows.begin();
+            const auto c = std::lower_bound( cols.begin(), cols.end(), it->detection ) - cols.begin();
+
+            cost[ r * n + c ] = it->cost;
+        }
+
+        const auto col_of = hungarian_assignment( cost, n );
+
+        for ( std::size_t r = 0; r < rows.size(); ++r )
+        {
+            const auto c = col_of[r];
+
+            if ( c < static_cast<int>( cols.size() ) && cost[ r * n + c ] < forbidden )
+            {
+                detection_of[ rows[r] ] = cols[c];
+                assigned[ cols[c] ] = 1;
+            }
+        }
+    }
+
+    int root( int k )
+    {
+        while ( parent[k] != k )
+        {
+            parent[k] = parent[ parent[k] ];
+            k = parent[k];
+        }
+        return k;
+    }
+
+    void start_track( z_t const & z )
+    {
+        xhat_t xhat( 0 );
+
+        for ( int k = 0; k < S; ++k )
+        {
+            for ( int m = 0; m < M; ++m )
+            {
+                xhat(k) += H(m,k) * z(m);
+            }
+        }
+
+        tracks_.push_back( { next_id++, kalman_t( dt, A, B, H, Q, R, P, xhat ), 1, 0 } );
+    }
+
+private:
+    real_t dt;          // Time-step
+    A_t A;              // System dynamics matrix
+    B_t B;              // Control input matrix
+    H_t H;              // Measurement output matrix
+    Q_t Q;              // Process noise covariance
+    R_t R;              // Measurement noise covariance
+    P_t P;              // Initial estimate error covariance of new tracks
+
+    real_t gate;        // Largest normalized innovation squared of an assignment
+    real_t cell;        // Size of the grid cells
+    int confirm;        // Number of hits to confirm a track
+    int coast;          // Number of consecutive misses to delete a confirmed track
+
+    std::vector<track_t> tracks_;
+    long next_id = 0;
+
+    // Scratch of update(), kept to reuse its storage:
+
+    std::vector<track_t> survivors;             // Tracks that are not deleted
+    std::vector<std::pair<key_t, int>> cells;   // Grid key and index of detections, by key
+    int lo0 = 0;                                // Range of first grid component of detections
+    int hi0 = 0;
+    std::vector<candidate> candidates;          // Gated track-detection pairs
+    std::vector<int> parent;                    // Union-find of tracks and detections
+    std::vector<int> detection_of;              // Assigned detection per track, or -1
+    std::vector<char> assigned;                 // Detection assigned to a track
+    std::vector<int> rows;                      // Tracks of a cluster
+    std::vector<int> cols;                      // Detections of a cluster
+    std::vector<real_t> cost;                   // Cost matrix of a cluster
+};
+
+} // namespace num
+
+#endif // NUM_KALMAN_TRACKER_HPP_INCLUDED
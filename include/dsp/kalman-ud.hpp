@@ -0,0 +1,406 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef NUM_KALMAN_UD_HPP_INCLUDED
+#define NUM_KALMAN_UD_HPP_INCLUDED
+
+#include "dsp/kalman.hpp"
+
+namespace num {
+
+//
+// Kalman estimator with UD-factored error covariance, P = U * D * transposed(U),
+// U unit upper triangular and D diagonal.
+//
+// The time update is Thornton's modified weighted Gram-Schmidt orthogonalization,
+// the measurement update is Bierman's, processing the measurements one at a
+// time. Neither needs a square root or a matrix inversion and D cannot become
+// negative, which keeps the estimator stable with float and with 16-bit
+// fixed_point, where num::kalman's P - K * H * P loses positive definiteness.
+// It buys that stability with fewer updates per second than num::kalman,
+// see time/kalman-ud-time.cpp.
+//
+// The measurement noise covariance R must be diagonal; off-diagonal elements
+// are ignored. Column m of the Kalman gain is the gain of the m-th scalar
+// measurement update, which equals num::kalman's gain for M = 1.
+//
+template
+<
+    typename T      // Numeric type
+    , int S         // System dimension
+    , int M         // Number of measurements
+    , int U         // Number of control inputs
+>
+class kalman_ud
+{
+public:
+    using kalman_t = num::kalman<T,S,M,U>;
+
+    using real_t = T;                       // Numeric type for computations
+    using A_t    = typename kalman_t::A_t;  // System dynamics matrix: state-k-1 => state-k
+    using B_t    = typename kalman_t::B_t;  // Control input matrix: control => state
+    using H_t    = typename kalman_t::H_t;  // Measurement output matrix: state => measurement estimation
+    using Q_t    = typename kalman_t::Q_t;  // Process noise covariance
+    using R_t    = typename kalman_t::R_t;  // Measurement noise covariance (diagonal)
+    using P_t    = typename kalman_t::P_t;  // Estimate error covariance
+    using K_t    = typename kalman_t::K_t;  // Kalman gain
+    using u_t    = typename kalman_t::u_t;  // Control inputs
+    using z_t    = typename kalman_t::z_t;  // Measurements inputs
+    using xhat_t = typename kalman_t::xhat_t; // System state estimate
+
+    using U_t    = num::matrix<T,S,S>;      // Unit upper triangular factor
+    using D_t    = num::colvec<T,S>;        // Diagonal factor
+
+    // Constructor
+
+    kalman_ud(
+        real_t const dt_        // Time step
+        , A_t const & A_        // System dynamics matrix: state-k-1 => state-k
+        , B_t const & B_        // Control input matrix: control => state
+        , H_t const & H_        // Measurement output matrix: state => measurement estimation
+        , Q_t const & Q_        // Process noise covariance
+        , R_t const & R_        // Measurement noise covariance (diagonal)
+        , P_t const & P_        // Initial estimate error covariance
+        , xhat_t const & xhat_  // Initial system state estimate
+    )
+        : A( A_)
+        , B( B_)
+        , H( H_)
+        , R( R_)
+        , K( 0 )
+        , xhat( xhat_)
+        , t(  0  )
+        , dt( dt_)
+        , compute_kalman_gain( KE_UPDATE_KALMAN_GAIN != 0 )
+    {
+        factor( Q_, Uq, Dq );
+        factor( P_, Up, Dp );
+    }
+
+    // Update estimator for dt, predict and correct:
+
+    bool update( u_t const & u, z_t const & z )
+    {
+        predict( u );
+        return correct( z );
+    }
+
+    // --------------------------------------
+    // 1. Predict (time update) for dt, see num::kalman<>::predict():
+
+    void predict( u_t const & u )
+    {
+        // Update the time:
+        t += dt;
+
+        // 1a: Project the state ahead:
+        xhat = A * xhat + B * u;
+
+        // 1b: Project the error covariance ahead:
+        if ( compute_kalman_gain )
+        {
+            thornton();
+        }
+    }
+
+    // --------------------------------------
+    // 2. Correct (measurement update), one measurement at a time; there is no
+    // gating, so the measurement is always accepted (true):
+
+    bool correct( z_t const & z )
+    {
+        for ( int m = 0; m < M; ++m )
+        {
+            // 2a, 2c: Compute the Kalman gain and update the error covariance:
+            if ( compute_kalman_gain )
+            {
+                bierman( m );
+            }
+
+            // 2b: Update estimate with measurement:
+            real_t hx = 0;
+
+            for ( int k = 0; k < S; ++k )
+            {
+                hx += H(m,k) * xhat(k);
+            }
+
+            const real_t innovation = z(m) - hx;
+
+            for ( int k = 0; k < S; ++k )
+            {
+                xhat(k) += K(k,m) * innovation;
+            }
+        }
+        return true;
+    }
+
+    // Kalman gain mode:
+
+    // Fix the Kalman gain (and error covariance) at the current value:
+
+    void fix_gain()
+    {
+        compute_kalman_gain = false;
+    }
+
+    // Resume updating the Kalman gain:
+
+    void update_gain()
+    {
+        compute_kalman_gain = true;
+    }
+
+    bool is_gain_fixed() const
+    {
+        return !compute_kalman_gain;
+    }
+
+    // Observers:
+
+    xhat_t system_state() const
+    {
+        return xhat;
+    }
+
+    K_t kalman_gain() const
+    {
+        return K;
+    }
+
+    // U * D * transposed(U):
+
+    P_t estimation_error_covariance() const
+    {
+        P_t result(0);
+
+        for ( int r = 0; r < S; ++r )
+        {
+            for ( int c = r; c < S; ++c )
+            {
+                real_t p = 0;
+
+                for ( int k = c; k < S; ++k )
+                {
+                    p += Up(r,k) * Dp(k) * Up(c,k);
+                }
+                result(r,c) = result(c,r) = p;
+            }
+        }
+        return result;
+    }
+
+    U_t covariance_factor_u() const
+    {
+        return Up;
+    }
+
+    D_t covariance_factor_d() const
+    {
+        return Dp;
+    }
+
+    real_t time() const
+    {
+        return t;
+    }
+
+    // Estimator state, e.g. to re-process from an earlier time-step:
+
+    struct snapshot_t
+    {
+        xhat_t xhat;    // System state estimate
+        U_t Up;         // Estimate error covariance, U factor
+        D_t Dp;         // Estimate error covariance, D factor
+        K_t K;          // Kalman gain
+        real_t t;       // Elapsed time
+        bool compute_kalman_gain;   // Update Kalman gain?
+    };
+
+    snapshot_t snapshot() const
+    {
+        return { xhat, Up, Dp, K, t, compute_kalman_gain };
+    }
+
+    void restore( snapshot_t const & s )
+    {
+        xhat = s.xhat;
+        Up   = s.Up;
+        Dp   = s.Dp;
+        K    = s.K;
+        t    = s.t;
+        compute_kalman_gain = s.compute_kalman_gain;
+    }
+
+private:
+    // Factor symmetric P into U * D * transposed(U), from the last column up;
+    // a zero pivot leaves the column of U above it zero:
+
+    static void factor( P_t const & P, U_t & Uf, D_t & Df )
+    {
+        Uf = U_t(0);
+        Df = D_t(0);
+
+        for ( int j = S - 1; j >= 0; --j )
+        {
+            real_t d = P(j,j);
+
+            for ( int k = j + 1; k < S; ++k )
+            {
+                d -= Uf(j,k) * Uf(j,k) * Df(k);
+            }
+
+            Df(j)   = d;
+            Uf(j,j) = 1;
+
+            for ( int i = 0; i < j; ++i )
+            {
+                real_t p = P(i,j);
+
+                for ( int k = j + 1; k < S; ++k )
+                {
+                    p -= Uf(i,k) * Df(k) * Uf(j,k);
+                }
+                Uf(i,j) = d == 0 ? real_t(0) : p / d;
+            }
+        }
+    }
+
+    // Thornton time update: orthogonalize the rows of W = [A * U | Uq] with
+    // respect to the weights diag(D, Dq), from the last row up:
+
+    void thornton()
+    {
+        const auto AU = A * Up;
+
+        real_t W [S][2 * S];
+        real_t Dw[2 * S];
+
+        for ( int r = 0; r < S; ++r )
+        {
+            for ( int k = 0; k < S; ++k )
+            {
+                W[r][k]     = AU(r,k);
+                W[r][S + k] = Uq(r,k);
+            }
+        }
+
+        for ( int k = 0; k < S; ++k )
+        {
+            Dw[k]     = Dp(k);
+            Dw[S + k] = Dq(k);
+        }
+
+        for ( int j = S - 1; j >= 0; --j )
+        {
+            real_t d = 0;
+
+            for ( int k = 0; k < 2 * S; ++k )
+            {
+                d += W[j][k] * W[j][k] * Dw[k];
+            }
+
+            Dp(j)   = d;
+            Up(j,j) = 1;
+
+            for ( int i = 0; i < j; ++i )
+            {
+                real_t p = 0;
+
+                for ( int k = 0; k < 2 * S; ++k )
+                {
+                    p += W[i][k] * Dw[k] * W[j][k];
+                }
+
+                const real_t u = d == 0 ? real_t(0) : p / d;
+
+                for ( int k = 0; k < 2 * S; ++k )
+                {
+                    W[i][k] -= u * W[j][k];
+                }
+                Up(i,j) = u;
+            }
+        }
+    }
+
+    // Bierman measurement update for scalar measurement m, with
+    // f = transposed(U) * transposed(h) and v = D * f:
+
+    void bierman( int const m )
+    {
+        real_t f[S];
+        real_t v[S];
+        real_t b[S];
+
+        for ( int j = 0; j < S; ++j )
+        {
+            f[j] = H(m,j);
+
+            for ( int i = 0; i < j; ++i )
+            {
+                f[j] += Up(i,j) * H(m,i);
+            }
+            v[j] = Dp(j) * f[j];
+        }
+
+        // With zero measurement noise, alpha may be zero; as inverted() of
+        // num::kalman, a zero alpha yields a zero gain rather than a division:
+
+        real_t alpha = R(m,m);
+
+        for ( int j = 0; j < S; ++j )
+        {
+            const real_t alpha_prev = alpha;
+
+            alpha += f[j] * v[j];
+
+            Dp(j) = alpha == 0 ? Dp(j) : Dp(j) * ( alpha_prev / alpha );
+            b[j]  = v[j];
+
+            if ( j > 0 )
+            {
+                const real_t lambda = alpha_prev == 0 ? real_t(0) : -f[j] / alpha_prev;
+
+                for ( int i = 0; i < j; ++i )
+                {
+                    const real_t u = Up(i,j);
+
+                    Up(i,j) = u + b[i] * lambda;
+                    b[i]   += u * v[j];
+                }
+            }
+        }
+
+        for ( int k = 0; k < S; ++k )
+        {
+            K(k,m) = alpha == 0 ? real_t(0) : b[k] / alpha;
+        }
+    }
+
+private:
+    A_t const A;    // System dynamics matrix:
+    B_t const B;    // Control input matrix
+    H_t const H;    // Measurement output matrix
+    R_t const R;    // Measurement noise covariance (diagonal)
+
+    U_t Uq;         // Process noise covariance, U factor
+    D_t Dq;         // Process noise covariance, D factor
+
+    K_t K;          // Kalman gain
+    U_t Up;         // Estimate error covariance, U factor
+    D_t Dp;         // Estimate error covariance, D factor
+    xhat_t xhat;    // System state estimate
+
+    real_t t;       // Elapsed time
+    real_t dt;      // Time-step
+
+    bool compute_kalman_gain;   // Update Kalman gain?
+};
+
+} // namespace num
+
+#endif // NUM_KALMAN_UD_HPP_INCLUDED
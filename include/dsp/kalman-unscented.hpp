@@ -0,0 +1,304 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef NUM_KALMAN_UNSCENTED_HPP_INCLUDED
+#define NUM_KALMAN_UNSCENTED_HPP_INCLUDED
+
+#include "dsp/kalman.hpp"
+
+namespace num {
+
+//
+// Unscented Kalman estimator for nonlinear process and measurement models.
+//
+// The 2S+1 sigma points are the columns of an S x (2S+1) matrix, spread by
+// the Cholesky factor of the error covariance (scaled unscented transform,
+// parameters alpha, beta and kappa). The models are function objects that
+// map all sigma points in a single call, so that they can evaluate the
+// columns in parallel or vectorized:
+//
+//   matrix<T,S,2S+1> Process::operator()( matrix<T,S,2S+1> const & X, colvec<T,U> const & u ) const;
+//   matrix<T,M,2S+1> Measure::operator()( matrix<T,S,2S+1> const & X ) const;
+//
+// See num::pointwise to apply a model of a single point to each column.
+//
+template
+<
+    typename T          // Numeric type
+    , int S             // System dimension
+    , int M             // Number of measurements
+    , int U             // Number of control inputs
+    , typename Process  // Process model: sigma points-k-1, control => sigma points-k
+    , typename Measure  // Measurement model: sigma points => measurement estimations
+>
+class kalman_unscented
+{
+public:
+    using kalman_t = num::kalman<T,S,M,U>;
+
+    constexpr static int Np = 2 * S + 1;    // Number of sigma points
+
+    using real_t = T;                       // Numeric type for computations
+    using Q_t    = typename kalman_t::Q_t;  // Process noise covariance
+    using R_t    = typename kalman_t::R_t;  // Measurement noise covariance
+    using P_t    = typename kalman_t::P_t;  // Estimate error covariance
+    using K_t    = typename kalman_t::K_t;  // Kalman gain
+    using u_t    = typename kalman_t::u_t;  // Control inputs
+    using z_t    = typename kalman_t::z_t;  // Measurements inputs
+    using xhat_t = typename kalman_t::xhat_t; // System state estimate
+    using Psym_t = typename kalman_t::Psym_t; // Covariance, packed symmetric storage
+
+    using X_t    = num::matrix<T,S,Np>;     // Sigma points in state space
+    using Z_t    = num::matrix<T,M,Np>;     // Sigma points in measurement space
+    using W_t    = num::rowvec<T,Np>;       // Sigma point weights
+
+    // Constructor
+
+    kalman_unscented(
+        real_t const dt_        // Time step
+        , Process const & f_    // Process model
+        , Measure const & h_    // Measurement model
+        , Q_t const & Q_        // Process noise covariance
+        , R_t const & R_        // Measurement noise covariance
+        , P_t const & P_        // Initial estimate error covariance
+        , xhat_t const & xhat_  // Initial system state estimate
+        , real_t const alpha = 1 // Spread of sigma points
+        , real_t const beta  = 2 // Prior knowledge of distribution, 2 for Gaussian
+        , real_t const kappa = 0 // Secondary scaling
+    )
+        : f( f_)
+        , h( h_)
+        , Q( Q_)
+        , R( R_)
+        , Wm( 0 )
+        , Wc( 0 )
+        , K( 0 )
+        , P( P_)
+        , xhat( xhat_)
+        , t(  0  )
+        , dt( dt_)
+    {
+        const real_t n = S;
+        const real_t c = alpha * alpha * ( n + kappa );   // n + lambda
+
+        gamma = square_root( c );
+
+        Wm(0) = ( c - n ) / c;
+        Wc(0) = Wm(0) + ( real_t(1) - alpha * alpha + beta );
+
+        for ( int i = 1; i < Np; ++i )
+        {
+            Wm(i) = Wc(i) = real_t(1) / ( real_t(2) * c );
+        }
+    }
+
+    // Update estimator for dt, predict and correct:
+
+    void update( u_t const & u, z_t const & z )
+    {
+        predict( u );
+        correct( z );
+    }
+
+    // --------------------------------------
+    // 1. Predict (time update) for dt:
+
+    void predict( u_t const & u )
+    {
+        // Update the time:
+        t += dt;
+
+        // 1a: Propagate the sigma points and take their weighted mean:
+        const X_t Y = f( sigma_points(), u );
+
+        xhat = mean( Y );
+
+        // 1b: Their weighted covariance plus the process noise:
+        P = covariance( Y, xhat ) + Q;
+    }
+
+    // --------------------------------------
+    // 2. Correct (measurement update):
+
+    void correct( z_t const & z )
+    {
+        const X_t X = sigma_points();
+        const Z_t Z = h( X );
+
+        const z_t zhat = mean( Z );
+
+        // 2a: Compute the Kalman gain from the cross and the innovation covariance:
+        const K_t Pxz = cross_covariance( X, xhat, Z, zhat );
+        K = Pxz * inverted( to_matrix( covariance( Z, zhat ) + R ) );
+
+        // 2c: Update the error covariance, P - K * Pzz * transposed(K):
+        P = rank_downdate( P, K, Pxz );
+
+        // 2b: Update estimate with measurement:
+        xhat = xhat + K * (z - zhat);
+    }
+
+    // Observers:
+
+    xhat_t system_state() const
+    {
+        return xhat;
+    }
+
+    K_t kalman_gain() const
+    {
+        return K;
+    }
+
+    P_t estimation_error_covariance() const
+    {
+        return to_matrix( P );
+    }
+
+    real_t time() const
+    {
+        return t;
+    }
+
+    // Sigma points of the current estimate, xhat, xhat + gamma * L(:,i),
+    // xhat - gamma * L(:,i), with P = L * transposed(L):
+
+    X_t sigma_points() const
+    {
+        const auto L = cholesky( P );
+
+        X_t X(0);
+
+        for ( int r = 0; r < S; ++r )
+        {
+            X(r,0) = xhat(r);
+
+            for ( int i = 0; i < S; ++i )
+            {
+                X(r,1 + i    ) = xhat(r) + gamma * L(r,i);
+                X(r,1 + S + i) = xhat(r) - gamma * L(r,i);
+            }
+        }
+        return X;
+    }
+
+private:
+    // Weighted mean of the sigma points:
+
+    template< int D >
+    colvec<T,D> mean( matrix<T,D,Np> const & X ) const
+    {
+        colvec<T,D> result(0);
+
+        for ( int r = 0; r < D; ++r )
+        {
+            for ( int i = 0; i < Np; ++i )
+            {
+                result(r) += Wm(i) * X(r,i);
+            }
+        }
+        return result;
+    }
+
+    // Weighted covariance of the sigma points around their mean, in packed
+    // storage:
+
+    template< int D >
+    symmatrix<T,D> covariance( matrix<T,D,Np> const & X, colvec<T,D> const & mu ) const
+    {
+        symmatrix<T,D> result(0);
+
+        for ( int i = 0; i < Np; ++i )
+        {
+            auto pos = result.begin();
+
+            for ( int r = 0; r < D; ++r )
+            {
+                const T dr = Wc(i) * ( X(r,i) - mu(r) );
+
+                for ( int c = r; c < D; ++c, ++pos )
+                {
+                    *pos += dr * ( X(c,i) - mu(c) );
+                }
+            }
+        }
+        return result;
+    }
+
+    // Weighted cross covariance of state and measurement sigma points:
+
+    K_t cross_covariance( X_t const & X, xhat_t const & x, Z_t const & Z, z_t const & z ) const
+    {
+        K_t result(0);
+
+        for ( int i = 0; i < Np; ++i )
+        {
+            for ( int r = 0; r < S; ++r )
+            {
+                const T dr = Wc(i) * ( X(r,i) - x(r) );
+
+                for ( int c = 0; c < M; ++c )
+                {
+                    result(r,c) += dr * ( Z(c,i) - z(c) );
+                }
+            }
+        }
+        return result;
+    }
+
+private:
+    Process const f;    // Process model
+    Measure const h;    // Measurement model
+    Psym_t Q;           // Process noise covariance
+    symmatrix<T,M> R;   // Measurement noise covariance
+
+    W_t Wm;             // Weights for the mean
+    W_t Wc;             // Weights for the covariance
+    real_t gamma;       // Spread of sigma points, square root of n + lambda
+
+    K_t K;              // Kalman gain
+    Psym_t P;           // Estimate error covariance
+    xhat_t xhat;        // System state estimate
+
+    real_t t;           // Elapsed time
+    real_t dt;          // Time-step
+};
+
+//
+// Batched model from a model of a single point, applied to each column:
+// F::operator()( colvec<T,S> const & x, Args const &... ) returns colvec<T,R>.
+//
+template< typename F >
+struct pointwise
+{
+    F f;
+
+    template< typename T, int S, int N, typename... Args >
+    auto operator()( matrix<T,S,N> const & X, Args const &... args ) const
+    {
+        using y_t = decltype( f( column( X, 0 ), args... ) );
+
+        constexpr int R = y_t(0).rows();
+
+        matrix<T,R,N> Y(0);
+
+        for ( int i = 0; i < N; ++i )
+        {
+            const y_t y = f( column( X, i ), args... );
+
+            for ( int r = 0; r < R; ++r )
+            {
+                Y(r,i) = y(r);
+            }
+        }
+        return Y;
+    }
+};
+
+} // namespace num
+
+#endif // NUM_KALMAN_UNSCENTED_HPP_INCLUDED
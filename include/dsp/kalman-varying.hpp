@@ -0,0 +1,216 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef NUM_KALMAN_VARYING_HPP_INCLUDED
+#define NUM_KALMAN_VARYING_HPP_INCLUDED
+
+#include "dsp/kalman.hpp"
+
+namespace num {
+
+//
+// Cache of the discretized system dynamics for the last N distinct time-steps.
+//
+// The time-step is quantized to a multiple of quantum and the matrices are
+// generated for the quantized time-step, so that a repeated interval, also
+// one that jitters within half a quantum, reuses them. When full, the least
+// recently used entry is replaced. The generators are members of Discretize:
+//
+//   A_t Discretize::A( real_t dt ) const;   // System dynamics matrix
+//   B_t Discretize::B( real_t dt ) const;   // Control input matrix
+//   Q_t Discretize::Q( real_t dt ) const;   // Process noise covariance
+//
+template
+<
+    typename Kalman         // Estimator, e.g. num::kalman<T,S,M,U>
+    , typename Discretize   // Generators of A(dt), B(dt) and Q(dt)
+    , int N = 4             // Number of time-steps cached
+>
+class discretization_cache
+{
+    static_assert( N >= 1, "discretization_cache: requires at least one entry" );
+
+public:
+    using real_t = typename Kalman::real_t;
+    using A_t    = typename Kalman::A_t;
+    using B_t    = typename Kalman::B_t;
+    using Psym_t = typename Kalman::Psym_t;
+
+    // Discretized system dynamics for a quantized time-step:
+
+    struct entry
+    {
+        long key;       // Time-step, in quanta
+        real_t dt;      // Quantized time-step
+        A_t A;          // System dynamics matrix
+        B_t B;          // Control input matrix
+        Psym_t Q;       // Process noise covariance
+        long used;      // Lookup of last use
+    };
+
+    discretization_cache( Discretize const & d, real_t const quantum_ )
+        : discretize( d )
+        , quantum( quantum_ )
+    {}
+
+    // Number of time-steps cached:
+
+    static constexpr int capacity()
+    {
+        return N;
+    }
+
+    // Discretized system dynamics for time-step dt, generated on a miss:
+
+    entry const & operator()( real_t const dt )
+    {
+        const long key = quantize( dt );
+
+        ++lookups;
+
+        for ( int i = 0; i < count; ++i )
+        {
+            if ( entries[i].key == key )
+            {
+                entries[i].used = lookups;
+                return entries[i];
+            }
+        }
+
+        entry & e = count < N ? entries[ count++ ] : least_recently_used();
+
+        const real_t dtq = real_t( key ) * quantum;
+
+        e = entry{ key, dtq, discretize.A( dtq ), discretize.B( dtq ), Psym_t( discretize.Q( dtq ) ), lookups };
+
+        ++generated;
+
+        return e;
+    }
+
+    // Number of lookups, and of those, the number that generated the matrices:
+
+    long hits() const
+    {
+        return lookups - generated;
+    }
+
+    long misses() const
+    {
+        return generated;
+    }
+
+    // Time-step dt in quanta, rounded to nearest:
+
+    long quantize( real_t const dt ) const
+    {
+        const real_t q = dt / quantum;
+
+        return q < 0 ? -static_cast<long>( real_t(0.5) - q ) : static_cast<long>( q + real_t(0.5) );
+    }
+
+private:
+    entry & least_recently_used()
+    {
+        entry * oldest = &entries[0];
+
+        for ( int i = 1; i < N; ++i )
+        {
+            if ( entries[i].used < oldest->used )
+            {
+                oldest = &entries[i];
+            }
+        }
+        return *oldest;
+    }
+
+private:
+    Discretize const discretize;    // Generators of A(dt), B(dt), Q(dt)
+    real_t const quantum;           // Resolution of the time-step
+
+    entry entries[N] = {};          // Cached time-steps
+    int count = 0;                  // Number of entries in use
+    long lookups = 0;               // Number of lookups
+    long generated = 0;             // Number of lookups that generated an entry
+};
+
+//
+// Kalman estimator for a time-step that varies from update to update, e.g.
+// with jittering sample timestamps. update( dt, u, z ) predicts with the
+// system dynamics for dt, taken from a discretization_cache, and corrects.
+// update( u, z ) keeps using the nominal time-step of construction.
+//
+template
+<
+    typename Kalman         // Estimator, e.g. num::kalman<T,S,M,U>
+    , typename Discretize   // Generators of A(dt), B(dt) and Q(dt), see discretization_cache
+    , int N = 4             // Number of time-steps cached
+>
+class kalman_varying : public Kalman
+{
+public:
+    using typename Kalman::real_t;
+    using typename Kalman::H_t;
+    using typename Kalman::R_t;
+    using typename Kalman::P_t;
+    using typename Kalman::u_t;
+    using typename Kalman::z_t;
+    using typename Kalman::xhat_t;
+
+    using cache_t = discretization_cache<Kalman, Discretize, N>;
+
+    // Constructor, with the system dynamics for nominal time-step dt_:
+
+    kalman_varying(
+        Discretize const & d    // Generators of A(dt), B(dt), Q(dt)
+        , real_t const quantum  // Resolution of the time-step, e.g. 1 us
+        , real_t const dt_      // Nominal time step
+        , H_t const & H_        // Measurement output matrix: state => measurement estimation
+        , R_t const & R_        // Measurement noise covariance
+        , P_t const & P_        // Initial estimate error covariance
+        , xhat_t const & xhat_  // Initial system state estimate
+    )
+        : Kalman( dt_, d.A( dt_ ), d.B( dt_ ), H_, d.Q( dt_ ), R_, P_, xhat_ )
+        , cache( d, quantum )
+    {}
+
+    using Kalman::update;
+    using Kalman::predict;
+
+    // Update estimator for time-step dt, predict and correct; false if the
+    // measurement is rejected by the gate:
+
+    bool update( real_t const dt, u_t const & u, z_t const & z )
+    {
+        predict( dt, u );
+        return this->correct( z );
+    }
+
+    // Predict for time-step dt, with the cached system dynamics for dt;
+    // the time advances by dt itself, not by the quantized time-step:
+
+    void predict( real_t const dt, u_t const & u )
+    {
+        auto const & e = cache( dt );
+
+        Kalman::predict( dt, e.A, e.B, e.Q, u );
+    }
+
+    // Discretization cache, e.g. for its hit count:
+
+    cache_t const & discretization() const
+    {
+        return cache;
+    }
+
+private:
+    cache_t cache;  // Discretized system dynamics of recent time-steps
+};
+
+} // namespace num
+
+#endif // NUM_KALMAN_VARYING_HPP_INCLUDED
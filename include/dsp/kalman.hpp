@@ -8,7 +8,13 @@
 #ifndef NUM_KALMAN_HPP_INCLUDED
 #define NUM_KALMAN_HPP_INCLUDED
 
+#include "dsp/kalman-telemetry.hpp"
+#include "num/expression.hpp"
 #include "num/matrix.hpp"
+#include "num/precision.hpp"
+#include "num/riccati.hpp"
+#include "num/structure.hpp"
+#include "num/symmatrix.hpp"
 
 #define kalman_MAJOR  0
 #define kalman_MINOR  0
@@ -18,37 +24,118 @@
 #define kalman_STRINGIFY(  x )  kalman_STRINGIFY_( x )
 #define kalman_STRINGIFY_( x )  #x
 
+// Configuration:
+
+// Start with an updating (1) or a fixed (0) Kalman gain:
+
+#ifndef  KE_UPDATE_KALMAN_GAIN
+# define KE_UPDATE_KALMAN_GAIN  1
+#endif
+
+// Compile in (1) or leave out (0) the detector that fixes the Kalman gain
+// once its relative change drops below a tolerance, see auto_fix_gain();
+// left out by default on AVR, where its previous gain and counters cost
+// scarce RAM:
+
+#ifndef  KE_AUTO_FIX_KALMAN_GAIN
+# if defined( __AVR ) && __AVR
+#  define KE_AUTO_FIX_KALMAN_GAIN  0
+# else
+#  define KE_AUTO_FIX_KALMAN_GAIN  1
+# endif
+#endif
+
+// Compile in (1) or leave out (0) gating of measurements on their normalized
+// innovation squared, see gate(); left out by default on AVR, where its inverse
+// innovation covariance, innovation and rejection counter cost scarce RAM:
+
+#ifndef  KE_INNOVATION_GATING
+# if defined( __AVR ) && __AVR
+#  define KE_INNOVATION_GATING  0
+# else
+#  define KE_INNOVATION_GATING  1
+# endif
+#endif
+
+// Start with joint (0) or sequential (1) measurement updates, see
+// correct_sequentially():
+
+#ifndef  KE_SEQUENTIAL_CORRECTION
+# define KE_SEQUENTIAL_CORRECTION  0
+#endif
+
 namespace num {
 
 //
 // Kalman estimator.
 //
+// The optional Structure declares the sparsity patterns of A, B and H, see
+// num::structure, e.g. structure<upper_triangular, dense, diagonal> for a
+// constant velocity model with a position selector; the update then skips
+// the structurally zero terms at compile time. With U = 0 there is no
+// control input and the B * u term is left out.
+//
+// The optional Telemetry policy records the health of the estimator per
+// time-step, e.g. ring_telemetry<64>, see telemetry(); the default
+// no_telemetry compiles to nothing.
+//
+// The estimator is usable in constant expressions, e.g. to compute the
+// trajectory for a fixed input at compile time into a lookup table.
+//
+// The numeric type is a single type T, or mixed_precision<Covariance,State>
+// to keep error covariance and Kalman gain in a wide type and the state
+// estimate, control inputs and measurements in a narrow type, e.g. 32-bit
+// and 16-bit fixed_point; the state is widened for the update and narrowed
+// once per step, with precision_cast().
+//
 template
 <
-    typename T      // Numeric type
+    typename T      // Numeric type, or mixed_precision<Covariance,State>
     , int S         // System dimension
     , int M         // Number of measurements
     , int U         // Number of control inputs
+    , typename Structure = dense_structure  // Sparsity patterns of A, B, H
+    , typename Telemetry = no_telemetry     // Telemetry policy
 >
-class kalman
+class kalman : private Telemetry::template recorder<typename precision_traits<T>::covariance_type, M>
 {
+    using telemetry_t = typename Telemetry::template recorder<typename precision_traits<T>::covariance_type, M>;
+
+    static_assert( is_wider_v< typename precision_traits<T>::covariance_type, typename precision_traits<T>::state_type >,
+                "kalman: requires a covariance type at least as wide as the state type" );
+
+    static_assert( !telemetry_t::enabled || KE_INNOVATION_GATING, "kalman: telemetry requires KE_INNOVATION_GATING" );
+
 public:
-    using real_t = T;                   // Numeric type for computations
-    using A_t    = num::matrix<T,S,S>;  // System dynamics matrix: state-k-1 => state-k
-    using B_t    = num::matrix<T,S,U>;  // Control input matrix: control => state
-    using H_t    = num::matrix<T,M,S>;  // Measurement output matrix: state => measurement estimation
-    using Q_t    = num::matrix<T,S,S>;  // Process noise covariance
-    using R_t    = num::matrix<T,M,M>;  // Measurement noise covariance
-    using P_t    = num::matrix<T,S,S>;  // Estimate error covariance
-    using K_t    = num::matrix<T,S,M>;  // Kalman gain
-    using x_t    = num::colvec<T,S>;    // Initial system state estimate
-    using u_t    = num::colvec<T,U>;    // Control inputs
-    using z_t    = num::colvec<T,M>;    // Measurements inputs
-    using xhat_t = num::colvec<T,S>;    // System state estimate
+    using real_t  = typename precision_traits<T>::covariance_type;  // Numeric type for computations
+    using state_t = typename precision_traits<T>::state_type;       // Numeric type of state, inputs
+
+    using A_t    = num::matrix<real_t,S,S>;     // System dynamics matrix: state-k-1 => state-k
+    using B_t    = num::matrix<real_t,S,U>;     // Control input matrix: control => state
+    using H_t    = num::matrix<real_t,M,S>;     // Measurement output matrix: state => measurement estimation
+    using Q_t    = num::matrix<real_t,S,S>;     // Process noise covariance
+    using R_t    = num::matrix<real_t,M,M>;     // Measurement noise covariance
+    using P_t    = num::matrix<real_t,S,S>;     // Estimate error covariance
+    using K_t    = num::matrix<real_t,S,M>;     // Kalman gain
+    using x_t    = num::colvec<state_t,S>;      // Initial system state estimate
+    using u_t    = num::colvec<state_t,U>;      // Control inputs
+    using z_t    = num::colvec<state_t,M>;      // Measurements inputs
+    using xhat_t = num::colvec<state_t,S>;      // System state estimate
+    using y_t    = num::colvec<real_t,M>;       // Innovation
+
+    using Psym_t = num::symmatrix<real_t,S>;    // Covariance, packed symmetric storage
+
+    using pattern_A = typename Structure::A;    // Sparsity pattern of A
+    using pattern_B = typename Structure::B;    // Sparsity pattern of B
+    using pattern_H = typename Structure::H;    // Sparsity pattern of H
+
+    // Tag to construct estimator in steady state:
+
+    constexpr static struct steady_state_t{} steady_state{};
 
     // Constructor
 
-    kalman(
+    constexpr kalman(
         real_t const dt_        // Time step
         , A_t const & A_        // System dynamics matrix: state-k-1 => state-k
         , B_t const & B_        // Control input matrix: control => state
@@ -63,84 +150,637 @@ public:
         , H( H_)
         , Q( Q_)
         , R( R_)
+        , K( 0 )
         , P( P_)
         , xhat( xhat_)
         , t(  0  )
         , dt( dt_)
+        , compute_kalman_gain( KE_UPDATE_KALMAN_GAIN != 0 )
+        , sequential_correction( KE_SEQUENTIAL_CORRECTION != 0 )
+    {}
+
+    // Constructor, estimator in steady state with fixed Kalman gain,
+    // solving the discrete algebraic Riccati equation at construction:
+
+    constexpr kalman(
+        steady_state_t
+        , real_t const dt_      // Time step
+        , A_t const & A_        // System dynamics matrix: state-k-1 => state-k
+        , B_t const & B_        // Control input matrix: control => state
+        , H_t const & H_        // Measurement output matrix: state => measurement estimation
+        , Q_t const & Q_        // Process noise covariance
+        , R_t const & R_        // Measurement noise covariance
+        , xhat_t const & xhat_  // Initial system state estimate
+    )
+        : kalman( steady_state, dt_, A_, B_, H_, Q_, R_, num::dare( A_, H_, Q_, R_ ), xhat_ )
     {}
 
-    // Update estimator for dt:
+    // Constructor, estimator in steady state with fixed Kalman gain, from
+    // the a priori error covariance that solves the Riccati equation,
+    // e.g. computed at compile time with constexpr num::dare():
 
-    void update( u_t const & u, z_t const & z )
+    constexpr kalman(
+        steady_state_t
+        , real_t const dt_      // Time step
+        , A_t const & A_        // System dynamics matrix: state-k-1 => state-k
+        , B_t const & B_        // Control input matrix: control => state
+        , H_t const & H_        // Measurement output matrix: state => measurement estimation
+        , Q_t const & Q_        // Process noise covariance
+        , R_t const & R_        // Measurement noise covariance
+        , P_t const & Pdare     // Steady-state a priori estimate error covariance
+        , xhat_t const & xhat_  // Initial system state estimate
+    )
+        : kalman( dt_, A_, B_, H_, Q_, R_, Pdare, xhat_ )
     {
-        // Update the time:
-        t += dt;
+        // 2a: Compute the Kalman gain:
+        const auto PHt = P * transposed(H);
+        const auto Sinv = inverted(H * PHt + R);
+        K = PHt * Sinv;
+
+#if KE_INNOVATION_GATING
+        S_inv = Sinv;
+#endif
+        // 2c: Update the error covariance:
+        P = rank_downdate( P, K, PHt );
+
+        fix_gain();
+    }
+
+    // Update estimator for dt, predict and correct; false if the measurement
+    // is rejected by the gate:
+
+    constexpr bool update( u_t const & u, z_t const & z )
+    {
+        predict( u );
+        return correct( z );
+    }
+
+    // --------------------------------------
+    // 1. Predict (time update) for dt; without a following correct(),
+    // the estimator coasts on the model, e.g. when a measurement is missing
+    // or when measurements arrive at a lower rate than control inputs:
+
+    constexpr void predict( u_t const & u )
+    {
+        predict( dt, A, B, Q, u );
+    }
 
-        // --------------------------------------
-        // 1. Predict (time update)
+    // Predict for time-step dt_ with the system dynamics matrix, control
+    // input matrix and process noise covariance for that time-step, e.g. for
+    // sample times that jitter, see num::kalman_varying:
+
+    constexpr void predict( real_t const dt_, A_t const & A_, B_t const & B_, Psym_t const & Q_, u_t const & u )
+    {
+        const auto start = telemetry_t::ticks();
+
+        // Update the time:
+        t += dt_;
 
         // 1a: Project the state ahead:
-        xhat = A * xhat + B * u;
+        if constexpr ( mixed )
+        {
+            auto x = precision_cast<real_t>( xhat );
+            project_state( x, A_, B_, precision_cast<real_t>( u ) );
+            xhat = precision_cast<state_t>( x );
+        }
+        else
+        {
+            project_state( xhat, A_, B_, u );
+        }
 
-        // 1b: Project the error covariance ahead:
-        P = A * P * transposed(A) + Q;
+        if ( compute_kalman_gain )
+        {
+            // 1b: Project the error covariance ahead, A * P * transposed(A) + Q:
+            P = congruence<pattern_A>( A_, P ) + Q_;
+        }
 
-        // --------------------------------------
-        // 2. Correct (measurement update)
+        telemetry_t::on_predict( telemetry_t::ticks() - start );
+    }
 
-        // 2a: Compute the Kalman gain:
-        K = P * transposed(H) * inverted(H * P * transposed(H) + R);
+    // --------------------------------------
+    // 2. Correct (measurement update); false if the measurement is rejected
+    // by the gate, leaving the predicted estimate and error covariance:
 
-        // 2b: Update estimate with measurement:
-        xhat = xhat + K * (z - H * xhat);
+    constexpr bool correct( z_t const & z )
+    {
+        const auto start = telemetry_t::ticks();
 
-        // 2c: Update the error covariance:
-        P = (I() - K * H) * P;
+        bool accepted = true;
+
+        if ( compute_kalman_gain )
+        {
+            if ( sequential_correction )
+            {
+                sequential_gain();
+                observe( z );
+            }
+            else
+            {
+                // 2a: Compute the Kalman gain:
+                const auto PHt = gain_numerator();
+                const auto Sinv = inverted(product<pattern_H>( H, PHt ) + R);
+
+#if KE_INNOVATION_GATING
+                S_inv = Sinv;
+#endif
+                accepted = observe( z );
+
+                if ( accepted )
+                {
+                    K = PHt * Sinv;
+
+                    // 2c: Update the error covariance, (I - K * H) * P:
+                    P = rank_downdate( P, K, PHt );
+                }
+            }
+
+#if KE_AUTO_FIX_KALMAN_GAIN
+            if ( accepted )
+            {
+                detect_steady_gain();
+            }
+#endif
+        }
+        else
+        {
+            accepted = observe( z );
+        }
+
+        const auto gained = telemetry_t::ticks();
+
+        if ( accepted )
+        {
+            update_estimate( z );
+        }
+
+#if KE_INNOVATION_GATING
+        telemetry_t::on_correct( y, nis, !compute_kalman_gain, accepted, gained - start, telemetry_t::ticks() - gained );
+#else
+        (void) start;
+        (void) gained;
+#endif
+        return accepted;
+    }
+
+    // Kalman gain mode:
+
+    // Fix the Kalman gain (and error covariance) at the current value:
+
+    constexpr void fix_gain()
+    {
+        compute_kalman_gain = false;
+    }
+
+    // Resume updating the Kalman gain (and re-arm automatic fixing):
+
+    constexpr void update_gain()
+    {
+        compute_kalman_gain = true;
+#if KE_AUTO_FIX_KALMAN_GAIN
+        settled = 0;
+#endif
+    }
+
+    constexpr bool is_gain_fixed() const
+    {
+        return !compute_kalman_gain;
+    }
+
+#if KE_AUTO_FIX_KALMAN_GAIN
+    // Fix the Kalman gain automatically once the relative change of all its
+    // elements stays within tolerance for the given number of consecutive
+    // updates; a tolerance of zero disables automatic fixing (default):
+
+    constexpr void auto_fix_gain( real_t tolerance, int steps = 1 )
+    {
+        gain_tolerance = tolerance;
+        gain_steps     = steps;
+        settled        = 0;
+    }
+#endif
+
+#if KE_INNOVATION_GATING
+    // Reject a measurement whose normalized innovation squared,
+    // transposed(y) * inverted(H * P * transposed(H) + R) * y, exceeds the
+    // threshold, e.g. chi_square_quantile( M, 0.99 ); the inverse is the one
+    // that the Kalman gain uses. A threshold of zero disables gating
+    // (default). Gating applies to joint correction:
+
+    constexpr void gate( real_t threshold )
+    {
+        gate_threshold = threshold;
+    }
+
+    constexpr bool is_gated() const
+    {
+        return gate_threshold > real_t(0) && !sequential_correction;
+    }
+
+    // Normalized innovation squared of the last gated measurement:
+
+    constexpr real_t normalized_innovation_squared() const
+    {
+        return nis;
+    }
+
+    // Number of measurements rejected by the gate:
+
+    constexpr long rejections() const
+    {
+        return rejected;
+    }
+
+    constexpr void reset_rejections()
+    {
+        rejected = 0;
+    }
+#endif
+
+    // Measurement update mode:
+
+    // Process the measurements one at a time, each with a single division
+    // instead of inverting H * P * transposed(H) + R; this requires that
+    // the measurement noise covariance R is diagonal. Column m of the Kalman
+    // gain then is the gain of the m-th measurement. For S = 4 this pays off
+    // from about M = 4 on, see time/kalman-sequential-time.cpp:
+
+    constexpr void correct_sequentially()
+    {
+        sequential_correction = true;
+    }
+
+    // Process all measurements at once (default):
+
+    constexpr void correct_jointly()
+    {
+        sequential_correction = false;
+    }
+
+    constexpr bool is_correction_sequential() const
+    {
+        return sequential_correction;
+    }
+
+    // Modifiers, changing the noise covariance resumes updating the Kalman gain:
+
+    constexpr void set_process_noise_covariance( Q_t const & Q_ )
+    {
+        Q = Q_;
+        update_gain();
+    }
+
+    constexpr void set_measurement_noise_covariance( R_t const & R_ )
+    {
+        R = R_;
+        update_gain();
     }
 
     // Observers:
 
-    xhat_t system_state() const
+    constexpr xhat_t system_state() const
     {
         return xhat;
     }
 
-    K_t kalman_gain() const
+    constexpr K_t kalman_gain() const
     {
         return K;
     }
 
-    P_t estimation_error_covariance() const
+    constexpr P_t estimation_error_covariance() const
     {
-        return P;
+        return to_matrix( P );
     }
 
-    real_t time() const
+    constexpr real_t time() const
     {
         return t;
     }
 
+    // System model, e.g. to convert the steady-state estimator to a filter:
+
+    constexpr A_t system_dynamics_matrix() const
+    {
+        return A;
+    }
+
+    constexpr B_t control_input_matrix() const
+    {
+        return B;
+    }
+
+    constexpr H_t measurement_output_matrix() const
+    {
+        return H;
+    }
+
+    // Telemetry recorded, see the Telemetry policy:
+
+    constexpr telemetry_t const & telemetry() const
+    {
+        return *this;
+    }
+
+    // Innovation of measurement z, the difference with the predicted
+    // measurement H * xhat, and its covariance, H * P * transposed(H) + R;
+    // after predict(), these are the innovation of the next correct():
+
+    constexpr y_t innovation( z_t const & z ) const
+    {
+        y_t result = precision_cast<real_t>( z );
+
+        const y_t Hx = product<pattern_H>( H, precision_cast<real_t>( xhat ) );
+
+        for ( int m = 0; m < M; ++m )
+        {
+            result(m) -= Hx(m);
+        }
+        return result;
+    }
+
+    constexpr symmatrix<real_t,M> innovation_covariance() const
+    {
+        const auto PHt = gain_numerator();
+
+        return symmatrix<real_t,M>( R_t( product<pattern_H>( H, PHt ) + R ) );
+    }
+
+    // Estimator state, e.g. to re-process from an earlier time-step; it
+    // includes the Kalman gain mode and the counters of automatic gain fixing
+    // and gating, but not the telemetry record:
+
+    struct snapshot_t
+    {
+        xhat_t xhat;    // System state estimate
+        Psym_t P;       // Estimate error covariance
+        K_t K;          // Kalman gain
+        real_t t;       // Elapsed time
+        bool compute_kalman_gain;   // Update Kalman gain?
+#if KE_INNOVATION_GATING
+        R_t S_inv;      // Inverse innovation covariance of the Kalman gain
+        long rejected;  // Number of rejected measurements
+#endif
+#if KE_AUTO_FIX_KALMAN_GAIN
+        K_t Kprev;      // Kalman gain of previous update
+        int settled;    // Number of consecutive steady updates
+#endif
+    };
+
+    constexpr snapshot_t snapshot() const
+    {
+        return { xhat, P, K, t, compute_kalman_gain
+#if KE_INNOVATION_GATING
+            , S_inv, rejected
+#endif
+#if KE_AUTO_FIX_KALMAN_GAIN
+            , Kprev, settled
+#endif
+        };
+    }
+
+    constexpr void restore( snapshot_t const & s )
+    {
+        xhat = s.xhat;
+        P    = s.P;
+        K    = s.K;
+        t    = s.t;
+        compute_kalman_gain = s.compute_kalman_gain;
+#if KE_INNOVATION_GATING
+        S_inv    = s.S_inv;
+        rejected = s.rejected;
+#endif
+#if KE_AUTO_FIX_KALMAN_GAIN
+        Kprev    = s.Kprev;
+        settled  = s.settled;
+#endif
+    }
+
+    // Replace the telemetry record, e.g. to keep a replay of earlier
+    // time-steps out of it:
+
+    constexpr void restore_telemetry( telemetry_t const & r )
+    {
+        static_cast<telemetry_t &>( *this ) = r;
+    }
+
 private:
-    A_t I() const
+    // Evaluate the state update expressions 1a and 2b lazily, for dense A, B and H:
+
+    static constexpr bool fused = KE_EXPRESSION_TEMPLATES
+        && detail::is_dense<pattern_A> && detail::is_dense<pattern_B> && detail::is_dense<pattern_H>;
+
+    // Separate numeric types of covariance and state:
+
+    static constexpr bool mixed = !std20::is_same_v<real_t, state_t>;
+
+    using xw_t = num::colvec<real_t,S>; // State estimate, wide
+    using uw_t = num::colvec<real_t,U>; // Control inputs, wide
+
+    // 1a: Project state x ahead:
+
+    constexpr void project_state( xw_t & x, A_t const & A_, B_t const & B_, uw_t const & u ) const
+    {
+        if constexpr ( U > 0 && fused )
+        {
+            x = evaluate( lazy(A_) * x + lazy(B_) * u );
+        }
+        else if constexpr ( U > 0 )
+        {
+            x = product<pattern_A>( A_, x ) + product<pattern_B>( B_, u );
+        }
+        else
+        {
+            (void) B_;
+            (void) u;
+            x = product<pattern_A>( A_, x );
+        }
+    }
+
+    // 2b: Update estimate with measurement:
+
+    constexpr void update_estimate( z_t const & z )
+    {
+        if constexpr ( mixed )
+        {
+            auto x = precision_cast<real_t>( xhat );
+            correct_state( x, precision_cast<real_t>( z ) );
+            xhat = precision_cast<state_t>( x );
+        }
+        else
+        {
+            correct_state( xhat, z );
+        }
+    }
+
+    constexpr void correct_state( xw_t & x, y_t const & z ) const
+    {
+#if KE_INNOVATION_GATING
+        if ( is_gated() )
+        {
+            x = x + K * y;
+            return;
+        }
+#endif
+        if ( sequential_correction )
+        {
+            for ( int m = 0; m < M; ++m )
+            {
+                x = x + column(K, m) * (z(m) - row(H, m) * x);
+            }
+        }
+        else if constexpr ( fused )
+        {
+            x = evaluate( lazy(x) + lazy(K) * (z - lazy(H) * x) );
+        }
+        else
+        {
+            x = x + K * (z - product<pattern_H>( H, x ));
+        }
+    }
+
+    // 2a: P * transposed(H):
+
+    constexpr matrix<real_t,S,M> gain_numerator() const
+    {
+        return product_transposed<pattern_H>( P, H );
+    }
+
+    // 2a, 2c: Kalman gain and error covariance, one measurement at a time:
+
+    constexpr void sequential_gain()
+    {
+        for ( int m = 0; m < M; ++m )
+        {
+            const auto h   = row(H, m);
+            const auto Pht = P * transposed(h);
+            const auto k   = Pht * inverted(h * Pht + R(m, m));
+
+            P = rank_downdate( P, k, Pht );
+
+            for ( int r = 0; r < S; ++r )
+            {
+                K(r, m) = k(r);
+            }
+        }
+    }
+
+    // Compute innovation y of measurement z and its normalized square when
+    // gated or recorded, the latter for joint correction; false if beyond gate:
+
+    constexpr bool observe( z_t const & z )
+    {
+#if KE_INNOVATION_GATING
+        if ( !is_gated() && !telemetry_t::enabled )
+        {
+            return true;
+        }
+
+        y = innovation( z );
+        nis = 0;
+
+        for ( int r = 0; r < M && !sequential_correction; ++r )
+        {
+            real_t Sy(0);
+
+            for ( int c = 0; c < M; ++c )
+            {
+                Sy += S_inv(r, c) * y(c);
+            }
+            nis += y(r) * Sy;
+        }
+
+        if ( is_gated() && gate_threshold < nis )
+        {
+            ++rejected;
+            return false;
+        }
+#else
+        (void) z;
+#endif
+        return true;
+    }
+
+#if KE_AUTO_FIX_KALMAN_GAIN
+    static constexpr real_t abs( real_t v )
+    {
+        return v < 0 ? -v : v;
+    }
+
+    // Fix gain after gain_steps updates with |K - Kprev| <= tolerance * |K|:
+
+    constexpr void detect_steady_gain()
     {
-        return num::eye<real_t,S>();
+        if ( gain_tolerance == 0 )
+        {
+            return;
+        }
+
+        bool steady = true;
+
+        for ( int i = 0; i < K.size(); ++i )
+        {
+            steady = steady && abs( K(i) - Kprev(i) ) <= gain_tolerance * abs( K(i) );
+        }
+
+        Kprev = K;
+
+        settled = steady ? settled + 1 : 0;
+
+        if ( settled >= gain_steps )
+        {
+            fix_gain();
+        }
     }
+#endif
 
 private:
     A_t const A;    // System dynamics matrix:
     B_t const B;    // Control input matrix
     H_t const H;    // Measurement output matrix
-    Q_t const Q;    // Process noise covariance
-    R_t const R;    // Measurement noise covariance
+    Psym_t Q;       // Process noise covariance
+    R_t R;          // Measurement noise covariance
 
     K_t K;          // Kalman gain
-    P_t P;          // Estimate error covariance
+    Psym_t P;       // Estimate error covariance
     xhat_t xhat;    // System state estimate
 
     real_t t;       // Elapsed time
     real_t dt;      // Time-step
+
+    bool compute_kalman_gain;   // Update Kalman gain?
+    bool sequential_correction; // Process measurements one at a time?
+
+#if KE_INNOVATION_GATING
+    R_t S_inv = R_t( 0 );       // Inverse innovation covariance of the Kalman gain
+    y_t y = y_t( 0 );           // Innovation of the gated measurement
+    real_t nis = 0;             // Its normalized innovation squared
+    real_t gate_threshold = 0;  // Largest accepted normalized innovation squared
+    long rejected = 0;          // Number of rejected measurements
+#endif
+
+#if KE_AUTO_FIX_KALMAN_GAIN
+    K_t Kprev = K_t( 0 );       // Kalman gain of previous update
+    real_t gain_tolerance = 0;  // Relative change of gain considered steady
+    int gain_steps = 1;         // Number of steady updates before fixing gain
+    int settled = 0;            // Number of consecutive steady updates
+#endif
 };
 
+// Chi-square quantile for 1 to 10 degrees of freedom at probability 0.95,
+// 0.99 or 0.999, e.g. as gate threshold for M measurements; 0 otherwise:
+
+constexpr double chi_square_quantile( int dof, double probability )
+{
+    constexpr double q95 [] = { 3.841,  5.991,  7.815,  9.488, 11.070, 12.592, 14.067, 15.507, 16.919, 18.307 };
+    constexpr double q99 [] = { 6.635,  9.210, 11.345, 13.277, 15.086, 16.812, 18.475, 20.090, 21.666, 23.209 };
+    constexpr double q999[] = { 10.828, 13.816, 16.266, 18.467, 20.515, 22.458, 24.322, 26.124, 27.877, 29.588 };
+
+    return dof < 1 || dof > 10 ? 0
+        : probability == 0.95  ? q95 [ dof - 1 ]
+        : probability == 0.99  ? q99 [ dof - 1 ]
+        : probability == 0.999 ? q999[ dof - 1 ] : 0;
+}
+
 } // namespace num
 
 #endif // NUM_KALMAN_HPP_INCLUDED
@@ -0,0 +1,241 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef NUM_DUAL_HPP_INCLUDED
+#define NUM_DUAL_HPP_INCLUDED
+
+#include "num/matrix.hpp"
+
+namespace num {
+
+//
+// Dual number for forward-mode automatic differentiation: a value and its
+// partial derivatives with respect to N independent variables. A single
+// evaluation of a function of N variables with dual numbers yields its
+// value and its gradient; T may be a floating point or a fixed_point type.
+//
+template< typename T, int N >
+class dual;
+
+template< typename V >
+struct is_dual { static constexpr bool value = false; };
+
+template< typename T, int N >
+struct is_dual< dual<T,N> > { static constexpr bool value = true; };
+
+template< typename T, int N >
+class dual
+{
+    // Enable for values that are not dual numbers:
+
+    template< typename V >
+    using if_value = std20::enable_if_t< !is_dual<V>::value >;
+
+public:
+    // Types:
+
+    using value_type = T;
+
+    // Construction:
+
+    constexpr dual()
+    : val(), der()
+    {}
+
+    // Constant, e.g. dual(0) in num::matrix:
+
+    template< typename V, typename = if_value<V> >
+    constexpr dual( V v )
+    : val( v ), der()
+    {}
+
+    // Independent variable i:
+
+    constexpr dual( T v, int i )
+    : val( v ), der()
+    {
+        der[i] = T(1);
+    }
+
+    // Observers:
+
+    constexpr T value() const
+    {
+        return val;
+    }
+
+    constexpr T derivative( int i ) const
+    {
+        return der[i];
+    }
+
+    // Arithmetic:
+
+    constexpr dual operator+() const
+    {
+        return *this;
+    }
+
+    constexpr dual operator-() const
+    {
+        dual result( -val );
+
+        for ( int i = 0; i < N; ++i )
+        {
+            result.der[i] = -der[i];
+        }
+        return result;
+    }
+
+    constexpr dual & operator+=( dual const & b )
+    {
+        val += b.val;
+
+        for ( int i = 0; i < N; ++i )
+        {
+            der[i] += b.der[i];
+        }
+        return *this;
+    }
+
+    constexpr dual & operator-=( dual const & b )
+    {
+        val -= b.val;
+
+        for ( int i = 0; i < N; ++i )
+        {
+            der[i] -= b.der[i];
+        }
+        return *this;
+    }
+
+    // (a * b)' = a' * b + a * b':
+
+    constexpr dual & operator*=( dual const & b )
+    {
+        for ( int i = 0; i < N; ++i )
+        {
+            der[i] = der[i] * b.val + val * b.der[i];
+        }
+        val *= b.val;
+
+        return *this;
+    }
+
+    // (a / b)' = (a' - (a / b) * b') / b, avoiding b * b:
+
+    constexpr dual & operator/=( dual const & b )
+    {
+        const T q = val / b.val;
+
+        for ( int i = 0; i < N; ++i )
+        {
+            der[i] = ( der[i] - q * b.der[i] ) / b.val;
+        }
+        val = q;
+
+        return *this;
+    }
+
+    friend constexpr dual operator+( dual a, dual const & b ) { return a += b; }
+    friend constexpr dual operator-( dual a, dual const & b ) { return a -= b; }
+    friend constexpr dual operator*( dual a, dual const & b ) { return a *= b; }
+    friend constexpr dual operator/( dual a, dual const & b ) { return a /= b; }
+
+    // Mixed with a constant, exact matches to prevent ambiguity with the
+    // operators of T, such as those of fixed_point:
+
+    template< typename V, typename = if_value<V> > friend constexpr dual operator+( dual a, V b ) { return a += dual( b ); }
+    template< typename V, typename = if_value<V> > friend constexpr dual operator-( dual a, V b ) { return a -= dual( b ); }
+    template< typename V, typename = if_value<V> > friend constexpr dual operator*( dual a, V b ) { return a *= dual( b ); }
+    template< typename V, typename = if_value<V> > friend constexpr dual operator/( dual a, V b ) { return a /= dual( b ); }
+
+    template< typename V, typename = if_value<V> > friend constexpr dual operator+( V a, dual const & b ) { return dual( a ) += b; }
+    template< typename V, typename = if_value<V> > friend constexpr dual operator-( V a, dual const & b ) { return dual( a ) -= b; }
+    template< typename V, typename = if_value<V> > friend constexpr dual operator*( V a, dual const & b ) { return dual( a ) *= b; }
+    template< typename V, typename = if_value<V> > friend constexpr dual operator/( V a, dual const & b ) { return dual( a ) /= b; }
+
+    // Elementary function f of x, given f(x) and f'(x) (chain rule):
+
+    friend constexpr dual chain( dual const & x, T fx, T dfx )
+    {
+        dual result( fx );
+
+        for ( int i = 0; i < N; ++i )
+        {
+            result.der[i] = dfx * x.der[i];
+        }
+        return result;
+    }
+
+private:
+    T val;      // Value
+    T der[N];   // Partial derivatives
+};
+
+// Value of a plain or of a dual number, for use in generic models:
+
+template< typename T >
+constexpr T value( T const & v )
+{
+    return v;
+}
+
+template< typename T, int N >
+constexpr T value( dual<T,N> const & v )
+{
+    return v.value();
+}
+
+// Vector of independent variables x(i), i = 0..N-1:
+
+template< typename T, int N >
+constexpr colvec<dual<T,N>,N> seed( colvec<T,N> const & x )
+{
+    colvec<dual<T,N>,N> result(0);
+
+    for ( int i = 0; i < N; ++i )
+    {
+        result(i) = dual<T,N>( x(i), i );
+    }
+    return result;
+}
+
+// Values of vector y of dual numbers:
+
+template< typename T, int N, int M >
+constexpr colvec<T,M> values( colvec<dual<T,N>,M> const & y )
+{
+    colvec<T,M> result(0);
+
+    for ( int r = 0; r < M; ++r )
+    {
+        result(r) = y(r).value();
+    }
+    return result;
+}
+
+// Jacobian of vector y of dual numbers, dy(r) / dx(c):
+
+template< typename T, int N, int M >
+constexpr matrix<T,M,N> jacobian( colvec<dual<T,N>,M> const & y )
+{
+    matrix<T,M,N> result(0);
+
+    for ( int r = 0; r < M; ++r )
+    {
+        for ( int c = 0; c < N; ++c )
+        {
+            result(r,c) = y(r).derivative(c);
+        }
+    }
+    return result;
+}
+
+} // namespace num
+
+#endif // NUM_DUAL_HPP_INCLUDED
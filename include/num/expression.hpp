@@ -0,0 +1,312 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef NUM_EXPRESSION_HPP_INCLUDED
+#define NUM_EXPRESSION_HPP_INCLUDED
+
+#include "num/matrix.hpp"
+#include "std/type_traits.hpp"  // std20::enable_if_t
+
+// Configuration:
+
+// Let num::kalman evaluate its state update expressions 1a and 2b lazily
+// (1), or with the eager matrix operators (0). The covariance steps 1b, 2a
+// and 2c work on packed symmetric storage and are not affected. Measured
+// with kalman-expression-time (S=6, M=3, U=3, g++ -O2, x86-64), a full
+// kalman::update() gains from nothing to about 10%, within the noise of
+// the measurement, at the cost of code size; hence off by default:
+
+#ifndef  KE_EXPRESSION_TEMPLATES
+# define KE_EXPRESSION_TEMPLATES  0
+#endif
+
+namespace num {
+
+//
+// Lazy matrix expressions: lazy(A) starts an expression of additions,
+// subtractions, scaling, transposition and products that is evaluated in a
+// single loop nest by evaluate() or assign(), without temporaries or
+// zero-fill passes in between:
+//
+//   xhat = evaluate( lazy(A) * xhat + lazy(B) * u );
+//   assign( PHt, lazy(P) * transposed( lazy(H) ) );
+//
+// An element of a product is computed when accessed, as the ordinary
+// operator* does, summing from zero in order of k; an operand of a product
+// that is not a matrix or its transpose is evaluated once into a temporary.
+// Results therefore equal those of the eager operators.
+//
+// Expressions refer to their matrix operands: evaluate them in the full
+// expression that creates them. Evaluation is constexpr, which in C++17
+// requires its result to start initialized: evaluate() zero-fills it; use
+// assign() into an existing matrix to avoid the fill.
+//
+
+namespace expr {
+
+// Matrix operand:
+
+template< typename T, int N, int M >
+struct leaf
+{
+    using value_type = T;
+    static constexpr int rows = N;
+    static constexpr int columns = M;
+
+    matrix<T,N,M> const & a;
+
+    constexpr T operator()( int row, int col ) const { return a( row, col ); }
+};
+
+// Evaluated operand:
+
+template< typename T, int N, int M >
+struct value
+{
+    using value_type = T;
+    static constexpr int rows = N;
+    static constexpr int columns = M;
+
+    matrix<T,N,M> a;
+
+    constexpr T operator()( int row, int col ) const { return a( row, col ); }
+};
+
+template< typename L, typename R >
+struct sum
+{
+    using value_type = typename L::value_type;
+    static constexpr int rows = L::rows;
+    static constexpr int columns = L::columns;
+
+    L l;
+    R r;
+
+    constexpr value_type operator()( int row, int col ) const { return l( row, col ) + r( row, col ); }
+};
+
+template< typename L, typename R >
+struct difference
+{
+    using value_type = typename L::value_type;
+    static constexpr int rows = L::rows;
+    static constexpr int columns = L::columns;
+
+    L l;
+    R r;
+
+    constexpr value_type operator()( int row, int col ) const { return l( row, col ) - r( row, col ); }
+};
+
+template< typename E >
+struct scaled
+{
+    using value_type = typename E::value_type;
+    static constexpr int rows = E::rows;
+    static constexpr int columns = E::columns;
+
+    value_type s;
+    E e;
+
+    constexpr value_type operator()( int row, int col ) const { return s * e( row, col ); }
+};
+
+template< typename E >
+struct transpose
+{
+    using value_type = typename E::value_type;
+    static constexpr int rows = E::columns;
+    static constexpr int columns = E::rows;
+
+    E e;
+
+    constexpr value_type operator()( int row, int col ) const { return e( col, row ); }
+};
+
+template< typename L, typename R >
+struct product
+{
+    using value_type = typename L::value_type;
+    static constexpr int rows = L::rows;
+    static constexpr int columns = R::columns;
+
+    L l;
+    R r;
+
+    constexpr value_type operator()( int row, int col ) const
+    {
+        value_type result(0);
+
+        for ( int k = 0; k < L::columns; ++k )
+        {
+            result += l( row, k ) * r( k, col );
+        }
+        return result;
+    }
+};
+
+// Traits:
+
+template< typename E > struct is_expression : std20::false_type {};
+
+template< typename T, int N, int M > struct is_expression< leaf<T,N,M>        > : std20::true_type {};
+template< typename T, int N, int M > struct is_expression< value<T,N,M>       > : std20::true_type {};
+template< typename L, typename R   > struct is_expression< sum<L,R>           > : std20::true_type {};
+template< typename L, typename R   > struct is_expression< difference<L,R>    > : std20::true_type {};
+template< typename E               > struct is_expression< scaled<E>          > : std20::true_type {};
+template< typename E               > struct is_expression< transpose<E>       > : std20::true_type {};
+template< typename L, typename R   > struct is_expression< product<L,R>       > : std20::true_type {};
+
+template< typename E > struct is_matrix : std20::false_type {};
+
+template< typename T, int N, int M > struct is_matrix< matrix<T,N,M> > : std20::true_type {};
+
+// Cheap to access an element repeatedly, as operand of a product:
+
+template< typename E > struct is_cheap : std20::false_type {};
+
+template< typename T, int N, int M > struct is_cheap< leaf<T,N,M>  > : std20::true_type {};
+template< typename T, int N, int M > struct is_cheap< value<T,N,M> > : std20::true_type {};
+template< typename E > struct is_cheap< transpose<E> > : is_cheap<E> {};
+template< typename E > struct is_cheap< scaled<E>    > : is_cheap<E> {};
+
+// Operand of an expression: an expression as is, a matrix by reference:
+
+template< typename E >
+constexpr E const & operand( E const & e )
+{
+    return e;
+}
+
+template< typename T, int N, int M >
+constexpr leaf<T,N,M> operand( matrix<T,N,M> const & a )
+{
+    return { a };
+}
+
+template< typename E >
+struct operand_type { using type = E; };
+
+template< typename T, int N, int M >
+struct operand_type< matrix<T,N,M> > { using type = leaf<T,N,M>; };
+
+template< typename E >
+using operand_t = typename operand_type<E>::type;
+
+// Element-wise evaluation into destination:
+
+template< typename T, int N, int M, typename E >
+constexpr void assign_to( matrix<T,N,M> & dest, E const & e )
+{
+    static_assert( E::rows == N && E::columns == M, "expression and destination must have equal dimensions" );
+
+    for ( int row = 0; row < N; ++row )
+    {
+        for ( int col = 0; col < M; ++col )
+        {
+            dest( row, col ) = e( row, col );
+        }
+    }
+}
+
+// Operand of a product: matrices and their transposes as is, other
+// expressions evaluated once, as their elements are accessed repeatedly:
+
+template< typename E >
+constexpr auto factor( E const & e )
+{
+    if constexpr ( is_cheap<E>::value )
+    {
+        return e;
+    }
+    else
+    {
+        value<typename E::value_type, E::rows, E::columns> v{ typename E::value_type(0) };
+        assign_to( v.a, e );
+        return v;
+    }
+}
+
+template< typename A, typename B >
+using if_expression = std20::enable_if_t<
+    ( is_expression<A>::value || is_expression<B>::value ) &&
+    ( is_expression<A>::value || is_matrix<A>::value ) &&
+    ( is_expression<B>::value || is_matrix<B>::value ) >;
+
+template< typename E >
+using if_expression1 = std20::enable_if_t< is_expression<E>::value >;
+
+// Operators, at least one operand an expression:
+
+template< typename A, typename B, typename = if_expression<A,B> >
+constexpr auto operator+( A const & a, B const & b )
+{
+    return sum< operand_t<A>, operand_t<B> >{ operand( a ), operand( b ) };
+}
+
+template< typename A, typename B, typename = if_expression<A,B> >
+constexpr auto operator-( A const & a, B const & b )
+{
+    return difference< operand_t<A>, operand_t<B> >{ operand( a ), operand( b ) };
+}
+
+template< typename A, typename B, typename = if_expression<A,B> >
+constexpr auto operator*( A const & a, B const & b )
+{
+    const auto fa = factor( operand( a ) );
+    const auto fb = factor( operand( b ) );
+
+    static_assert( decltype(fa)::columns == decltype(fb)::rows, "inner dimensions of product must be equal" );
+
+    return product< std20::remove_cv_t<decltype(fa)>, std20::remove_cv_t<decltype(fb)> >{ fa, fb };
+}
+
+template< typename E, typename = if_expression1<E> >
+constexpr auto operator*( identity_t<typename E::value_type> s, E const & e )
+{
+    return scaled<E>{ s, e };
+}
+
+template< typename E, typename = if_expression1<E> >
+constexpr auto transposed( E const & e )
+{
+    return transpose<E>{ e };
+}
+
+} // namespace expr
+
+// Start a lazy expression with matrix A:
+
+template< typename T, int N, int M >
+constexpr expr::leaf<T,N,M> lazy( matrix<T,N,M> const & A )
+{
+    return { A };
+}
+
+// Evaluate expression into a new matrix:
+
+template< typename E, typename = expr::if_expression1<E> >
+constexpr matrix<typename E::value_type, E::rows, E::columns> evaluate( E const & e )
+{
+    matrix<typename E::value_type, E::rows, E::columns> result( 0 );
+
+    expr::assign_to( result, e );
+
+    return result;
+}
+
+// Evaluate expression directly into destination, which it must not refer to:
+
+template< typename T, int N, int M, typename E, typename = expr::if_expression1<E> >
+constexpr void assign( matrix<T,N,M> & dest, E const & e )
+{
+    expr::assign_to( dest, e );
+}
+
+} // namespace num
+
+#endif // NUM_EXPRESSION_HPP_INCLUDED
@@ -17,6 +17,7 @@
 #define matrix_STRINGIFY_( x )  #x
 
 #include "std/algorithm.hpp"    // constexpr std20::copy(), std20::fill()
+#include "std/type_traits.hpp"  // std20::enable_if_t
 #include "std/utility.hpp"      // std20::swap(), std::initializer_list
 
 namespace num {
@@ -168,9 +169,29 @@ public:
     }
 
 private:
-    value_type storage[ N * M ];
+    // An empty matrix, e.g. B for a system without control input, keeps
+    // a single unused element:
+
+    value_type storage[ N * M > 0 ? N * M : 1 ];
 };
 
+// Forward declarations:
+
+template< typename T, int N >
+constexpr matrix<T,N,N> eye();
+
+namespace detail {
+
+// Absolute value:
+
+template< typename T >
+constexpr T abs( T v )
+{
+    return v < 0 ? -v : v;
+}
+
+} // namespace detail
+
 // ----------------------------------------------
 // 1x1 matrix algorithms
 
@@ -377,18 +398,19 @@ constexpr matrix<T,N,M> operator-( matrix<T,N,M> const & a, matrix<T,N,M> const
     return result;
 }
 
-// A * B:
+// A * B, (NxK) * (KxM), except for 1x1 operands and the dot product, see above:
 
-template< typename T, int N, int M >
-constexpr matrix<T,N,M> operator*( matrix<T,N,M> const & A, matrix<T,N,M> const & B )
+template< typename T, int N, int K, int M
+    , typename = std20::enable_if_t< !( K == 1 && ( M == 1 || N == 1 ) ) > >
+constexpr matrix<T,N,M> operator*( matrix<T,N,K> const & A, matrix<T,K,M> const & B )
 {
     matrix<T,N,M> result(0);
 
-    for ( int row = 0; row < A.rows(); ++row )
+    for ( int row = 0; row < N; ++row )
     {
-        for ( int col = 0; col < A.columns(); ++col )
+        for ( int col = 0; col < M; ++col )
         {
-            for ( int k = 0; k < A.columns(); ++k )
+            for ( int k = 0; k < K; ++k )
             {
                 result(row, col) += A(row, k) * B(k, col);
             }
@@ -398,84 +420,26 @@ constexpr matrix<T,N,M> operator*( matrix<T,N,M> const & A, matrix<T,N,M> const
     return result;
 }
 
-// x * A - rowvec:
-
-template< typename T, int N, int M >
-constexpr rowvec<T,N> operator*( rowvec<T,N> const & x, matrix<T,N,M> const & A )
-{
-    rowvec<T,N> result( 0 );
-    for ( int row = 0; row < A.rows(); ++row )
-    {
-        for ( int col = 0; col < A.columns(); ++col )
-        {
-            result(col) += A(row, col) * x(row);
-        }
-    }
-    return result;
-}
+// ----------------------------------------------
+// Transposition algorithms
 
-// A * x - colvec:
+// transposed(A) - NxM:
 
 template< typename T, int N, int M >
-constexpr colvec<T,N> operator*( matrix<T,N,M> const & A, colvec<T,N> const & x )
+constexpr matrix<T,M,N> transposed( matrix<T,N,M> const & A )
 {
-    colvec<T,N> result( 0 );
-    for ( int row = 0; row < A.rows(); ++row )
+    matrix<T,M,N> result(0);
+
+    for ( int row = 0; row < N; ++row )
     {
-        for ( int col = 0; col < A.columns(); ++col )
+        for ( int col = 0; col < M; ++col )
         {
-            result(row) += A(row, col) * x(col);
+            result( col, row ) = A( row, col );
         }
     }
     return result;
 }
 
-// ----------------------------------------------
-// Transposition algorithms
-
-// transposed(x) - rowvec:
-
-template< typename T, int N >
-constexpr rowvec<T,N> transposed( colvec<T,N> const & x )
-{
-    rowvec<T,N>  result(0);
-
-    std20::copy( x.begin(), x.end(), result.begin() );
-
-    return result;
-}
-
-// transposed(x) - colvec:
-
-template< typename T, int N >
-constexpr colvec<T,N> transposed( rowvec<T,N> const & x )
-{
-    colvec<T,N>  result(0);
-
-    std20::copy( x.begin(), x.end(), result.begin() );
-
-    return result;
-}
-
-// transposed(A)
-//template< typename T, int N >
-//matrix<T,N,N> transposed( matrix<T,N,N> const & A )
-//{
-//    static_assert(false, "Implement transposed(Anxn)");
-//}
-
-// transposed(A) - 2x2:
-
-template< typename T >
-constexpr matrix<T,2,2> transposed( matrix<T,2,2> const & A )
-{
-    matrix<T,2,2> result( A );
-
-    using std20::swap; swap( result(0,1), result(1,0) );
-
-    return result;
-}
-
 // ----------------------------------------------
 // Inversion algorithms
 
@@ -497,13 +461,68 @@ constexpr matrix<T,2,2> inverted( matrix<T,2,2> const & A )
     const auto det = 1 / ( A(0) * A(3) - A(1) * A(2) );
 
     result(0) = + det * A(3);
-    result(1) = - det * A(2);
-    result(2) = - det * A(1);
+    result(1) = - det * A(1);
+    result(2) = - det * A(2);
     result(3) = + det * A(0);
 
     return result;
 }
 
+// inverted(A) - NxN, Gauss-Jordan elimination with partial pivoting:
+
+template< typename T, int N >
+constexpr matrix<T,N,N> inverted( matrix<T,N,N> const & A )
+{
+    matrix<T,N,N> a( A );
+    matrix<T,N,N> result = eye<T,N>();
+
+    for ( int col = 0; col < N; ++col )
+    {
+        // select pivot row:
+
+        int pivot = col;
+        for ( int row = col + 1; row < N; ++row )
+        {
+            if ( detail::abs( a(row, col) ) > detail::abs( a(pivot, col) ) )
+            {
+                pivot = row;
+            }
+        }
+
+        for ( int k = 0; k < N; ++k )
+        {
+            using std20::swap;
+            swap( a(col, k), a(pivot, k) );
+            swap( result(col, k), result(pivot, k) );
+        }
+
+        // normalize pivot row and eliminate column from other rows:
+
+        const T d = 1 / a(col, col);
+
+        for ( int k = 0; k < N; ++k )
+        {
+            a(col, k) = a(col, k) * d;
+            result(col, k) = result(col, k) * d;
+        }
+
+        for ( int row = 0; row < N; ++row )
+        {
+            if ( row != col )
+            {
+                const T f = a(row, col);
+
+                for ( int k = 0; k < N; ++k )
+                {
+                    a(row, k) = a(row, k) - f * a(col, k);
+                    result(row, k) = result(row, k) - f * result(col, k);
+                }
+            }
+        }
+    }
+    return result;
+}
+
 // ----------------------------------------------
 // Other
 
@@ -521,6 +540,34 @@ constexpr matrix<T,N,N> eye()
     return result;
 }
 
+// row r of A, NxM:
+
+template< typename T, int N, int M >
+constexpr rowvec<T,M> row( matrix<T,N,M> const & A, int r )
+{
+    rowvec<T,M> result(0);
+
+    for ( int col = 0; col < M; ++col )
+    {
+        result( col ) = A( r, col );
+    }
+    return result;
+}
+
+// column c of A, NxM:
+
+template< typename T, int N, int M >
+constexpr colvec<T,N> column( matrix<T,N,M> const & A, int c )
+{
+    colvec<T,N> result(0);
+
+    for ( int row = 0; row < N; ++row )
+    {
+        result( row ) = A( row, c );
+    }
+    return result;
+}
+
 } // namespace num
 
 #endif // NUM_MATRIX_HPP_INCLUDED
@@ -0,0 +1,166 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef NUM_PRECISION_HPP_INCLUDED
+#define NUM_PRECISION_HPP_INCLUDED
+
+#include "num/fixed-point.hpp"
+#include "num/matrix.hpp"
+
+namespace num {
+
+//
+// Mixed precision numeric type of num::kalman: Covariance for the error
+// covariance, the Kalman gain and the model matrices, State for the state
+// estimate, the control inputs and the measurements, e.g.
+//
+//   mixed_precision< fixed_point<int32_t,15>, fixed_point<int16_t,10> >
+//
+// The covariance type must be at least as wide as the state type, see
+// is_wider_v; values cross between the two with precision_cast().
+//
+template< typename Covariance, typename State >
+struct mixed_precision {};
+
+// Numeric types of the covariance and the state path, a single type T for both:
+
+template< typename T >
+struct precision_traits
+{
+    using covariance_type = T;
+    using state_type      = T;
+};
+
+template< typename Covariance, typename State >
+struct precision_traits< mixed_precision<Covariance, State> >
+{
+    using covariance_type = Covariance;
+    using state_type      = State;
+};
+
+// Mixed precision numeric type?
+
+template< typename T >
+struct is_mixed_precision : std20::false_type {};
+
+template< typename Covariance, typename State >
+struct is_mixed_precision< mixed_precision<Covariance, State> > : std20::true_type {};
+
+template< typename T >
+constexpr bool is_mixed_precision_v = is_mixed_precision<T>::value;
+
+// Fixed point type?
+
+template< typename T >
+struct is_fixed_point : std20::false_type {};
+
+template< typename T, int I, int F >
+struct is_fixed_point< fixed_point<T,I,F> > : std20::true_type {};
+
+template< typename T >
+constexpr bool is_fixed_point_v = is_fixed_point<T>::value;
+
+// Floating point type?
+
+template< typename T > struct is_floating : std20::false_type {};
+
+template<> struct is_floating<float      > : std20::true_type {};
+template<> struct is_floating<double     > : std20::true_type {};
+template<> struct is_floating<long double> : std20::true_type {};
+
+template< typename T >
+constexpr bool is_floating_v = is_floating<T>::value;
+
+namespace detail {
+
+template< bool B, typename T, typename F > struct select { using type = T; };
+template< typename T, typename F > struct select<false, T, F> { using type = F; };
+
+template< bool B, typename T, typename F >
+using select_t = typename select<B,T,F>::type;
+
+template< typename W, typename N, bool = is_fixed_point_v<W>, bool = is_fixed_point_v<N> >
+struct is_wider : std20::integral_constant< bool, sizeof(W) >= sizeof(N) > {};
+
+template< typename W, typename N >
+struct is_wider<W, N, true, true > : std20::integral_constant< bool,
+    W::integer_digits >= N::integer_digits && W::fractional_digits >= N::fractional_digits > {};
+
+template< typename W, typename N >
+struct is_wider<W, N, false, true > : std20::integral_constant< bool, is_floating_v<W> > {};
+
+template< typename W, typename N >
+struct is_wider<W, N, true, false > : std20::false_type {};
+
+} // namespace detail
+
+// Type W represents every value of type N: a floating point type is wider
+// than a fixed point type, a fixed point type wider than another if it has
+// at least as many integer and fractional digits:
+
+template< typename W, typename N >
+constexpr bool is_wider_v = detail::is_wider<W,N>::value;
+
+// Explicit conversion between numeric types, rounding to nearest when
+// dropping fractional digits of a fixed point type; narrowing the integer
+// part wraps, see is_wider_v. Any type converts to itself:
+
+template< typename To, typename From >
+constexpr To precision_cast( From const & v )
+{
+    static_assert( std20::is_same_v<To, From>
+                || ( ( is_fixed_point_v<From> || is_floating_v<From> || std20::is_integral_v<From> )
+                  && ( is_fixed_point_v<To>   || is_floating_v<To>   || std20::is_integral_v<To> ) ),
+                "precision_cast: requires floating point, fixed point or integral types" );
+
+    if constexpr ( std20::is_same_v<To, From> )
+    {
+        return v;
+    }
+    else if constexpr ( is_fixed_point_v<From> && is_fixed_point_v<To> )
+    {
+        using rep = detail::select_t< ( sizeof( typename To::rep ) > sizeof( typename From::rep ) ), typename To::rep, typename From::rep >;
+
+        constexpr int shift = From::fractional_digits - To::fractional_digits;
+
+        rep r = v.underlying_value();
+
+        if constexpr ( shift > 0 )
+        {
+            r = static_cast<rep>( ( r + ( rep(1) << ( shift - 1 ) ) ) >> shift );
+        }
+        else if constexpr ( shift < 0 )
+        {
+            r = static_cast<rep>( r * static_cast<rep>( detail::power2( -shift ) ) );
+        }
+        return To( To::construct, static_cast<typename To::rep>( r ) );
+    }
+    else if constexpr ( is_fixed_point_v<From> )
+    {
+        return v.template as<To>();
+    }
+    else
+    {
+        return static_cast<To>( v );
+    }
+}
+
+template< typename To, typename From, int N, int M >
+constexpr matrix<To,N,M> precision_cast( matrix<From,N,M> const & a )
+{
+    matrix<To,N,M> result( 0 );
+
+    for ( int i = 0; i < a.size(); ++i )
+    {
+        result(i) = precision_cast<To>( a(i) );
+    }
+    return result;
+}
+
+} // namespace num
+
+#endif // NUM_PRECISION_HPP_INCLUDED
@@ -0,0 +1,79 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef NUM_RICCATI_HPP_INCLUDED
+#define NUM_RICCATI_HPP_INCLUDED
+
+#include "num/matrix.hpp"
+
+namespace num {
+
+//
+// Discrete algebraic Riccati equation of the Kalman estimator:
+//
+//   P = A P A' - A P H' (H P H' + R)^-1 H P A' + Q
+//
+// Returns the steady-state a priori estimate error covariance P, solved
+// with the structure-preserving doubling algorithm (quadratic convergence):
+//
+//   A0 = A', G0 = H' R^-1 H, P0 = Q
+//   W  = I + Gk Pk
+//   Ak+1 = Ak W^-1 Ak
+//   Gk+1 = Gk + Ak W^-1 Gk Ak'
+//   Pk+1 = Pk + Ak' Pk W^-1 Ak
+//
+// Iteration stops when no element of P changes by more than tolerance
+// times the largest element of P, or after max_iterations.
+//
+template< typename T, int S, int M >
+constexpr matrix<T,S,S> dare(
+    matrix<T,S,S> const & A     // System dynamics matrix
+    , matrix<T,M,S> const & H   // Measurement output matrix
+    , matrix<T,S,S> const & Q   // Process noise covariance
+    , matrix<T,M,M> const & R   // Measurement noise covariance
+    , identity_t<T> tolerance = T(1e-12)
+    , int max_iterations = 64
+)
+{
+    auto Ak = transposed( A );
+    auto Gk = transposed( H ) * inverted( R ) * H;
+    auto Pk = Q;
+
+    for ( int i = 0; i < max_iterations; ++i )
+    {
+        const auto Wi = inverted( eye<T,S>() + Gk * Pk );
+
+        const auto Pn = Pk + transposed( Ak ) * Pk * Wi * Ak;
+
+        Gk = Gk + Ak * Wi * Gk * transposed( Ak );
+        Ak = Ak * Wi * Ak;
+
+        T change = 0;
+        T largest = 0;
+
+        for ( int k = 0; k < Pn.size(); ++k )
+        {
+            const T d = detail::abs( Pn(k) - Pk(k) );
+            const T p = detail::abs( Pn(k) );
+
+            change  = change  < d ? d : change;
+            largest = largest < p ? p : largest;
+        }
+
+        Pk = Pn;
+
+        if ( change <= tolerance * largest )
+        {
+            break;
+        }
+    }
+    return Pk;
+}
+
+} // namespace num
+
+#endif // NUM_RICCATI_HPP_INCLUDED
@@ -0,0 +1,219 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef NUM_STRUCTURE_HPP_INCLUDED
+#define NUM_STRUCTURE_HPP_INCLUDED
+
+#include "num/symmatrix.hpp"
+#include "std/type_traits.hpp"  // std20::integral_constant, std20::is_same_v
+
+namespace num {
+
+//
+// Compile-time sparsity patterns: nonzero(row,col) is false for elements that
+// are structurally zero. The products below skip those terms at compile time;
+// a dense pattern uses the ordinary loops.
+//
+
+// All elements may be nonzero (default):
+
+struct dense
+{
+    static constexpr bool nonzero( int, int ) { return true; }
+};
+
+// Only (i,i) may be nonzero, e.g. a selector H = { 1, 0 }:
+
+struct diagonal
+{
+    static constexpr bool nonzero( int row, int col ) { return row == col; }
+};
+
+// Elements on and above the diagonal, e.g. constant velocity A = { 1, dt, 0, 1 }:
+
+struct upper_triangular
+{
+    static constexpr bool nonzero( int row, int col ) { return row <= col; }
+};
+
+// Explicit row-major bit mask, bit (row * Columns + col) set for nonzero
+// elements, for matrices of up to 64 elements:
+
+template< unsigned long long Bits, int Columns >
+struct mask
+{
+    static constexpr bool nonzero( int row, int col ) { return ( Bits >> ( row * Columns + col ) ) & 1u; }
+};
+
+// Patterns of the system dynamics, control input and measurement output
+// matrices of a Kalman estimator:
+
+template< typename PatternA = dense, typename PatternB = dense, typename PatternH = dense >
+struct structure
+{
+    using A = PatternA;
+    using B = PatternB;
+    using H = PatternH;
+};
+
+using dense_structure = structure<>;
+
+namespace detail {
+
+// Call f( integral_constant<int,I>() ) for I in [B,E):
+
+template< int B, int E, typename F >
+constexpr void static_for( F && f )
+{
+    if constexpr ( B < E )
+    {
+        f( std20::integral_constant<int,B>() );
+        static_for<B + 1, E>( f );
+    }
+}
+
+// Index of static_for(), also from a captured reference:
+
+template< typename I >
+constexpr int index_v = std20::remove_reference_t<I>::value;
+
+template< typename Pattern >
+constexpr bool is_dense = std20::is_same_v<Pattern, dense>;
+
+// Whether a pattern covers a Rows x Columns matrix; a mask holds 64 bits:
+
+template< typename Pattern, int Rows, int Columns >
+constexpr bool covers = true;
+
+template< unsigned long long Bits, int C, int Rows, int Columns >
+constexpr bool covers< mask<Bits,C>, Rows, Columns > = ( Rows - 1 ) * C + Columns <= 64;
+
+} // namespace detail
+
+// A * B, (NxK) * (KxM), skipping the structural zeros of A:
+
+template< typename Pattern, typename T, int N, int K, int M >
+constexpr auto product( matrix<T,N,K> const & A, matrix<T,K,M> const & B )
+{
+    static_assert( detail::covers<Pattern,N,K>, "product: mask pattern supports matrices of up to 64 elements" );
+
+    if constexpr ( detail::is_dense<Pattern> )
+    {
+        return A * B;
+    }
+    else
+    {
+        matrix<T,N,M> result(0);
+
+        detail::static_for<0,N>( [&]( auto row )
+        {
+            detail::static_for<0,K>( [&]( auto k )
+            {
+                if constexpr ( Pattern::nonzero( detail::index_v<decltype(row)>, detail::index_v<decltype(k)> ) )
+                {
+                    for ( int col = 0; col < M; ++col )
+                    {
+                        result(row, col) += A(row, k) * B(k, col);
+                    }
+                }
+            });
+        });
+
+        // Same type as the ordinary operator*, e.g. T for a dot product:
+
+        using result_t = decltype( A * B );
+
+        if constexpr ( std20::is_same_v<result_t, T> )
+        {
+            return result_t( result(0) );
+        }
+        else
+        {
+            return result_t( result );
+        }
+    }
+}
+
+// X * transposed(B), (NxK) * (KxM), skipping the structural zeros of B (MxK):
+
+template< typename Pattern, typename T, int N, int K, int M >
+constexpr matrix<T,N,M> product_transposed( matrix<T,N,K> const & X, matrix<T,M,K> const & B )
+{
+    static_assert( detail::covers<Pattern,M,K>, "product_transposed: mask pattern supports matrices of up to 64 elements" );
+
+    if constexpr ( detail::is_dense<Pattern> )
+    {
+        return X * transposed( B );
+    }
+    else
+    {
+        matrix<T,N,M> result(0);
+
+        detail::static_for<0,M>( [&]( auto col )
+        {
+            detail::static_for<0,K>( [&]( auto k )
+            {
+                if constexpr ( Pattern::nonzero( detail::index_v<decltype(col)>, detail::index_v<decltype(k)> ) )
+                {
+                    for ( int row = 0; row < N; ++row )
+                    {
+                        result(row, col) += X(row, k) * B(col, k);
+                    }
+                }
+            });
+        });
+
+        return result;
+    }
+}
+
+// P * transposed(B), symmetric P:
+
+template< typename Pattern, typename T, int K, int M >
+constexpr matrix<T,K,M> product_transposed( symmatrix<T,K> const & P, matrix<T,M,K> const & B )
+{
+    return product_transposed<Pattern>( to_matrix( P ), B );
+}
+
+// Congruence A * P * transposed(A), skipping the structural zeros of A:
+
+template< typename Pattern, typename T, int M, int N >
+constexpr symmatrix<T,M> congruence( matrix<T,M,N> const & A, symmatrix<T,N> const & P )
+{
+    static_assert( detail::covers<Pattern,M,N>, "congruence: mask pattern supports matrices of up to 64 elements" );
+
+    if constexpr ( detail::is_dense<Pattern> )
+    {
+        return congruence( A, P );
+    }
+    else
+    {
+        const matrix<T,M,N> AP = product<Pattern>( A, to_matrix( P ) );
+
+        symmatrix<T,M> result(0);
+
+        detail::static_for<0,M>( [&]( auto row )
+        {
+            detail::static_for<detail::index_v<decltype(row)>,M>( [&]( auto col )
+            {
+                detail::static_for<0,N>( [&]( auto k )
+                {
+                    if constexpr ( Pattern::nonzero( detail::index_v<decltype(col)>, detail::index_v<decltype(k)> ) )
+                    {
+                        result(row, col) += AP(row, k) * A(col, k);
+                    }
+                });
+            });
+        });
+
+        return result;
+    }
+}
+
+} // namespace num
+
+#endif // NUM_STRUCTURE_HPP_INCLUDED
@@ -0,0 +1,373 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef NUM_SYMMATRIX_HPP_INCLUDED
+#define NUM_SYMMATRIX_HPP_INCLUDED
+
+#include "num/matrix.hpp"
+
+namespace num {
+
+//
+// Symmetric NxN matrix, packed storage of the upper triangle (row-major),
+// N(N+1)/2 instead of NxN elements.
+//
+template< typename T, int N >
+class symmatrix
+{
+public:
+    // Types:
+
+    using value_type = T;
+    using iterator = value_type *;
+    using const_iterator = value_type const *;
+
+    // Number of stored elements:
+
+    constexpr static int packed_size = N * ( N + 1 ) / 2;
+
+    // Construction:
+
+#if defined( __AVR ) && __AVR
+    constexpr symmatrix() : storage() {}
+#else
+    constexpr symmatrix() = default;
+#endif
+    constexpr symmatrix( symmatrix && ) = default;
+    constexpr symmatrix( symmatrix const & ) = default;
+    constexpr symmatrix & operator=( symmatrix && ) = default;
+    constexpr symmatrix & operator=( symmatrix const & ) = default;
+
+    constexpr symmatrix( value_type v )
+    : storage()
+    {
+        std20::fill( begin(), end(), v );
+    }
+
+    // From the upper triangle of a full matrix:
+
+    constexpr symmatrix( matrix<T,N,N> const & A )
+    : storage()
+    {
+        for ( int row = 0; row < N; ++row )
+        {
+            for ( int col = row; col < N; ++col )
+            {
+                storage[ index( row, col ) ] = A( row, col );
+            }
+        }
+    }
+
+    // Observers:
+
+    constexpr int rows() const
+    {
+        return N;
+    }
+
+    constexpr int columns() const
+    {
+        return N;
+    }
+
+    constexpr int size() const
+    {
+        return packed_size;
+    }
+
+    constexpr value_type operator()( int row, int col ) const
+    {
+        return at( row, col );
+    }
+
+    constexpr value_type at( int row, int col ) const
+    {
+        return storage[ index( row, col ) ];
+    }
+
+    // Modifiers:
+
+    constexpr value_type & operator()( int row, int col )
+    {
+        return at( row, col );
+    }
+
+    constexpr value_type & at( int row, int col )
+    {
+        return storage[ index( row, col ) ];
+    }
+
+    // Iteration over packed elements:
+
+    constexpr iterator begin()
+    {
+        return &storage[ 0 ];
+    }
+
+    constexpr iterator end()
+    {
+        return &storage[ packed_size ];
+    }
+
+    constexpr const_iterator begin() const
+    {
+        return &storage[ 0 ];
+    }
+
+    constexpr const_iterator end() const
+    {
+        return &storage[ packed_size ];
+    }
+
+    // Index of element (row,col) in packed storage:
+
+    static constexpr int index( int row, int col )
+    {
+        return row <= col
+            ? row * N - row * ( row - 1 ) / 2 + ( col - row )
+            : index( col, row );
+    }
+
+private:
+    value_type storage[ packed_size ];
+};
+
+// Full matrix from symmetric matrix:
+
+template< typename T, int N >
+constexpr matrix<T,N,N> to_matrix( symmatrix<T,N> const & P )
+{
+    matrix<T,N,N> result(0);
+    auto pos = P.begin();
+
+    for ( int row = 0; row < N; ++row )
+    {
+        for ( int col = row; col < N; ++col, ++pos )
+        {
+            result( row, col ) = result( col, row ) = *pos;
+        }
+    }
+    return result;
+}
+
+// P + Q:
+
+template< typename T, int N >
+constexpr symmatrix<T,N> operator+( symmatrix<T,N> const & P, symmatrix<T,N> const & Q )
+{
+    symmatrix<T,N> result(0);
+
+    for ( int i = 0; i < P.size(); ++i )
+    {
+        result.begin()[i] = P.begin()[i] + Q.begin()[i];
+    }
+    return result;
+}
+
+// P - Q:
+
+template< typename T, int N >
+constexpr symmatrix<T,N> operator-( symmatrix<T,N> const & P, symmatrix<T,N> const & Q )
+{
+    symmatrix<T,N> result(0);
+
+    for ( int i = 0; i < P.size(); ++i )
+    {
+        result.begin()[i] = P.begin()[i] - Q.begin()[i];
+    }
+    return result;
+}
+
+// P * B, (NxN) * (NxM):
+
+template< typename T, int N, int M >
+constexpr matrix<T,N,M> operator*( symmatrix<T,N> const & P, matrix<T,N,M> const & B )
+{
+    return to_matrix( P ) * B;
+}
+
+// Congruence A * P * transposed(A), (MxN) * (NxN) * (NxM), only the
+// upper triangle of the second product is computed:
+
+template< typename T, int M, int N >
+constexpr symmatrix<T,M> congruence( matrix<T,M,N> const & A, symmatrix<T,N> const & P )
+{
+    const auto AP = A * to_matrix( P );
+
+    symmatrix<T,M> result(0);
+    auto pos = result.begin();
+
+    for ( int row = 0; row < M; ++row )
+    {
+        for ( int col = row; col < M; ++col, ++pos )
+        {
+            for ( int k = 0; k < N; ++k )
+            {
+                *pos += AP( row, k ) * A( col, k );
+            }
+        }
+    }
+    return result;
+}
+
+// Symmetric rank-K update P + X * transposed(Y), with X, Y NxK; the
+// caller guarantees that X * transposed(Y) is symmetric:
+
+template< typename T, int N, int K >
+constexpr symmatrix<T,N> rank_update( symmatrix<T,N> const & P, matrix<T,N,K> const & X, matrix<T,N,K> const & Y )
+{
+    symmatrix<T,N> result( P );
+    auto pos = result.begin();
+
+    for ( int row = 0; row < N; ++row )
+    {
+        for ( int col = row; col < N; ++col, ++pos )
+        {
+            T xy(0);
+
+            for ( int k = 0; k < K; ++k )
+            {
+                xy += X( row, k ) * Y( col, k );
+            }
+            *pos = *pos + xy;
+        }
+    }
+    return result;
+}
+
+// Symmetric rank-K downdate P - X * transposed(Y), as rank_update():
+
+template< typename T, int N, int K >
+constexpr symmatrix<T,N> rank_downdate( symmatrix<T,N> const & P, matrix<T,N,K> const & X, matrix<T,N,K> const & Y )
+{
+    symmatrix<T,N> result( P );
+    auto pos = result.begin();
+
+    for ( int row = 0; row < N; ++row )
+    {
+        for ( int col = row; col < N; ++col, ++pos )
+        {
+            T xy(0);
+
+            for ( int k = 0; k < K; ++k )
+            {
+                xy += X( row, k ) * Y( col, k );
+            }
+            *pos = *pos - xy;
+        }
+    }
+    return result;
+}
+
+// Square root by Newton iteration from above, for floating point and
+// fixed_point types alike; negative values yield 0:
+
+template< typename T >
+constexpr T square_root( T const x )
+{
+    if ( !( T(0) < x ) )
+    {
+        return T(0);
+    }
+
+    T y = T(1) < x ? x : T(1);
+
+    for (;;)
+    {
+        const T next = ( y + x / y ) * T(0.5);
+
+        if ( !( next < y ) )
+        {
+            return y;
+        }
+        y = next;
+    }
+}
+
+// Lower triangular Cholesky factor L of P = L * transposed(L); a pivot
+// that is not positive leaves its column of L zero:
+
+template< typename T, int N >
+constexpr matrix<T,N,N> cholesky( symmatrix<T,N> const & P )
+{
+    matrix<T,N,N> L(0);
+
+    for ( int j = 0; j < N; ++j )
+    {
+        T d = P(j,j);
+
+        for ( int k = 0; k < j; ++k )
+        {
+            d -= L(j,k) * L(j,k);
+        }
+
+        if ( !( T(0) < d ) )
+        {
+            continue;
+        }
+
+        L(j,j) = square_root( d );
+
+        for ( int i = j + 1; i < N; ++i )
+        {
+            T p = P(i,j);
+
+            for ( int k = 0; k < j; ++k )
+            {
+                p -= L(i,k) * L(j,k);
+            }
+            L(i,j) = p / L(j,j);
+        }
+    }
+    return L;
+}
+
+// Squared Mahalanobis distance transposed(y) * inverted(S) * y, by forward
+// substitution with the Cholesky factor of S:
+
+template< typename T, int N >
+constexpr T mahalanobis_squared( symmatrix<T,N> const & S, colvec<T,N> const & y )
+{
+    const auto L = cholesky( S );
+
+    colvec<T,N> w(0);
+    T result(0);
+
+    for ( int i = 0; i < N; ++i )
+    {
+        T v = y(i);
+
+        for ( int k = 0; k < i; ++k )
+        {
+            v -= L(i,k) * w(k);
+        }
+
+        w(i) = L(i,i) == T(0) ? T(0) : v / L(i,i);
+        result += w(i) * w(i);
+    }
+    return result;
+}
+
+// Determinant of S, the squared product of the diagonal of its Cholesky factor:
+
+template< typename T, int N >
+constexpr T determinant( symmatrix<T,N> const & S )
+{
+    const auto L = cholesky( S );
+
+    T result(1);
+
+    for ( int i = 0; i < N; ++i )
+    {
+        result *= L(i,i) * L(i,i);
+    }
+    return result;
+}
+
+} // namespace num
+
+#endif // NUM_SYMMATRIX_HPP_INCLUDED
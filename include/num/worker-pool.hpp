@@ -0,0 +1,173 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef NUM_WORKER_POOL_HPP_INCLUDED
+#define NUM_WORKER_POOL_HPP_INCLUDED
+
+// Desktop only: fixed pool of worker threads for data-parallel loops.
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace num {
+
+//
+// Worker pool: for_each( n, fn ) calls fn( begin, end ) for contiguous
+// ranges that together cover [0,n), one range per thread, the calling
+// thread included, and returns when all ranges are done. With one thread,
+// fn( 0, n ) runs on the calling thread. If fn throws, for_each() still
+// waits for all ranges and then rethrows the first exception caught.
+//
+class worker_pool
+{
+public:
+    // Pool with the given total number of threads, 0 for the hardware
+    // concurrency:
+
+    explicit worker_pool( int threads = 0 )
+        : nthreads( threads > 0 ? threads : hardware_threads() )
+    {
+        for ( int i = 1; i < nthreads; ++i )
+        {
+            workers.emplace_back( [this, i]{ work( i ); } );
+        }
+    }
+
+    ~worker_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            stopping = true;
+        }
+        start.notify_all();
+
+        for ( auto & w : workers )
+        {
+            w.join();
+        }
+    }
+
+    worker_pool( worker_pool const & ) = delete;
+    worker_pool & operator=( worker_pool const & ) = delete;
+
+    int threads() const
+    {
+        return nthreads;
+    }
+
+    template< typename F >
+    void for_each( int const n, F && fn )
+    {
+        if ( nthreads == 1 || n < 2 )
+        {
+            fn( 0, n );
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            task    = [&fn]( int b, int e ){ fn( b, e ); };
+            count   = n;
+            pending = nthreads - 1;
+            ++generation;
+        }
+        start.notify_all();
+
+        run( 0 );
+
+        std::unique_lock<std::mutex> lock( mutex );
+        done.wait( lock, [this]{ return pending == 0; } );
+
+        if ( error )
+        {
+            std::rethrow_exception( std::exchange( error, nullptr ) );
+        }
+    }
+
+private:
+    static int hardware_threads()
+    {
+        const int n = static_cast<int>( std::thread::hardware_concurrency() );
+        return n > 0 ? n : 1;
+    }
+
+    // Range of thread i, keeping the first exception for for_each():
+
+    void run( int const i )
+    {
+        const int b = static_cast<int>( static_cast<long>( count ) *   i       / nthreads );
+        const int e = static_cast<int>( static_cast<long>( count ) * ( i + 1 ) / nthreads );
+
+        if ( b < e )
+        {
+            try
+            {
+                task( b, e );
+            }
+            catch ( ... )
+            {
+                std::lock_guard<std::mutex> lock( mutex );
+
+                if ( !error )
+                {
+                    error = std::current_exception();
+                }
+            }
+        }
+    }
+
+    void work( int const i )
+    {
+        long seen = 0;
+
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock( mutex );
+                start.wait( lock, [&]{ return stopping || generation != seen; } );
+
+                if ( stopping )
+                {
+                    return;
+                }
+                seen = generation;
+            }
+
+            run( i );
+
+            {
+                std::lock_guard<std::mutex> lock( mutex );
+                --pending;
+            }
+            done.notify_one();
+        }
+    }
+
+private:
+    int const nthreads;
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable done;
+
+    std::function<void(int,int)> task;
+    std::exception_ptr error;
+    int  count      = 0;
+    int  pending    = 0;
+    long generation = 0;
+    bool stopping   = false;
+};
+
+} // namespace num
+
+#endif // NUM_WORKER_POOL_HPP_INCLUDED
@@ -21,7 +21,15 @@ namespace std20 {
 
 namespace std20 {
 
-template< typename T > class numeric_limits;
+// As std::numeric_limits, non-arithmetic types are neither signed nor integer:
+
+template< typename T >
+class numeric_limits
+{
+public:
+    static constexpr bool is_signed  = false;
+    static constexpr bool is_integer = false;
+};
 
 template<>
 class numeric_limits<float>
@@ -23,10 +23,14 @@ namespace std20 {
     using std::remove_cv;
     using std::remove_cv_t;
     using std::integral_constant;
+    using std::true_type;
+    using std::false_type;
     using std::is_integral;
     using std::is_integral_v;
     using std::is_signed;
     using std::is_signed_v;
+    using std::is_same;
+    using std::is_same_v;
     using std::enable_if;
     using std::enable_if_t;
 }
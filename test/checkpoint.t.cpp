@@ -0,0 +1,190 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "dsp/checkpoint.hpp"
+#include "kalman-fixture.hpp"
+#include "lest.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#define CASE( name ) lest_CASE( specification(), name )
+
+extern lest::tests & specification();
+
+namespace {
+
+using namespace fixture;
+
+using buffer = std::vector<unsigned char>;
+
+using BiQuad  = dsp::BiQuadT<double>;
+using cascade = dsp::BiQuadCascadeT<double, 4>;
+
+cascade make_cascade()
+{
+    return cascade( BiQuad{ { 0.2, 0.4, 0.2 }, { -0.5, 0.25 } }, BiQuad{ { 0.1, 0.2, 0.1 }, { -0.8, 0.3 } } );
+}
+
+// Record with the other byte order, from the header layout:
+
+buffer byte_swapped( buffer b, std::size_t scalar )
+{
+    auto swap = [&]( std::size_t pos, std::size_t n )
+    {
+        for ( std::size_t i = 0; i < n / 2; ++i )
+        {
+            std20::swap( b[ pos + i ], b[ pos + n - 1 - i ] );
+        }
+    };
+
+    for ( std::size_t pos =  4; pos < 12; pos += 2 ) swap( pos, 2 );
+    for ( std::size_t pos = 12; pos < 32; pos += 4 ) swap( pos, 4 );
+    for ( std::size_t pos = 32; pos + scalar <= b.size(); pos += scalar ) swap( pos, scalar );
+
+    return b;
+}
+
+} // anonymous namespace
+
+CASE( "checkpoint: Restores a kalman estimator to continue as the original" )
+{
+    kalman ref = make_kalman();
+
+    for ( int i = 1; i <= 10; ++i )
+    {
+        ref.update( {1}, { measurement(i) } );
+    }
+
+    buffer b( num::checkpoint_size( ref ) );
+
+    EXPECT( num::write_checkpoint( ref, b.data(), b.size() ) == b.size() );
+
+    kalman estim = make_kalman();
+
+    EXPECT( num::read_checkpoint( estim, b.data(), b.size() ) );
+
+    for ( int i = 11; i <= 20; ++i )
+    {
+        ref  .update( {1}, { measurement(i) } );
+        estim.update( {1}, { measurement(i) } );
+    }
+
+    EXPECT( identical( estim.system_state(), ref.system_state() ) );
+    EXPECT( identical( estim.estimation_error_covariance(), ref.estimation_error_covariance() ) );
+    EXPECT( identical( estim.kalman_gain(), ref.kalman_gain() ) );
+    EXPECT( estim.time() == ref.time() );
+}
+
+CASE( "checkpoint: Has a compact record of the estimator state, a multiple of 8 bytes" )
+{
+    // header, xhat (2), P (3), K (2), t:
+
+    EXPECT( num::checkpoint_size( make_kalman() ) == 32u + 8 * 8 );
+    EXPECT( num::checkpoint_size( num::kalman<float,2,1,1>( 1, {}, {}, {}, {}, {}, {}, {} ) ) == 32u + 8 * 4 );
+}
+
+CASE( "checkpoint: Restores a record written with the other byte order" )
+{
+    kalman ref = make_kalman();
+    ref.update( {1}, { 3 } );
+
+    buffer b( num::checkpoint_size( ref ) );
+    num::write_checkpoint( ref, b.data(), b.size() );
+
+    const buffer swapped = byte_swapped( b, sizeof(double) );
+
+    kalman estim = make_kalman();
+
+    EXPECT( swapped != b );
+    EXPECT( num::read_checkpoint( estim, swapped.data(), swapped.size() ) );
+    EXPECT( identical( estim.system_state(), ref.system_state() ) );
+    EXPECT( identical( estim.estimation_error_covariance(), ref.estimation_error_covariance() ) );
+}
+
+CASE( "checkpoint: Rejects a record that does not match the estimator" )
+{
+    kalman ref = make_kalman();
+    ref.update( {1}, { 3 } );
+
+    buffer b( num::checkpoint_size( ref ) );
+    num::write_checkpoint( ref, b.data(), b.size() );
+
+    kalman estim = make_kalman();
+    const auto before = estim.system_state();
+
+    buffer magic = b;   magic[0] = 'X';
+    buffer version = b; version[4] = version[5] = 0x7f;
+
+    EXPECT_NOT( num::write_checkpoint( ref, b.data(), b.size() - 1 ) );
+    EXPECT_NOT( num::read_checkpoint( estim, b.data(), b.size() - 1 ) );
+    EXPECT_NOT( num::read_checkpoint( estim, magic.data(), magic.size() ) );
+    EXPECT_NOT( num::read_checkpoint( estim, version.data(), version.size() ) );
+
+    num::kalman<double,2,2,1> other( dt, A, B, {}, Q, {}, Q, { 0, 0 } );
+    EXPECT_NOT( num::read_checkpoint( other, b.data(), b.size() ) );
+
+    cascade filters = make_cascade();
+    EXPECT_NOT( num::read_checkpoint( filters, b.data(), b.size() ) );
+
+    EXPECT( identical( estim.system_state(), before ) );
+}
+
+CASE( "checkpoint: Rejects a record of another numeric type of the same size" )
+{
+    using fp32_t = num::fixed_point<std::int32_t, 15>;
+    using fp16_t = num::fixed_point<std::int32_t, 16>;
+
+    num::kalman<float,2,1,1> ref( 1, { 1, 1, 0, 1 }, { 0.5, 1 }, { 1, 0 }, { 0.01f, 0, 0, 0.01f }, { 100 }, { 1, 0, 0, 1 }, { 0, 0 } );
+    ref.update( {1}, { 0.631f } );
+
+    buffer b( num::checkpoint_size( ref ) );
+    num::write_checkpoint( ref, b.data(), b.size() );
+
+    num::kalman<fp32_t,2,1,1> estim( 1, { 1, 1, 0, 1 }, { 0.5, 1 }, { 1, 0 }, {}, { 100 }, { 1, 0, 0, 1 }, { 0, 0 } );
+
+    EXPECT( num::checkpoint_size( estim ) == b.size() );
+    EXPECT_NOT( num::read_checkpoint( estim, b.data(), b.size() ) );
+    EXPECT( estim.system_state()(0) == fp32_t( 0 ) );
+
+    buffer f( num::checkpoint_size( estim ) );
+    num::write_checkpoint( estim, f.data(), f.size() );
+
+    num::kalman<fp16_t,2,1,1> other( 1, { 1, 1, 0, 1 }, { 0.5, 1 }, { 1, 0 }, {}, { 100 }, { 1, 0, 0, 1 }, { 0, 0 } );
+
+    EXPECT( num::read_checkpoint( estim, f.data(), f.size() ) );
+    EXPECT_NOT( num::read_checkpoint( other, f.data(), f.size() ) );
+}
+
+CASE( "checkpoint: Restores the state of a bi-quad cascade" )
+{
+    cascade ref = make_cascade();
+
+    for ( int i = 0; i < 10; ++i )
+    {
+        step( ref, i % 3 );
+    }
+
+    buffer b( num::checkpoint_size( ref ) );
+
+    EXPECT( b.size() == 32u + 4 * 8 );
+    EXPECT( num::write_checkpoint( ref, b.data(), b.size() ) == b.size() );
+
+    cascade filters = make_cascade();
+
+    EXPECT( num::read_checkpoint( filters, b.data(), b.size() ) );
+
+    for ( int i = 10; i < 20; ++i )
+    {
+        EXPECT( step( filters, i % 3 ) == step( ref, i % 3 ) );
+    }
+
+    cascade shorter = make_cascade();
+    shorter.remove( 1 );
+
+    EXPECT_NOT( num::read_checkpoint( shorter, b.data(), b.size() ) );
+}
@@ -0,0 +1,117 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "num/fixed-point.hpp"
+#include "num/dual.hpp"
+#include "lest.hpp"
+
+#include <cstdint>
+
+#define CASE( name ) lest_CASE( specification(), name )
+
+extern lest::tests & specification();
+
+namespace {
+
+using dual1 = num::dual<double,1>;
+using dual2 = num::dual<double,2>;
+
+// Generic functions, for plain and for dual numbers:
+
+template< typename V >
+V polynomial( V x )
+{
+    return 3 * x * x * x - 2 * x + 5;
+}
+
+template< typename V >
+V rational( V x, V y )
+{
+    return ( x * y ) / ( x + y );
+}
+
+} // anonymous namespace
+
+CASE( "dual: Allows to construct a constant, with zero derivatives" )
+{
+    const dual2 d( 3 );
+
+    EXPECT( d.value() == 3 );
+    EXPECT( d.derivative(0) == 0 );
+    EXPECT( d.derivative(1) == 0 );
+}
+
+CASE( "dual: Allows to construct an independent variable, with unit derivative" )
+{
+    const dual2 d( 3, 1 );
+
+    EXPECT( d.value() == 3 );
+    EXPECT( d.derivative(0) == 0 );
+    EXPECT( d.derivative(1) == 1 );
+}
+
+CASE( "dual: Computes the derivative of a polynomial" )
+{
+    const auto y = polynomial( dual1( 2, 0 ) );
+
+    EXPECT( y.value() == polynomial( 2.0 ) );
+    EXPECT( y.derivative(0) == 9 * 2 * 2 - 2 );
+}
+
+CASE( "dual: Computes the partial derivatives of a quotient" )
+{
+    const double x = 2;
+    const double y = 3;
+
+    const auto r = rational( dual2( x, 0 ), dual2( y, 1 ) );
+
+    EXPECT( r.value() == lest::approx( rational( x, y ) ) );
+    EXPECT( r.derivative(0) == lest::approx( y * y / ( ( x + y ) * ( x + y ) ) ) );
+    EXPECT( r.derivative(1) == lest::approx( x * x / ( ( x + y ) * ( x + y ) ) ) );
+}
+
+CASE( "dual: Applies the chain rule for an elementary function" )
+{
+    const dual1 x( 3, 0 );
+
+    // f(u) = u^2 with u = 2x:
+    const auto u = 2 * x;
+    const auto f = chain( u, u.value() * u.value(), 2 * u.value() );
+
+    EXPECT( f.value() == 36 );
+    EXPECT( f.derivative(0) == 8 * 3 );
+}
+
+CASE( "dual: Allows fixed_point values and derivatives" )
+{
+    using fp32_t = num::fixed_point<std::int32_t, 15>;
+    using dualf  = num::dual<fp32_t,1>;
+
+    const auto y = polynomial( dualf( fp32_t( 2 ), 0 ) );
+
+    EXPECT( y.value() == fp32_t( 25 ) );
+    EXPECT( y.derivative(0) == fp32_t( 34 ) );
+}
+
+CASE( "dual: Computes the Jacobian of a vector function" )
+{
+    const num::colvec<double,2> x = { 2, 3 };
+
+    const auto xd = seed( x );
+
+    const num::colvec<dual2,2> y = { xd(0) * xd(1), xd(0) - 4 * xd(1) };
+
+    const auto J = jacobian( y );
+    const auto v = values( y );
+
+    EXPECT( v(0) ==  6 );
+    EXPECT( v(1) == -10 );
+    EXPECT( J(0,0) ==  3 );
+    EXPECT( J(0,1) ==  2 );
+    EXPECT( J(1,0) ==  1 );
+    EXPECT( J(1,1) == -4 );
+}
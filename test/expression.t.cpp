@@ -0,0 +1,83 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "num/expression.hpp"
+#include "lest.hpp"
+
+#define CASE( name ) lest_CASE( specification(), name )
+
+extern lest::tests & specification();
+
+namespace {
+
+using mat3 = num::matrix<double,3,3>;
+using col3 = num::colvec<double,3>;
+
+const mat3 A = { 0.1, 2.3, 4.5,
+                 6.7, 8.9, 1.2,
+                 3.4, 5.6, 7.8 };
+
+const mat3 P = { 4.1, 1.3, 2.7,
+                 1.3, 5.9, 3.1,
+                 2.7, 3.1, 6.3 };
+
+const num::matrix<double,3,2> B = { 0.5, 0.1,
+                                    1.0, 0.2,
+                                    0.3, 0.7 };
+
+const num::matrix<double,1,3> H = { 1, 0.5, 0 };
+
+const col3 x = { 1.1, -2.2, 3.3 };
+const num::colvec<double,2> u = { 0.25, -0.75 };
+
+template< typename Matrix >
+bool identical( Matrix const & a, Matrix const & b )
+{
+    return std20::equal( a.begin(), a.end(), b.begin() );
+}
+
+} // anonymous namespace
+
+CASE( "expression: Evaluates sums, differences and scaling as the eager operators" )
+{
+    EXPECT( identical( num::evaluate( num::lazy(A) + P ), A + P ) );
+    EXPECT( identical( num::evaluate( A - num::lazy(P) ), A - P ) );
+    EXPECT( identical( num::evaluate( 2.5 * num::lazy(A) ), 2.5 * A ) );
+    EXPECT( identical( num::evaluate( num::lazy(A) + P - A ), A + P - A ) );
+}
+
+CASE( "expression: Evaluates products and transposes as the eager operators" )
+{
+    EXPECT( identical( num::evaluate( num::lazy(A) * P ), A * P ) );
+    EXPECT( identical( num::evaluate( num::lazy(A) * x ), A * x ) );
+    EXPECT( identical( num::evaluate( transposed( num::lazy(A) ) ), transposed( A ) ) );
+    EXPECT( identical( num::evaluate( num::lazy(P) * transposed( num::lazy(A) ) ), P * transposed( A ) ) );
+}
+
+CASE( "expression: Evaluates a chain of products and additions as the eager operators" )
+{
+    EXPECT( identical( num::evaluate( num::lazy(A) * P * transposed( num::lazy(A) ) + P ), A * P * transposed( A ) + P ) );
+    EXPECT( identical( num::evaluate( num::lazy(A) * x + num::lazy(B) * u ), A * x + B * u ) );
+    EXPECT( identical( num::evaluate( num::lazy(x) + num::lazy(B) * ( u - num::lazy(transposed(B)) * x ) ), x + B * ( u - transposed(B) * x ) ) );
+}
+
+CASE( "expression: Evaluates a 1 x 1 innovation as the eager operators" )
+{
+    const num::colvec<double,1> z = { 2.0 };
+    const num::matrix<double,3,1> K = { 0.3, 0.2, 0.1 };
+
+    EXPECT( identical( num::evaluate( num::lazy(x) + num::lazy(K) * ( z - num::lazy(H) * x ) ), x + K * ( z - H * x ) ) );
+}
+
+CASE( "expression: Assigns an expression to a destination" )
+{
+    mat3 result(0);
+
+    num::assign( result, num::lazy(A) * P + A );
+
+    EXPECT( identical( result, A * P + A ) );
+}
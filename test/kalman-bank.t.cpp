@@ -0,0 +1,268 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "num/fixed-point.hpp"
+#include "dsp/kalman-bank.hpp"
+#include "kalman-fixture.hpp"
+#include "lest.hpp"
+#include <vector>
+
+#define CASE( name ) lest_CASE( specification(), name )
+
+extern lest::tests & specification();
+
+using namespace num;
+
+namespace {
+
+using namespace fixture;
+
+// Constant acceleration model of kalman-sim.e.cpp, with per-instance perturbation:
+
+template< typename Kalman >
+struct model
+{
+    using real_t = typename Kalman::real_t;
+
+    real_t dt = 1;
+    real_t measnoise  = 10;
+    real_t accelnoise = 0.2;
+
+    typename Kalman::A_t A = { 1, dt, 0, 1 };
+    typename Kalman::B_t B = { dt * dt / 2, dt };
+    typename Kalman::H_t H = { 1, 0 };
+    typename Kalman::R_t R;
+    typename Kalman::Q_t Q;
+    typename Kalman::xhat_t xhat;
+
+    explicit model( int i )
+    : measnoise( 10 + i % 3 )
+    , R( { measnoise * measnoise } )
+    , Q( accelnoise * accelnoise * typename Kalman::Q_t( { dt*dt*dt*dt/4, dt*dt*dt/2, dt*dt*dt/2, dt*dt } ) )
+    , xhat( { real_t(i % 5), 0 } )
+    {}
+
+    Kalman make() const
+    {
+        return Kalman( dt, A, B, H, Q, R, Q, xhat );
+    }
+};
+
+template< typename T, int N >
+bool run_bank_against_scalar()
+{
+    using kalman = num::kalman<T,2,1,1>;
+    using bank_t = num::kalman_bank<T,2,1,1,N>;
+
+    std::vector<kalman> estim;
+
+    const model<kalman> m0( 0 );
+    bank_t bank( m0.dt, m0.A, m0.B, m0.H, m0.Q, m0.R, m0.Q, m0.xhat );
+
+    for ( int i = 0; i < N; ++i )
+    {
+        const model<kalman> m( i );
+
+        estim.push_back( m.make() );
+        bank.assign( i, m.A, m.B, m.H, m.Q, m.R, m.Q, m.xhat );
+    }
+
+    typename bank_t::u_bank_t u;
+    typename bank_t::z_bank_t z;
+
+    for ( int step = 0; step < 50; ++step )
+    {
+        for ( int i = 0; i < N; ++i )
+        {
+            u[0][i] = T( 1 );
+            z[0][i] = T( 0.5 * step * step + ( (step * 7 + i * 13) % 17 ) - 8 );
+
+            estim[i].update( { u[0][i] }, { z[0][i] } );
+        }
+
+        bank.update( u, z );
+
+        for ( int i = 0; i < N; ++i )
+        {
+            if ( !identical( bank.system_state(i), estim[i].system_state() )
+              || !identical( bank.kalman_gain(i), estim[i].kalman_gain() )
+              || !identical( bank.estimation_error_covariance(i), estim[i].estimation_error_covariance() ) )
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+CASE( "kalman-bank: Allows to construct a bank of estimators that share model and initial state" )
+{
+    using bank_t = num::kalman_bank<double,2,1,1,5>;
+
+    bank_t bank( 1, {1,1,0,1}, {0.5,1}, {1,0}, {0.01,0,0,0.04}, {100}, {1,0,0,1}, {3,4} );
+
+    EXPECT( bank.size() == 5 );
+    EXPECT( bank.time() == 0 );
+
+    for ( int i = 0; i < bank.size(); ++i )
+    {
+        EXPECT( bank.system_state(i)(0) == 3 );
+        EXPECT( bank.system_state(i)(1) == 4 );
+        EXPECT( bank.estimation_error_covariance(i)(0,0) == 1 );
+    }
+}
+
+CASE( "kalman-bank: Yields results identical to separate estimators - double" )
+{
+    EXPECT( (run_bank_against_scalar<double, 7>()) );
+    EXPECT( (run_bank_against_scalar<double, 131>()) );
+}
+
+CASE( "kalman-bank: Yields results identical to separate estimators - fixed_point" )
+{
+    EXPECT( (run_bank_against_scalar<fixed_point<int, 15>, 67>()) );
+}
+
+CASE( "kalman-bank: Yields results identical to separate estimators - two measurements" )
+{
+    using kalman = num::kalman<double,2,2,1>;
+    using bank_t = num::kalman_bank<double,2,2,1,3>;
+
+    const kalman::A_t A = { 1, 1, 0, 1 };
+    const kalman::B_t B = { 0.5, 1 };
+    const kalman::H_t H = { 1, 0, 0, 1 };
+    const kalman::Q_t Q = { 0.01, 0.02, 0.02, 0.04 };
+    const kalman::R_t R = { 100, 0, 0, 4 };
+
+    kalman estim[] =
+    {
+        kalman( 1, A, B, H, Q, R, Q, {0,0} ),
+        kalman( 1, A, B, H, Q, R, Q, {1,0} ),
+        kalman( 1, A, B, H, Q, R, Q, {2,0} ),
+    };
+
+    bank_t bank( 1, A, B, H, Q, R, Q, {0,0} );
+
+    bank.assign( 1, A, B, H, Q, R, Q, {1,0} );
+    bank.assign( 2, A, B, H, Q, R, Q, {2,0} );
+
+    bank_t::u_bank_t u = { { 1, 1, 1 } };
+    bank_t::z_bank_t z;
+
+    for ( int step = 0; step < 20; ++step )
+    {
+        for ( int i = 0; i < bank.size(); ++i )
+        {
+            z[0][i] = 0.5 * step * step + i;
+            z[1][i] = step + 0.1 * i;
+
+            estim[i].update( { u[0][i] }, { z[0][i], z[1][i] } );
+        }
+
+        bank.update( u, z );
+    }
+
+    for ( int i = 0; i < bank.size(); ++i )
+    {
+        EXPECT( identical( bank.system_state(i), estim[i].system_state() ) );
+        EXPECT( identical( bank.kalman_gain(i), estim[i].kalman_gain() ) );
+        EXPECT( identical( bank.estimation_error_covariance(i), estim[i].estimation_error_covariance() ) );
+    }
+}
+
+CASE( "kalman-bank: Yields results identical to separate estimators - three measurements" )
+{
+    using kalman = num::kalman<double,3,3,1>;
+    using bank_t = num::kalman_bank<double,3,3,1,3>;
+
+    const kalman::A_t A = { 1, 1, 0.5,  0, 1, 1,  0, 0, 1 };
+    const kalman::B_t B = { 0, 0, 1 };
+    const kalman::H_t H = { 1, 0, 0,  0, 1, 0,  0, 0, 1 };
+    const kalman::Q_t Q = { 0.01, 0.02, 0.01,  0.02, 0.04, 0.02,  0.01, 0.02, 0.04 };
+    const kalman::R_t R = { 100, 0, 0,  0, 4, 1,  0, 1, 2 };
+
+    kalman estim[] =
+    {
+        kalman( 1, A, B, H, Q, R, Q, {0,0,0} ),
+        kalman( 1, A, B, H, Q, R, Q, {1,0,0} ),
+        kalman( 1, A, B, H, Q, R, Q, {2,0,0} ),
+    };
+
+    bank_t bank( 1, A, B, H, Q, R, Q, {0,0,0} );
+
+    bank.assign( 1, A, B, H, Q, R, Q, {1,0,0} );
+    bank.assign( 2, A, B, H, Q, R, Q, {2,0,0} );
+
+    bank_t::u_bank_t u = { { 0.1, 0.1, 0.1 } };
+    bank_t::z_bank_t z;
+
+    for ( int step = 0; step < 20; ++step )
+    {
+        for ( int i = 0; i < bank.size(); ++i )
+        {
+            z[0][i] = 0.5 * step * step + i;
+            z[1][i] = step + 0.1 * i;
+            z[2][i] = 1 + 0.01 * i;
+
+            estim[i].update( { u[0][i] }, { z[0][i], z[1][i], z[2][i] } );
+        }
+
+        bank.update( u, z );
+    }
+
+    for ( int i = 0; i < bank.size(); ++i )
+    {
+        EXPECT( identical( bank.system_state(i), estim[i].system_state() ) );
+        EXPECT( identical( bank.kalman_gain(i), estim[i].kalman_gain() ) );
+        EXPECT( identical( bank.estimation_error_covariance(i), estim[i].estimation_error_covariance() ) );
+    }
+}
+
+CASE( "kalman-bank: Yields results identical to separate estimators - no control input" )
+{
+    using kalman = num::kalman<double,2,1,0>;
+    using bank_t = num::kalman_bank<double,2,1,0,8>;
+
+    const kalman::A_t A = { 1, 1, 0, 1 };
+    const kalman::H_t H = { 1, 0 };
+    const kalman::Q_t Q = { 0.01, 0.02, 0.02, 0.04 };
+    const kalman::R_t R = { 100 };
+
+    std::vector<kalman> estim;
+
+    bank_t bank( 1, A, {}, H, Q, R, Q, {0,0} );
+
+    for ( int i = 0; i < bank.size(); ++i )
+    {
+        estim.push_back( kalman( 1, A, {}, H, Q, R, Q, { double(i), 0 } ) );
+        bank.assign( i, A, {}, H, Q, R, Q, { double(i), 0 } );
+    }
+
+    bank_t::u_bank_t u = {};
+    bank_t::z_bank_t z;
+
+    for ( int step = 0; step < 20; ++step )
+    {
+        for ( int i = 0; i < bank.size(); ++i )
+        {
+            z[0][i] = step + 0.5 * i;
+
+            estim[i].update( {}, { z[0][i] } );
+        }
+
+        bank.update( u, z );
+    }
+
+    for ( int i = 0; i < bank.size(); ++i )
+    {
+        EXPECT( identical( bank.system_state(i), estim[i].system_state() ) );
+        EXPECT( identical( bank.kalman_gain(i), estim[i].kalman_gain() ) );
+        EXPECT( identical( bank.estimation_error_covariance(i), estim[i].estimation_error_covariance() ) );
+    }
+}
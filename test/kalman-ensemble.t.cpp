@@ -0,0 +1,172 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "dsp/kalman-ensemble.hpp"
+#include "kalman-fixture.hpp"
+#include "lest.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+
+#define CASE( name ) lest_CASE( specification(), name )
+
+extern lest::tests & specification();
+
+namespace {
+
+using namespace fixture;
+
+// Process noise covariance per member, the model's made positive definite:
+
+const kalman::Q_t Qm = Q + accelnoise * accelnoise * kalman::Q_t( { 1e-6, 0, 0, 0 } );
+
+struct linear_process
+{
+    kalman::xhat_t operator()( kalman::xhat_t const & x, kalman::u_t const & u ) const
+    {
+        return A * x + B * u;
+    }
+};
+
+struct linear_measure
+{
+    kalman::z_t operator()( kalman::xhat_t const & x ) const
+    {
+        return H * x;
+    }
+};
+
+using ensemble = num::kalman_ensemble<double,2,1,1,linear_process,linear_measure>;
+
+ensemble::xhat_t run( int threads, int members, int steps, kalman::P_t const & P )
+{
+    num::worker_pool pool( threads );
+
+    ensemble estim( pool, dt, {}, {}, Qm, R, P, { 0, 0 }, members, 42 );
+
+    for ( int step = 0; step < steps; ++step )
+    {
+        estim.update( { 1 }, { measurement( step ) } );
+    }
+    return estim.system_state();
+}
+
+} // anonymous namespace
+
+CASE( "worker_pool: Covers a range exactly once, for any number of threads" )
+{
+    for ( int threads = 1; threads <= 5; ++threads )
+    {
+        num::worker_pool pool( threads );
+
+        std::atomic<int> count[37] = {};
+
+        for ( int rep = 0; rep < 3; ++rep )
+        {
+            pool.for_each( 37, [&]( int b, int e )
+            {
+                for ( int i = b; i < e; ++i )
+                {
+                    ++count[i];
+                }
+            });
+        }
+
+        int fails = 0;
+
+        for ( auto const & c : count )
+        {
+            fails += c != 3;
+        }
+
+        EXPECT( pool.threads() == threads );
+        EXPECT( fails == 0 );
+    }
+}
+
+CASE( "worker_pool: Rethrows an exception of any range in the caller, and remains usable" )
+{
+    for ( int threads = 1; threads <= 4; ++threads )
+    {
+        num::worker_pool pool( threads );
+
+        for ( int last = 0; last < threads; ++last )
+        {
+            // Throw in the range of thread 'last', 0 the caller:
+
+            EXPECT_THROWS_AS( pool.for_each( 16, [&]( int b, int )
+            {
+                if ( b == 16 * last / threads )
+                {
+                    throw std::runtime_error( "range" );
+                }
+            }), std::runtime_error );
+        }
+
+        std::atomic<int> count( 0 );
+
+        pool.for_each( 16, [&]( int b, int e ){ count += e - b; } );
+
+        EXPECT( count == 16 );
+    }
+}
+
+CASE( "kalman_ensemble: Draws the initial ensemble from the initial state and covariance" )
+{
+    num::worker_pool pool( 2 );
+
+    const kalman::P_t P = { 4, 1, 1, 2 };
+
+    ensemble estim( pool, dt, {}, {}, Qm, R, P, { 3, 4 }, 4000 );
+
+    const auto x  = estim.system_state();
+    const auto Pe = estim.estimation_error_covariance();
+
+    EXPECT( estim.members() == 4000 );
+    EXPECT( estim.time() == 0 );
+    EXPECT( std::abs( x(0) - 3 ) < 0.1 );
+    EXPECT( std::abs( x(1) - 4 ) < 0.1 );
+    EXPECT( std::abs( Pe(0,0) - 4 ) < 0.3 );
+    EXPECT( std::abs( Pe(0,1) - 1 ) < 0.2 );
+    EXPECT( std::abs( Pe(1,1) - 2 ) < 0.2 );
+}
+
+CASE( "kalman_ensemble: Approximates the estimate of kalman for a linear model" )
+{
+    const kalman::P_t P = { 10, 0, 0, 10 };
+
+    num::worker_pool pool( 4 );
+
+    kalman   ref  ( dt, A, B, H, Qm, R, P, { 0, 0 } );
+    ensemble estim( pool, dt, {}, {}, Qm, R, P, { 0, 0 }, 2000 );
+
+    for ( int step = 0; step < 30; ++step )
+    {
+        ref  .update( { 1 }, { measurement( step ) } );
+        estim.update( { 1 }, { measurement( step ) } );
+    }
+
+    const auto x  = estim.system_state();
+    const auto xr = ref.system_state();
+    const auto Pr = ref.estimation_error_covariance();
+
+    EXPECT( std::abs( x(0) - xr(0) ) < 0.2 * std::sqrt( Pr(0,0) ) );
+    EXPECT( std::abs( x(1) - xr(1) ) < 0.2 * std::sqrt( Pr(1,1) ) );
+    EXPECT( std::abs( estim.kalman_gain()(0,0) - ref.kalman_gain()(0,0) ) < 0.1 );
+}
+
+CASE( "kalman_ensemble: Computes the same estimate for a given seed, regardless of the number of threads" )
+{
+    const kalman::P_t P = { 10, 0, 0, 10 };
+
+    const auto x1 = run( 1, 100, 20, P );
+
+    EXPECT( identical( run( 2, 100, 20, P ), x1 ) );
+    EXPECT( identical( run( 3, 100, 20, P ), x1 ) );
+    EXPECT( identical( run( 8, 100, 20, P ), x1 ) );
+}
@@ -0,0 +1,171 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "num/fixed-point.hpp"
+#include "dsp/kalman-extended.hpp"
+#include "kalman-fixture.hpp"
+#include "lest.hpp"
+
+#include <cmath>
+#include <cstdint>
+
+#define CASE( name ) lest_CASE( specification(), name )
+
+extern lest::tests & specification();
+
+namespace {
+
+using namespace fixture;
+
+// Constant acceleration model of the fixture, as linear functions:
+
+struct linear_process
+{
+    template< typename V >
+    num::colvec<V,2> operator()( num::colvec<V,2> const & x, num::colvec<double,1> const & u ) const
+    {
+        return { x(0) + dt * x(1) + dt * dt / 2 * u(0), x(1) + dt * u(0) };
+    }
+};
+
+struct linear_measure
+{
+    template< typename V >
+    num::colvec<V,1> operator()( num::colvec<V,2> const & x ) const
+    {
+        return { x(0) };
+    }
+};
+
+// Hardening spring, x'' = -k x - k3 x^3, Euler-integrated, with a
+// measurement of position that saturates, x - c x^3:
+
+template< typename T >
+struct spring
+{
+    T dt, k, k3;
+
+    template< typename V >
+    num::colvec<V,2> operator()( num::colvec<V,2> const & x, num::colvec<T,1> const & ) const
+    {
+        return { x(0) + dt * x(1), x(1) - dt * ( k * x(0) + k3 * x(0) * x(0) * x(0) ) };
+    }
+};
+
+template< typename T >
+struct saturating_sensor
+{
+    T c;
+
+    template< typename V >
+    num::colvec<V,1> operator()( num::colvec<V,2> const & x ) const
+    {
+        return { x(0) - c * x(0) * x(0) * x(0) };
+    }
+};
+
+// Deterministic measurement noise in [-1,1]:
+
+double noise( int step )
+{
+    return ( ( step * 7919 ) % 201 - 100 ) / 100.0;
+}
+
+} // anonymous namespace
+
+CASE( "kalman_extended: Allows to construct an estimator from models, initial covariance and state" )
+{
+    using ekf = num::kalman_extended<double,2,1,1,linear_process,linear_measure>;
+
+    const kalman::P_t P = { 4, 1, 1, 2 };
+
+    ekf estim( dt, {}, {}, Q, R, P, { 3, 4 } );
+
+    EXPECT( estim.time() == 0 );
+    EXPECT( estim.system_state()(0) == 3 );
+    EXPECT( estim.system_state()(1) == 4 );
+    EXPECT( approx_equal( estim.estimation_error_covariance(), P ) );
+}
+
+CASE( "kalman_extended: Computes the same estimate as kalman for a linear model" )
+{
+    using ekf = num::kalman_extended<double,2,1,1,linear_process,linear_measure>;
+
+    const kalman::P_t P = Q;
+
+    kalman ref  ( dt, A, B, H, Q, R, P, { 0, 0 } );
+    ekf    estim( dt, {}, {}, Q, R, P, { 0, 0 } );
+
+    for ( int step = 0; step < 30; ++step )
+    {
+        ref  .update( { 1 }, { measurement( step ) } );
+        estim.update( { 1 }, { measurement( step ) } );
+    }
+
+    EXPECT( approx_equal( estim.system_state(), ref.system_state() ) );
+    EXPECT( approx_equal( estim.kalman_gain(), ref.kalman_gain() ) );
+    EXPECT( approx_equal( estim.estimation_error_covariance(), ref.estimation_error_covariance() ) );
+}
+
+CASE( "kalman_extended: Tracks a nonlinear system through a nonlinear measurement" )
+{
+    using process = spring<double>;
+    using measure = saturating_sensor<double>;
+    using ekf     = num::kalman_extended<double,2,1,1,process,measure>;
+
+    const process f = { 0.01, 4, 2 };
+    const measure h = { 0.1 };
+
+    const ekf::Q_t Qs = { 1e-8, 0, 0, 1e-6 };
+    const ekf::R_t Rs = { 1e-4 };
+    const ekf::P_t Ps = { 1, 0, 0, 1 };
+
+    ekf estim( f.dt, f, h, Qs, Rs, Ps, { 0, 0 } );
+
+    num::colvec<double,2> x = { 1, 0 };
+
+    for ( int step = 0; step < 1000; ++step )
+    {
+        x = f( x, { 0 } );
+        estim.update( { 0 }, { h( x )(0) + 0.01 * noise( step ) } );
+    }
+
+    EXPECT( std::abs( estim.system_state()(0) - x(0) ) < 0.01 );
+    EXPECT( std::abs( estim.system_state()(1) - x(1) ) < 0.05 );
+    EXPECT( estim.estimation_error_covariance()(0,0) < 1e-4 );
+}
+
+CASE( "kalman_extended: Allows a fixed_point numeric type" )
+{
+    using fp32_t  = num::fixed_point<std::int32_t, 8>;
+    using process = spring<fp32_t>;
+    using measure = saturating_sensor<fp32_t>;
+    using ekf     = num::kalman_extended<fp32_t,2,1,1,process,measure>;
+
+    const process f = { 1 / 64.0, 4, 2 };
+    const measure h = { 0.1 };
+
+    const ekf::Q_t Qs = { 1e-5, 0, 0, 1e-4 };
+    const ekf::R_t Rs = { 1e-3 };
+    const ekf::P_t Ps = { 1, 0, 0, 1 };
+
+    using plain = spring<double>;
+    const plain fd = { 1 / 64.0, 4, 2 };
+
+    ekf estim( f.dt, f, h, Qs, Rs, Ps, { 0, 0 } );
+
+    num::colvec<double,2> x = { 1, 0 };
+
+    for ( int step = 0; step < 200; ++step )
+    {
+        x = fd( x, { 0 } );
+        estim.update( { 0 }, { x(0) - 0.1 * x(0) * x(0) * x(0) } );
+    }
+
+    EXPECT( std::abs( estim.system_state()(0).as_double() - x(0) ) < 0.05 );
+    EXPECT( std::abs( estim.system_state()(1).as_double() - x(1) ) < 0.2 );
+}
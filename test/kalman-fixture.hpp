@@ -0,0 +1,68 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Model and helpers shared by the tests of the Kalman estimators.
+
+#ifndef TEST_KALMAN_FIXTURE_HPP_INCLUDED
+#define TEST_KALMAN_FIXTURE_HPP_INCLUDED
+
+#include "dsp/kalman.hpp"
+#include "lest.hpp"
+
+namespace fixture {
+
+using kalman = num::kalman<double,2,1,1>;
+
+// Constant acceleration model of kalman-sim.e.cpp:
+
+constexpr double dt = 1;
+constexpr double measnoise  = 10;
+constexpr double accelnoise = 0.2;
+
+constexpr kalman::A_t A = { 1, dt, 0, 1 };
+constexpr kalman::B_t B = { dt * dt / 2, dt };
+constexpr kalman::H_t H = { 1, 0 };
+constexpr kalman::R_t R = { measnoise * measnoise };
+constexpr kalman::Q_t Q = accelnoise * accelnoise * kalman::Q_t(
+    { dt*dt*dt*dt/4, dt*dt*dt/2, dt*dt*dt/2, dt*dt } );
+
+constexpr kalman make_kalman()
+{
+    return kalman( dt, A, B, H, Q, R, Q, { 0, 0 } );
+}
+
+// Deterministic measurement of the accelerated object:
+
+constexpr double measurement( int step )
+{
+    return 0.5 * step * step + ( ( step * 7 ) % 17 ) - 8;
+}
+
+// Element-wise comparison of matrices, exact and to a relative eps:
+
+template< typename Matrix >
+bool identical( Matrix const & a, Matrix const & b )
+{
+    return std20::equal( a.begin(), a.end(), b.begin() );
+}
+
+template< typename Matrix >
+bool approx_equal( Matrix const & a, Matrix const & b, double eps = 1e-9 )
+{
+    for ( int i = 0; i < a.size(); ++i )
+    {
+        if ( a(i) != lest::approx( b(i) ).epsilon( eps ) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace fixture
+
+#endif // TEST_KALMAN_FIXTURE_HPP_INCLUDED
@@ -0,0 +1,214 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "dsp/kalman-history.hpp"
+#include "dsp/kalman-telemetry.hpp"
+#include "dsp/kalman-ud.hpp"
+#include "kalman-fixture.hpp"
+#include "lest.hpp"
+
+#define CASE( name ) lest_CASE( specification(), name )
+
+extern lest::tests & specification();
+
+namespace {
+
+using namespace fixture;
+
+using history = num::kalman_history<kalman, 8>;
+
+} // anonymous namespace
+
+CASE( "kalman_history: Behaves as the estimator when measurements arrive in sequence" )
+{
+    kalman  ref  ( dt, A, B, H, Q, R, Q, { 0, 0 } );
+    history estim( dt, A, B, H, Q, R, Q, { 0, 0 } );
+
+    for ( int i = 1; i <= 20; ++i )
+    {
+        ref  .update( {1}, { measurement(i) } );
+        estim.update( {1}, { measurement(i) } );
+    }
+
+    EXPECT( estim.step() == 20 );
+    EXPECT( estim.oldest_step() == 13 );
+    EXPECT( identical( estim.system_state(), ref.system_state() ) );
+    EXPECT( identical( estim.estimation_error_covariance(), ref.estimation_error_covariance() ) );
+}
+
+CASE( "kalman_history: Applies a late measurement as if it arrived in sequence" )
+{
+    kalman  ref  ( dt, A, B, H, Q, R, Q, { 0, 0 } );
+    history estim( dt, A, B, H, Q, R, Q, { 0, 0 } );
+
+    for ( int i = 1; i <= 20; ++i )
+    {
+        ref.update( {1}, { measurement(i) } );
+
+        if ( i == 15 )
+        {
+            estim.predict( {1} );   // measurement 15 is late
+        }
+        else
+        {
+            estim.update( {1}, { measurement(i) } );
+        }
+
+        if ( i == 18 )
+        {
+            EXPECT( estim.correct_at( 15, { measurement(15) } ) );
+        }
+    }
+
+    EXPECT( estim.time() == ref.time() );
+    EXPECT( identical( estim.system_state(), ref.system_state() ) );
+    EXPECT( identical( estim.kalman_gain(), ref.kalman_gain() ) );
+    EXPECT( identical( estim.estimation_error_covariance(), ref.estimation_error_covariance() ) );
+}
+
+CASE( "kalman_history: Applies a second measurement to a time-step" )
+{
+    kalman  ref  ( dt, A, B, H, Q, R, Q, { 0, 0 } );
+    history estim( dt, A, B, H, Q, R, Q, { 0, 0 } );
+
+    for ( int i = 1; i <= 10; ++i )
+    {
+        ref  .update( {1}, { measurement(i) } );
+        estim.update( {1}, { measurement(i) } );
+
+        if ( i == 7 )
+        {
+            ref.correct( { measurement(i) + 1 } );
+        }
+    }
+
+    EXPECT( estim.correct_at( 7, { measurement(7) + 1 } ) );
+    EXPECT( identical( estim.system_state(), ref.system_state() ) );
+    EXPECT( identical( estim.estimation_error_covariance(), ref.estimation_error_covariance() ) );
+}
+
+CASE( "kalman_history: Rejects a measurement outside the history" )
+{
+    num::kalman_history<kalman, 4, 1> estim( dt, A, B, H, Q, R, Q, { 0, 0 } );
+
+    for ( int i = 1; i <= 10; ++i )
+    {
+        estim.update( {1}, { measurement(i) } );
+    }
+
+    const auto x = estim.system_state();
+
+    EXPECT_NOT( estim.correct_at(  6, { 0 } ) );
+    EXPECT_NOT( estim.correct_at( 11, { 0 } ) );
+    EXPECT_NOT( estim.correct_at(  8, { 0 } ) );    // already has Z = 1 measurement
+    EXPECT( identical( estim.system_state(), x ) );
+}
+
+CASE( "kalman_history: Allows a UD-factored estimator" )
+{
+    using kalman_ud = num::kalman_ud<double,2,1,1>;
+
+    kalman_ud                             ref  ( dt, A, B, H, Q, R, Q, { 0, 0 } );
+    num::kalman_history<kalman_ud, 4, 1> estim( dt, A, B, H, Q, R, Q, { 0, 0 } );
+
+    for ( int i = 1; i <= 10; ++i )
+    {
+        ref.update( {1}, { measurement(i) } );
+
+        if ( i == 8 ) estim.predict( {1} );
+        else          estim.update( {1}, { measurement(i) } );
+    }
+
+    EXPECT( estim.correct_at( 8, { measurement(8) } ) );
+    EXPECT( identical( estim.system_state(), ref.system_state() ) );
+}
+
+CASE( "kalman_history: Replays with the gain mode of the time-step" )
+{
+    kalman  ref  ( dt, A, B, H, Q, R, Q, { 0, 0 } );
+    history estim( dt, A, B, H, Q, R, Q, { 0, 0 } );
+
+    ref  .auto_fix_gain( 0.05 );
+    estim.auto_fix_gain( 0.05 );
+
+    int fixed_at = 0;
+
+    for ( int i = 1; i <= 16; ++i )
+    {
+        ref.update( {1}, { measurement(i) } );
+
+        if ( !fixed_at && ref.is_gain_fixed() )
+        {
+            fixed_at = i;
+        }
+
+        if ( i == 10 ) estim.predict( {1} );
+        else           estim.update( {1}, { measurement(i) } );
+    }
+
+    EXPECT( fixed_at > 10 );
+
+    EXPECT( estim.correct_at( 10, { measurement(10) } ) );
+    EXPECT( estim.is_gain_fixed() );
+    EXPECT( identical( estim.system_state(), ref.system_state() ) );
+    EXPECT( identical( estim.kalman_gain(), ref.kalman_gain() ) );
+}
+
+CASE( "kalman_history: Counts the rejections of a replay as if the measurements arrived in sequence" )
+{
+    kalman  ref  ( dt, A, B, H, Q, R, Q, { 0, 0 } );
+    history estim( dt, A, B, H, Q, R, Q, { 0, 0 } );
+
+    ref  .gate( num::chi_square_quantile( 1, 0.99 ) );
+    estim.gate( num::chi_square_quantile( 1, 0.99 ) );
+
+    for ( int i = 1; i <= 20; ++i )
+    {
+        const double z = i == 17 ? measurement(i) + 1000 : measurement(i);
+
+        ref.update( {1}, { z } );
+
+        if ( i == 15 ) estim.predict( {1} );
+        else           estim.update( {1}, { z } );
+    }
+
+    EXPECT( ref.rejections() == 1 );
+    EXPECT( estim.rejections() == 1 );
+
+    EXPECT( estim.correct_at( 15, { measurement(15) } ) );
+    EXPECT( estim.rejections() == 1 );
+    EXPECT( identical( estim.system_state(), ref.system_state() ) );
+}
+
+CASE( "kalman_history: Keeps a replay out of the telemetry record" )
+{
+    using recorded = num::kalman<double,2,1,1, num::dense_structure, num::ring_telemetry<32>>;
+
+    num::kalman_history<recorded, 8> estim( dt, A, B, H, Q, R, Q, { 0, 0 } );
+
+    for ( int i = 1; i <= 10; ++i )
+    {
+        if ( i == 7 ) estim.predict( {1} );
+        else          estim.update( {1}, { measurement(i) } );
+    }
+
+    EXPECT( estim.telemetry().recorded() == 9 );
+    EXPECT( estim.correct_at( 7, { measurement(7) } ) );
+    EXPECT( estim.telemetry().recorded() == 9 );
+}
+
+CASE( "kalman_history: Rejects a measurement beyond Z per time-step, leaving the estimator unchanged" )
+{
+    num::kalman_history<kalman, 4, 1> estim( dt, A, B, H, Q, R, Q, { 0, 0 } );
+
+    EXPECT( estim.update( {1}, { measurement(1) } ) );
+
+    const auto x = estim.system_state();
+
+    EXPECT_NOT( estim.correct( { measurement(1) + 1 } ) );
+    EXPECT( identical( estim.system_state(), x ) );
+}
@@ -0,0 +1,98 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "dsp/kalman-iir.hpp"
+#include "kalman-fixture.hpp"
+#include "lest.hpp"
+
+#include <vector>
+
+#define CASE( name ) lest_CASE( specification(), name )
+
+extern lest::tests & specification();
+
+namespace {
+
+using namespace fixture;
+
+bool close( double a, double b )
+{
+    return a == lest::approx( b ).epsilon( 1e-9 );
+}
+
+CASE( "kalman-iir: State-space filter reproduces the steady-state estimator" "[kalman-iir]" )
+{
+    kalman estim( kalman::steady_state, dt, A, B, H, Q, R, { 3, -1 } );
+
+    auto filter = num::to_state_space( estim );
+
+    bool same = true;
+
+    for ( int k = 1; k <= 100; ++k )
+    {
+        const kalman::u_t u = { k % 3 - 1.0 };
+
+        estim.update( u, measurement( k ) );
+
+        same = same && approx_equal( filter.step( u, measurement( k ) ), estim.system_state() );
+    }
+
+    EXPECT( same );
+}
+
+CASE( "kalman-iir: State-space filter processes a block of measurements" "[kalman-iir]" )
+{
+    kalman estim( kalman::steady_state, dt, A, B, H, Q, R, { 0, 0 } );
+
+    auto filter = num::to_state_space( estim );
+
+    std::vector<double> z;
+    std::vector<kalman::xhat_t> xhat( 50 );
+
+    for ( int k = 1; k <= 50; ++k )
+    {
+        z.push_back( measurement( k ) );
+    }
+
+    EXPECT( filter.step( z.begin(), z.end(), xhat.begin() ) == xhat.end() );
+
+    bool same = true;
+
+    for ( int k = 1; k <= 50; ++k )
+    {
+        estim.update( { 0 }, measurement( k ) );
+
+        same = same && approx_equal( xhat[k - 1], estim.system_state() );
+    }
+
+    EXPECT( same );
+}
+
+CASE( "kalman-iir: Bi-quad cascade reproduces each component of the steady-state estimate" "[kalman-iir]" )
+{
+    kalman estim( kalman::steady_state, dt, A, B, H, Q, R, { 0, 0 } );
+
+    auto position = num::to_biquad_cascade( estim, 0 );
+    auto velocity = num::to_biquad_cascade( estim, 1 );
+
+    EXPECT( is_stable( position ) );
+
+    bool same = true;
+
+    for ( int k = 1; k <= 200; ++k )
+    {
+        estim.update( { 0 }, measurement( k ) );
+
+        same = same
+            && close( step( position, measurement( k ) ), estim.system_state()(0) )
+            && close( step( velocity, measurement( k ) ), estim.system_state()(1) );
+    }
+
+    EXPECT( same );
+}
+
+} // anonymous namespace
@@ -0,0 +1,153 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "dsp/kalman-imm.hpp"
+#include "num/worker-pool.hpp"
+#include "lest.hpp"
+
+#include <cmath>
+
+#define CASE( name ) lest_CASE( specification(), name )
+
+extern lest::tests & specification();
+
+namespace {
+
+using kalman = num::kalman<double,2,1,1>;
+
+// Constant velocity model, position measured, with the acceleration as
+// process noise of a cruising (quiet) and a manoeuvring regime:
+
+const double dt = 1;
+
+const kalman::A_t A = { 1, dt, 0, 1 };
+const kalman::B_t B = { dt * dt / 2, dt };
+const kalman::H_t H = { 1, 0 };
+const kalman::R_t R = { 1 };
+
+kalman::Q_t Q( double accelnoise )
+{
+    return accelnoise * accelnoise * kalman::Q_t( { dt*dt*dt*dt/4, dt*dt*dt/2, dt*dt*dt/2, dt*dt } );
+}
+
+kalman make( double accelnoise )
+{
+    return kalman( dt, A, B, H, Q( accelnoise ), R, 10 * Q( 1 ), { 0, 0 } );
+}
+
+const kalman::P_t Pi = { 0.95, 0.05, 0.05, 0.95 };
+
+// Cruising at 1 / step, from step 30 accelerating at 2 / step^2, with a
+// deterministic measurement error within +/- 1:
+
+double position( int k )
+{
+    return k < 30 ? k : 30 + ( k - 30 ) + ( k - 30 ) * ( k - 30 );
+}
+
+double measurement( int k )
+{
+    return position( k ) + ( ( k * 7 ) % 17 ) / 8.0 - 1;
+}
+
+template< typename Matrix >
+bool identical( Matrix const & a, Matrix const & b )
+{
+    return std20::equal( a.begin(), a.end(), b.begin() );
+}
+
+} // anonymous namespace
+
+CASE( "kalman_imm: Computes an exponential as std::exp" )
+{
+    for ( double x : { -700.0, -30.0, -2.5, -0.3, 0.0, 0.4, 1.0, 5.0 } )
+    {
+        EXPECT( num::exponential( x ) == lest::approx( std::exp( x ) ).epsilon( 1e-7 ) );
+    }
+}
+
+CASE( "kalman_imm: Behaves as the estimator with a single model" )
+{
+    kalman ref = make( 0.2 );
+    num::kalman_imm<kalman> imm( { 1 }, { 1 }, make( 0.2 ) );
+
+    for ( int k = 1; k <= 20; ++k )
+    {
+        ref.update( {0}, { measurement(k) } );
+        imm.update( {0}, { measurement(k) } );
+    }
+
+    EXPECT( identical( imm.system_state(), ref.system_state() ) );
+    EXPECT( identical( imm.estimation_error_covariance(), ref.estimation_error_covariance() ) );
+    EXPECT( imm.model_probabilities()(0) == 1 );
+    EXPECT( imm.time() == ref.time() );
+}
+
+CASE( "kalman_imm: Shifts the model probability to the manoeuvring model on a manoeuvre" )
+{
+    num::kalman_imm<kalman, kalman> imm( Pi, { 0.5, 0.5 }, make( 0.05 ), make( 2 ) );
+
+    double cruising = 0;
+    double manoeuvring = 0;
+
+    for ( int k = 1; k <= 40; ++k )
+    {
+        imm.update( {0}, { measurement(k) } );
+
+        if ( k == 29 ) cruising    = imm.model_probabilities()(1);
+        if ( k == 40 ) manoeuvring = imm.model_probabilities()(1);
+    }
+
+    EXPECT( cruising < 0.5 );
+    EXPECT( manoeuvring > 0.9 );
+    EXPECT( imm.model_probabilities()(0) + imm.model_probabilities()(1) == lest::approx( 1 ) );
+}
+
+CASE( "kalman_imm: Tracks a manoeuvre better than the cruising model alone" )
+{
+    kalman quiet = make( 0.05 );
+    num::kalman_imm<kalman, kalman> imm( Pi, { 0.5, 0.5 }, make( 0.05 ), make( 2 ) );
+
+    double error_quiet = 0;
+    double error_imm = 0;
+
+    for ( int k = 1; k <= 40; ++k )
+    {
+        quiet.update( {0}, { measurement(k) } );
+        imm  .update( {0}, { measurement(k) } );
+
+        if ( k > 30 )
+        {
+            error_quiet += std::abs( quiet.system_state()(0) - position(k) );
+            error_imm   += std::abs( imm  .system_state()(0) - position(k) );
+        }
+    }
+
+    EXPECT( error_imm < error_quiet / 2 );
+}
+
+CASE( "kalman_imm: Gives the same estimate with the models updated in parallel" )
+{
+    num::worker_pool pool( 2 );
+
+    using structured = num::kalman<double,2,1,1, num::structure<num::upper_triangular, num::dense, num::diagonal>>;
+
+    const structured fast( dt, A, B, H, Q( 2 ), R, 10 * Q( 1 ), { 0, 0 } );
+
+    num::kalman_imm<kalman, structured> seq( Pi, { 0.5, 0.5 }, make( 0.05 ), fast );
+    num::kalman_imm<kalman, structured> par( Pi, { 0.5, 0.5 }, make( 0.05 ), fast );
+
+    for ( int k = 1; k <= 40; ++k )
+    {
+        seq.update( {0}, { measurement(k) } );
+        par.update( {0}, { measurement(k) }, pool );
+    }
+
+    EXPECT( identical( par.system_state(), seq.system_state() ) );
+    EXPECT( identical( par.model_probabilities(), seq.model_probabilities() ) );
+    EXPECT( par.model<1>().time() == 40 );
+}
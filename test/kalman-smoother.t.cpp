@@ -0,0 +1,189 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "dsp/kalman-smoother.hpp"
+#include "lest.hpp"
+
+#include <cstdio>
+
+#define CASE( name ) lest_CASE( specification(), name )
+
+extern lest::tests & specification();
+
+namespace {
+
+using smoother = num::kalman_smoother<double,2,1,1>;
+using kalman   = smoother::kalman_t;
+
+// Constant velocity model, position measured with deterministic pseudo-noise:
+
+const double dt = 1;
+
+const kalman::A_t A = { 1, dt, 0, 1 };
+const kalman::B_t B = { 0, 0 };
+const kalman::H_t H = { 1, 0 };
+const kalman::R_t R = { 4 };
+const kalman::Q_t Q = { 0.01, 0.02, 0.02, 0.04 };
+const kalman::P_t P = { 10, 0, 0, 10 };
+
+const int steps = 100;
+
+double position( int step )
+{
+    return 5 + 0.5 * step;
+}
+
+double measurement( int step )
+{
+    return position( step ) + ( ( step * 37 ) % 11 - 5 ) * 0.6;
+}
+
+template< typename Smoother >
+void run( Smoother & s )
+{
+    for ( int k = 1; k <= steps; ++k )
+    {
+        if ( k % 10 == 0 ) s.predict( {0} );
+        else               s.update ( {0}, { measurement(k) } );
+    }
+}
+
+} // anonymous namespace
+
+CASE( "kalman_smoother: Records the filtered estimates of the estimator" )
+{
+    num::vector_store< num::kalman_moments<double,2> > store;
+
+    smoother s( store, dt, A, B, H, Q, R, P, { 0, 0 } );
+    kalman   ref( dt, A, B, H, Q, R, P, { 0, 0 } );
+
+    for ( int k = 1; k <= 5; ++k )
+    {
+        s  .update( {0}, { measurement(k) } );
+        ref.update( {0}, { measurement(k) } );
+
+        EXPECT( s.system_state( k - 1 )(0) == ref.system_state()(0) );
+        EXPECT( s.estimation_error_covariance( k - 1 )(0,0) == ref.estimation_error_covariance()(0,0) );
+    }
+
+    EXPECT( s.size() == 5u );
+}
+
+CASE( "kalman_smoother: Smooths as the full-matrix Rauch-Tung-Striebel recursion" )
+{
+    num::vector_store< num::kalman_moments<double,2> > store;
+
+    smoother s( store, dt, A, B, H, Q, R, P, { 0, 0 } );
+
+    run( s );
+
+    // Reference, full matrices:
+
+    std::vector<kalman::xhat_t> xp, xf;
+    std::vector<kalman::P_t>    Pp, Pf;
+
+    kalman estim( dt, A, B, H, Q, R, P, { 0, 0 } );
+
+    for ( int k = 1; k <= steps; ++k )
+    {
+        estim.predict( {0} );
+        xp.push_back( estim.system_state() );
+        Pp.push_back( estim.estimation_error_covariance() );
+
+        if ( k % 10 != 0 )
+        {
+            estim.correct( { measurement(k) } );
+        }
+        xf.push_back( estim.system_state() );
+        Pf.push_back( estim.estimation_error_covariance() );
+    }
+
+    auto xs = xf.back();
+    auto Ps = Pf.back();
+
+    EXPECT( s.system_state( steps - 1 )(0) == xs(0) );
+
+    for ( int k = steps - 1; k-- > 0; )
+    {
+        const auto C = Pf[k] * transposed( A ) * inverted( Pp[k + 1] );
+
+        xs = xf[k] + C * ( xs - xp[k + 1] );
+        Ps = Pf[k] + C * ( Ps - Pp[k + 1] ) * transposed( C );
+    }
+
+    s.smooth();
+
+    EXPECT( s.system_state( 0 )(0) == lest::approx( xs(0) ) );
+    EXPECT( s.system_state( 0 )(1) == lest::approx( xs(1) ) );
+    EXPECT( s.estimation_error_covariance( 0 )(0,0) == lest::approx( Ps(0,0) ) );
+    EXPECT( s.estimation_error_covariance( 0 )(0,1) == lest::approx( Ps(0,1) ) );
+    EXPECT( s.estimation_error_covariance( 0 )(1,1) == lest::approx( Ps(1,1) ) );
+}
+
+CASE( "kalman_smoother: Smoothed estimates are closer to the truth than filtered ones" )
+{
+    num::vector_store< num::kalman_moments<double,2> > store;
+
+    smoother s( store, dt, A, B, H, Q, R, P, { 0, 0 } );
+
+    run( s );
+
+    double filtered = 0;
+
+    for ( int k = 10; k < steps; ++k )
+    {
+        const double e = s.system_state( k )(0) - position( k + 1 );
+        filtered += e * e;
+    }
+
+    s.smooth();
+
+    double smoothed = 0;
+
+    for ( int k = 10; k < steps; ++k )
+    {
+        const double e = s.system_state( k )(0) - position( k + 1 );
+        smoothed += e * e;
+    }
+
+    EXPECT( smoothed < filtered );
+    EXPECT( s.estimation_error_covariance( steps / 2 )(0,0) < s.estimator().estimation_error_covariance()(0,0) );
+}
+
+#if KE_HAVE_MMAP
+
+CASE( "kalman_smoother: Allows to record into a memory-mapped file" )
+{
+    using record_t = num::kalman_moments<double,2>;
+
+    num::vector_store<record_t> vstore;
+
+    smoother ref( vstore, dt, A, B, H, Q, R, P, { 0, 0 } );
+
+    run( ref );
+    ref.smooth();
+
+    {
+        num::mapped_store<record_t> mstore( "kalman-smoother.t.tmp", 16 );
+
+        num::kalman_smoother<double,2,1,1, num::mapped_store<record_t>> s( mstore, dt, A, B, H, Q, R, P, { 0, 0 } );
+
+        run( s );
+        s.smooth();
+
+        EXPECT( s.size() == ref.size() );
+
+        for ( std::size_t k = 0; k < s.size(); ++k )
+        {
+            EXPECT( s.system_state( k )(0) == ref.system_state( k )(0) );
+        }
+    }
+
+    std::remove( "kalman-smoother.t.tmp" );
+}
+
+#endif // KE_HAVE_MMAP
@@ -0,0 +1,135 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "dsp/kalman.hpp"
+#include "kalman-fixture.hpp"
+#include "lest.hpp"
+
+#include <type_traits>
+
+#define CASE( name ) lest_CASE( specification(), name )
+
+extern lest::tests & specification();
+
+namespace {
+
+using namespace fixture;
+
+// Clock that advances one tick per reading:
+
+struct counting_clock
+{
+    static unsigned long count;
+
+    static unsigned long now() { return ++count; }
+};
+
+unsigned long counting_clock::count = 0;
+
+using recorded = num::kalman<double,2,1,1, num::dense_structure, num::ring_telemetry<4>>;
+using timed    = num::kalman<double,2,1,1, num::dense_structure, num::ring_telemetry<4, counting_clock>>;
+
+} // anonymous namespace
+
+CASE( "kalman telemetry: Takes no space when disabled (default)" )
+{
+    EXPECT( ( std::is_empty< num::no_telemetry::recorder<double,1> >::value ) );
+    EXPECT( sizeof( kalman ) < sizeof( recorded ) );
+}
+
+CASE( "kalman telemetry: Computes the same estimate with telemetry" )
+{
+    kalman   ref  ( dt, A, B, H, Q, R, Q, { 0, 0 } );
+    recorded estim( dt, A, B, H, Q, R, Q, { 0, 0 } );
+
+    for ( int i = 1; i <= 10; ++i )
+    {
+        ref  .update( {1}, { measurement(i) } );
+        estim.update( {1}, { measurement(i) } );
+    }
+
+    EXPECT( identical( estim.system_state(), ref.system_state() ) );
+    EXPECT( identical( estim.estimation_error_covariance(), ref.estimation_error_covariance() ) );
+}
+
+CASE( "kalman telemetry: Records innovation and normalized innovation squared per time-step" )
+{
+    recorded estim( dt, A, B, H, Q, R, Q, { 0, 0 } );
+
+    estim.predict( {1} );
+
+    const double y = estim.innovation( { 4 } )(0);
+    const double S = estim.innovation_covariance()(0,0);
+
+    estim.correct( { 4 } );
+
+    auto const & t = estim.telemetry();
+
+    EXPECT( t.size() == 1 );
+    EXPECT( t.latest().innovation(0) == y );
+    EXPECT( t.latest().nis == lest::approx( y * y / S ) );
+    EXPECT( t.latest().accepted );
+    EXPECT_NOT( t.latest().gain_fixed );
+}
+
+CASE( "kalman telemetry: Records the gain mode and rejected measurements" )
+{
+    recorded estim( dt, A, B, H, Q, R, Q, { 0, 0 } );
+
+    estim.gate( num::chi_square_quantile( 1, 0.99 ) );
+
+    estim.update( {1}, { measurement(1) } );
+    estim.fix_gain();
+    estim.update( {1}, { 1000 } );
+
+    auto const & t = estim.telemetry();
+
+    EXPECT( t.size() == 2 );
+    EXPECT(     t[0].accepted );
+    EXPECT_NOT( t[0].gain_fixed );
+    EXPECT_NOT( t[1].accepted );
+    EXPECT(     t[1].gain_fixed );
+    EXPECT( t[1].nis > num::chi_square_quantile( 1, 0.99 ) );
+}
+
+CASE( "kalman telemetry: Retains the last time-steps in a ring buffer" )
+{
+    recorded estim( dt, A, B, H, Q, R, Q, { 0, 0 } );
+
+    double y[10] = {};
+
+    for ( int i = 0; i < 10; ++i )
+    {
+        estim.predict( {1} );
+        y[i] = estim.innovation( { measurement(i) } )(0);
+        estim.correct( { measurement(i) } );
+    }
+
+    auto const & t = estim.telemetry();
+
+    EXPECT( t.capacity() == 4 );
+    EXPECT( t.recorded() == 10 );
+    EXPECT( t.size() == 4 );
+
+    for ( int i = 0; i < 4; ++i )
+    {
+        EXPECT( t[i].innovation(0) == y[ 6 + i ] );
+    }
+}
+
+CASE( "kalman telemetry: Records the ticks of predict, gain computation and correction" )
+{
+    timed estim( dt, A, B, H, Q, R, Q, { 0, 0 } );
+
+    estim.update( {1}, { 1 } );
+
+    auto const & e = estim.telemetry().latest();
+
+    EXPECT( e.predict == 1u );
+    EXPECT( e.gain    == 1u );
+    EXPECT( e.correct == 1u );
+}
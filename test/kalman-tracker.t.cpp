@@ -0,0 +1,192 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "dsp/kalman-tracker.hpp"
+#include "lest.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#define CASE( name ) lest_CASE( specification(), name )
+
+extern lest::tests & specification();
+
+namespace {
+
+// Random walk in the plane, position measured, innovation covariance
+// S = P + R = I after a prediction of a new track:
+
+using tracker = num::kalman_tracker<double,2,2,0>;
+
+const tracker::A_t A = { 1, 0, 0, 1 };
+const tracker::H_t H = { 1, 0, 0, 1 };
+const tracker::Q_t Q = { 0, 0, 0, 0 };
+const tracker::R_t R = { 0.5, 0, 0, 0.5 };
+const tracker::P_t P = { 0.5, 0, 0, 0.5 };
+
+tracker make_tracker( double gate, double cell, int confirm = 3, int coast = 5 )
+{
+    return tracker( 1, A, {}, H, Q, R, P, gate, cell, confirm, coast );
+}
+
+// Constant velocity in the plane, (x, vx, y, vy), position measured:
+
+using cv_tracker = num::kalman_tracker<double,4,2,0>;
+
+cv_tracker make_cv_tracker( double cell )
+{
+    const double dt = 1;
+
+    const cv_tracker::A_t A = { 1, dt, 0, 0,  0, 1, 0, 0,  0, 0, 1, dt,  0, 0, 0, 1 };
+    const cv_tracker::H_t H = { 1, 0, 0, 0,  0, 0, 1, 0 };
+    const cv_tracker::R_t R = { 0.01, 0, 0, 0.01 };
+    const cv_tracker::Q_t Q = 0.001 * cv_tracker::Q_t( { dt*dt*dt/3, dt*dt/2, 0, 0,  dt*dt/2, dt, 0, 0,  0, 0, dt*dt*dt/3, dt*dt/2,  0, 0, dt*dt/2, dt } );
+    const cv_tracker::P_t P = { 0.01, 0, 0, 0,  0, 1, 0, 0,  0, 0, 0.01, 0,  0, 0, 0, 1 };
+
+    return cv_tracker( dt, A, {}, H, Q, R, P, num::chi_square_quantile( 2, 0.999 ), cell );
+}
+
+template< typename Matrix >
+bool identical( Matrix const & a, Matrix const & b )
+{
+    return std20::equal( a.begin(), a.end(), b.begin() );
+}
+
+// Uniform pseudo-random value in [0, 1):
+
+double uniform( std::uint32_t & seed )
+{
+    seed = seed * 1664525u + 1013904223u;
+    return ( seed >> 8 ) / double( 1u << 24 );
+}
+
+CASE( "kalman-tracker: Hungarian solver finds the assignment of least total cost" "[kalman-tracker]" )
+{
+    const std::vector<double> cost =
+    {
+        4, 1, 3,
+        2, 0, 5,
+        3, 2, 2,
+    };
+
+    const auto col = num::hungarian_assignment( cost, 3 );
+
+    EXPECT( col[0] == 1 );
+    EXPECT( col[1] == 0 );
+    EXPECT( col[2] == 2 );
+}
+
+CASE( "kalman-tracker: Starts a tentative track per detection and confirms it after a number of hits" "[kalman-tracker]" )
+{
+    auto trk = make_tracker( 9, 1, 3 );
+
+    trk.update( {}, { { 0, 0 }, { 10, 10 } } );
+
+    EXPECT( trk.track_count() == 2 );
+    EXPECT( trk.confirmed_count() == 0 );
+
+    trk.update( {}, { { 10.1, 10 }, { 0.1, 0 } } );
+    trk.update( {}, { { 0.2, 0 }, { 10.2, 10 } } );
+
+    EXPECT( trk.track_count() == 2 );
+    EXPECT( trk.confirmed_count() == 2 );
+    EXPECT( trk.tracks()[0].id == 0 );
+    EXPECT( trk.tracks()[0].estim.system_state()(0) < 1 );
+    EXPECT( trk.tracks()[1].estim.system_state()(0) > 9 );
+}
+
+CASE( "kalman-tracker: Assigns by global rather than greedy nearest neighbour" "[kalman-tracker]" )
+{
+    // Tracks at 0 and 1.5, gate half-width 2; the greedy pair (1.5, 1.0)
+    // would leave detection 2.6 unassigned:
+
+    auto trk = make_tracker( 4, 1 );
+
+    trk.update( {}, { { 0, 0 }, { 1.5, 0 } } );
+    trk.update( {}, { { 1.0, 0 }, { 2.6, 0 } } );
+
+    EXPECT( trk.track_count() == 2 );
+    EXPECT( trk.tracks()[0].hits == 2 );
+    EXPECT( trk.tracks()[1].hits == 2 );
+    EXPECT( trk.tracks()[0].estim.system_state()(0) < trk.tracks()[1].estim.system_state()(0) );
+}
+
+CASE( "kalman-tracker: Deletes a tentative track after a miss, a confirmed track after coasting" "[kalman-tracker]" )
+{
+    auto trk = make_tracker( 9, 1, 2, 3 );
+
+    trk.update( {}, { { 0, 0 } } );
+    trk.update( {}, { { 0, 0 }, { 50, 50 } } );
+
+    EXPECT( trk.track_count() == 2 );
+    EXPECT( trk.confirmed_count() == 1 );
+
+    trk.update( {}, {} );
+
+    EXPECT( trk.track_count() == 1 );
+
+    trk.update( {}, {} );
+
+    EXPECT( trk.track_count() == 1 );
+
+    trk.update( {}, {} );
+
+    EXPECT( trk.track_count() == 0 );
+}
+
+CASE( "kalman-tracker: Follows many crossing objects, independent of the grid cell size" "[kalman-tracker]" )
+{
+    const int objects = 200;
+
+    std::uint32_t seed = 42;
+
+    std::vector<double> x, y, vx, vy;
+
+    for ( int i = 0; i < objects; ++i )
+    {
+        x .push_back( 20 * uniform( seed ) );
+        y .push_back( 20 * uniform( seed ) );
+        vx.push_back( uniform( seed ) - 0.5 );
+        vy.push_back( uniform( seed ) - 0.5 );
+    }
+
+    auto fine   = make_cv_tracker( 0.5 );
+    auto coarse = make_cv_tracker( 1e6 );
+
+    for ( int k = 0; k < 20; ++k )
+    {
+        std::vector<cv_tracker::z_t> detections;
+
+        for ( int i = 0; i < objects; ++i )
+        {
+            detections.push_back( { x[i] + 0.1 * ( uniform( seed ) - 0.5 ), y[i] + 0.1 * ( uniform( seed ) - 0.5 ) } );
+
+            x[i] += vx[i];
+            y[i] += vy[i];
+        }
+
+        fine  .update( {}, detections );
+        coarse.update( {}, detections );
+    }
+
+    EXPECT( fine.confirmed_count() == objects );
+    EXPECT( fine.gated_count() == coarse.gated_count() );
+    EXPECT( fine.track_count() == coarse.track_count() );
+
+    bool same = true;
+
+    for ( int i = 0; i < fine.track_count(); ++i )
+    {
+        same = same
+            && fine.tracks()[i].id == coarse.tracks()[i].id
+            && identical( fine.tracks()[i].estim.system_state(), coarse.tracks()[i].estim.system_state() );
+    }
+
+    EXPECT( same );
+}
+
+} // anonymous namespace
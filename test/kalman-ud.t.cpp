@@ -0,0 +1,164 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "num/fixed-point.hpp"
+#include "dsp/kalman-ud.hpp"
+#include "kalman-fixture.hpp"
+#include "lest.hpp"
+
+#include <cstdint>
+
+#define CASE( name ) lest_CASE( specification(), name )
+
+extern lest::tests & specification();
+
+namespace {
+
+using namespace fixture;
+
+using kalman_ud = num::kalman_ud<double,2,1,1>;
+
+} // anonymous namespace
+
+CASE( "kalman_ud: Allows to construct an estimator from model, initial covariance and state" )
+{
+    const kalman::P_t P = { 4, 1, 1, 2 };
+
+    kalman_ud estim( dt, A, B, H, Q, R, P, { 3, 4 } );
+
+    EXPECT( estim.time() == 0 );
+    EXPECT( estim.system_state()(0) == 3 );
+    EXPECT( estim.system_state()(1) == 4 );
+    EXPECT( approx_equal( estim.estimation_error_covariance(), P ) );
+    EXPECT( estim.covariance_factor_u()(1,0) == 0 );
+    EXPECT( estim.covariance_factor_u()(0,0) == 1 );
+    EXPECT( estim.covariance_factor_u()(1,1) == 1 );
+    EXPECT_NOT( estim.is_gain_fixed() );
+}
+
+CASE( "kalman_ud: Computes the same estimate as kalman, one measurement" )
+{
+    kalman    ref  ( dt, A, B, H, Q, R, Q, { 0, 0 } );
+    kalman_ud estim( dt, A, B, H, Q, R, Q, { 0, 0 } );
+
+    for ( int i = 0; i < 50; ++i )
+    {
+        ref  .update( {1}, { measurement(i + 1) } );
+        estim.update( {1}, { measurement(i + 1) } );
+    }
+
+    EXPECT( estim.time() == ref.time() );
+    EXPECT( approx_equal( estim.system_state(), ref.system_state() ) );
+    EXPECT( approx_equal( estim.kalman_gain(), ref.kalman_gain() ) );
+    EXPECT( approx_equal( estim.estimation_error_covariance(), ref.estimation_error_covariance() ) );
+}
+
+CASE( "kalman_ud: Computes the same estimate as kalman, two measurements with diagonal noise covariance" )
+{
+    using kalman    = num::kalman   <double,2,2,1>;
+    using kalman_ud = num::kalman_ud<double,2,2,1>;
+
+    const kalman::H_t H = { 1, 0, 0, 1 };
+    const kalman::R_t R = { 100, 0, 0, 4 };
+
+    kalman    ref  ( dt, A, B, H, Q, R, Q, { 0, 0 } );
+    kalman_ud estim( dt, A, B, H, Q, R, Q, { 0, 0 } );
+
+    for ( int i = 0; i < 50; ++i )
+    {
+        ref  .update( {1}, { measurement(i + 1), i + 1.5 } );
+        estim.update( {1}, { measurement(i + 1), i + 1.5 } );
+    }
+
+    EXPECT( approx_equal( estim.system_state(), ref.system_state() ) );
+    EXPECT( approx_equal( estim.estimation_error_covariance(), ref.estimation_error_covariance() ) );
+}
+
+CASE( "kalman_ud: Allows to fix the Kalman gain" )
+{
+    kalman_ud estim( dt, A, B, H, Q, R, Q, { 0, 0 } );
+
+    estim.update( {1}, { measurement(1) } );
+    estim.fix_gain();
+
+    const auto K = estim.kalman_gain();
+    const auto P = estim.estimation_error_covariance();
+
+    estim.update( {1}, { measurement(2) } );
+
+    EXPECT( estim.is_gain_fixed() );
+    EXPECT( identical( estim.kalman_gain(), K ) );
+    EXPECT( identical( estim.estimation_error_covariance(), P ) );
+}
+
+CASE( "kalman_ud: Remains stable with a 16-bit fixed_point numeric type" )
+{
+    using fp16_t    = num::fixed_point<std::int16_t, 4>;
+    using kalman_ud = num::kalman_ud<fp16_t,2,1,1>;
+
+    // Slowly moving object measured precisely, starting with a large uncertainty:
+
+    const fp16_t dt = 1.0 / 16;
+
+    kalman_ud estim( dt, {1, dt, 0, 1}, {0, 0}, {1, 0}, {0, 0, 0, 0.004}, {0.0025}, {4, 0, 0, 4}, {0, 0} );
+
+    for ( int i = 0; i < 200; ++i )
+    {
+        const double position = 1 + 0.01 * i;
+
+        estim.update( {0}, { position + ( i % 2 ? 0.04 : -0.04 ) } );
+
+        EXPECT( estim.covariance_factor_d()(0) >= 0 );
+        EXPECT( estim.covariance_factor_d()(1) >= 0 );
+    }
+
+    EXPECT( estim.system_state()(0).as_double() == lest::approx( 1 + 0.01 * 199 ).epsilon( 0.02 ) );
+    EXPECT( estim.system_state()(1).as_double() == lest::approx( 0.01 * 16 ).epsilon( 0.2 ) );
+}
+
+CASE( "kalman_ud: Accepts zero measurement noise with a fixed_point numeric type" )
+{
+    using fp32_t    = num::fixed_point<std::int32_t, 15>;
+    using kalman_ud = num::kalman_ud<fp32_t,2,1,1>;
+    using kalman    = num::kalman<fp32_t,2,1,1>;
+
+    kalman_ud estim( 1, {1, 1, 0, 1}, {0.5, 1}, {1, 0}, {0, 0, 0, 0.01}, {0}, {1, 0, 0, 1}, {0, 0} );
+    kalman    ref  ( 1, {1, 1, 0, 1}, {0.5, 1}, {1, 0}, {0, 0, 0, 0.01}, {0}, {1, 0, 0, 1}, {0, 0} );
+
+    estim.update( {0}, { 1 } );
+    ref  .update( {0}, { 1 } );
+
+    EXPECT( estim.system_state()(0).as_double() == lest::approx( 1 ) );
+    EXPECT( estim.system_state()(0).as_double() == lest::approx( ref.system_state()(0).as_double() ) );
+    EXPECT( estim.system_state()(1).as_double() == lest::approx( ref.system_state()(1).as_double() ).epsilon( 1e-3 ) );
+}
+
+CASE( "kalman_ud: Allows to predict and correct separately, update() is their composition" )
+{
+    kalman_ud estim( dt, A, B, H, Q, R, Q, { 0, 0 } );
+    kalman_ud ref  ( dt, A, B, H, Q, R, Q, { 0, 0 } );
+
+    for ( int i = 0; i < 20; ++i )
+    {
+        estim.predict( {1} );
+
+        if ( i % 3 == 0 )
+        {
+            ref.predict( {1} );
+            ref.correct( { measurement(i + 1) } );
+            estim.correct( { measurement(i + 1) } );
+        }
+        else
+        {
+            ref.predict( {1} );
+        }
+    }
+
+    EXPECT( estim.time() == ref.time() );
+    EXPECT( identical( estim.system_state(), ref.system_state() ) );
+    EXPECT( identical( estim.estimation_error_covariance(), ref.estimation_error_covariance() ) );
+}
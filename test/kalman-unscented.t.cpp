@@ -0,0 +1,170 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "dsp/kalman-unscented.hpp"
+#include "kalman-fixture.hpp"
+#include "lest.hpp"
+
+#include <cmath>
+
+#define CASE( name ) lest_CASE( specification(), name )
+
+extern lest::tests & specification();
+
+namespace {
+
+using namespace fixture;
+
+// Constant acceleration model of the fixture, as batched functions:
+
+struct linear_process
+{
+    num::matrix<double,2,5> operator()( num::matrix<double,2,5> const & X, num::colvec<double,1> const & u ) const
+    {
+        num::matrix<double,2,5> Y = A * X;
+
+        for ( int i = 0; i < 5; ++i )
+        {
+            Y(0,i) += B(0,0) * u(0);
+            Y(1,i) += B(1,0) * u(0);
+        }
+        return Y;
+    }
+};
+
+struct linear_measure
+{
+    num::matrix<double,1,5> operator()( num::matrix<double,2,5> const & X ) const
+    {
+        return H * X;
+    }
+};
+
+// Hardening spring, x'' = -k x - k3 x^3, Euler-integrated, with a
+// measurement of position that saturates, x - c x^3, per sigma point:
+
+struct spring
+{
+    double dt, k, k3;
+
+    num::colvec<double,2> operator()( num::colvec<double,2> const & x, num::colvec<double,1> const & ) const
+    {
+        return { x(0) + dt * x(1), x(1) - dt * ( k * x(0) + k3 * x(0) * x(0) * x(0) ) };
+    }
+};
+
+struct saturating_sensor
+{
+    double c;
+
+    num::colvec<double,1> operator()( num::colvec<double,2> const & x ) const
+    {
+        return { x(0) - c * x(0) * x(0) * x(0) };
+    }
+};
+
+// Deterministic measurement noise in [-1,1]:
+
+double noise( int step )
+{
+    return ( ( step * 7919 ) % 201 - 100 ) / 100.0;
+}
+
+} // anonymous namespace
+
+CASE( "kalman_unscented: Allows to construct an estimator from models, initial covariance and state" )
+{
+    using ukf = num::kalman_unscented<double,2,1,1,linear_process,linear_measure>;
+
+    const kalman::P_t P = { 4, 1, 1, 2 };
+
+    ukf estim( dt, {}, {}, Q, R, P, { 3, 4 } );
+
+    EXPECT( estim.time() == 0 );
+    EXPECT( estim.system_state()(0) == 3 );
+    EXPECT( estim.system_state()(1) == 4 );
+    EXPECT( approx_equal( estim.estimation_error_covariance(), P ) );
+}
+
+CASE( "kalman_unscented: Places sigma points with the mean and covariance of the estimate" )
+{
+    using ukf = num::kalman_unscented<double,2,1,1,linear_process,linear_measure>;
+
+    const kalman::P_t P = { 4, 1, 1, 2 };
+
+    ukf estim( dt, {}, {}, Q, R, P, { 3, 4 } );
+
+    const auto X = estim.sigma_points();
+
+    // alpha = 1, kappa = 0: equal weights 1/(2S) of the outer points:
+
+    num::colvec<double,2> mean(0);
+    num::matrix<double,2,2> cov(0);
+
+    for ( int i = 1; i < 5; ++i )
+    {
+        mean = mean + 0.25 * column( X, i );
+    }
+
+    for ( int i = 1; i < 5; ++i )
+    {
+        const auto d = column( X, i ) - mean;
+        cov = cov + 0.25 * d * transposed( d );
+    }
+
+    EXPECT( approx_equal( column( X, 0 ), estim.system_state() ) );
+    EXPECT( approx_equal( mean, estim.system_state() ) );
+    EXPECT( approx_equal( cov, P ) );
+}
+
+CASE( "kalman_unscented: Computes the same estimate as kalman for a linear model" )
+{
+    using ukf = num::kalman_unscented<double,2,1,1,linear_process,linear_measure>;
+
+    const kalman::P_t P = { 10, 0, 0, 10 };
+
+    kalman ref  ( dt, A, B, H, Q, R, P, { 0, 0 } );
+    ukf    estim( dt, {}, {}, Q, R, P, { 0, 0 } );
+
+    for ( int step = 0; step < 30; ++step )
+    {
+        ref  .update( { 1 }, { measurement( step ) } );
+        estim.update( { 1 }, { measurement( step ) } );
+    }
+
+    EXPECT( approx_equal( estim.system_state(), ref.system_state(), 1e-6 ) );
+    EXPECT( approx_equal( estim.kalman_gain(), ref.kalman_gain(), 1e-6 ) );
+    EXPECT( approx_equal( estim.estimation_error_covariance(), ref.estimation_error_covariance(), 1e-6 ) );
+}
+
+CASE( "kalman_unscented: Tracks a nonlinear system through a nonlinear measurement" )
+{
+    using process = num::pointwise<spring>;
+    using measure = num::pointwise<saturating_sensor>;
+    using ukf     = num::kalman_unscented<double,2,1,1,process,measure>;
+
+    const spring            f = { 0.01, 4, 2 };
+    const saturating_sensor h = { 0.1 };
+
+    const ukf::Q_t Qs = { 1e-8, 0, 0, 1e-6 };
+    const ukf::R_t Rs = { 1e-4 };
+    const ukf::P_t Ps = { 1, 0, 0, 1 };
+
+    ukf estim( f.dt, { f }, { h }, Qs, Rs, Ps, { 0, 0 } );
+
+    num::colvec<double,2> x = { 1, 0 };
+
+    for ( int step = 0; step < 1000; ++step )
+    {
+        x = f( x, { 0 } );
+        estim.update( { 0 }, { h( x )(0) + 0.01 * noise( step ) } );
+    }
+
+    EXPECT( std::abs( estim.system_state()(0) - x(0) ) < 0.01 );
+    EXPECT( std::abs( estim.system_state()(1) - x(1) ) < 0.05 );
+    EXPECT( estim.estimation_error_covariance()(0,0) < 1e-4 );
+}
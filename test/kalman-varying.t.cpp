@@ -0,0 +1,144 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "dsp/kalman-varying.hpp"
+#include "kalman-fixture.hpp"
+#include "lest.hpp"
+
+#define CASE( name ) lest_CASE( specification(), name )
+
+extern lest::tests & specification();
+
+namespace {
+
+using namespace fixture;
+
+// Constant acceleration model of kalman-sim.e.cpp, as function of dt,
+// counting the generated matrices:
+
+struct discretize
+{
+    static int calls;
+
+    kalman::A_t A( double dt ) const
+    {
+        ++calls;
+        return { 1, dt, 0, 1 };
+    }
+
+    kalman::B_t B( double dt ) const
+    {
+        return { dt * dt / 2, dt };
+    }
+
+    kalman::Q_t Q( double dt ) const
+    {
+        return accelnoise * accelnoise * kalman::Q_t( { dt*dt*dt*dt/4, dt*dt*dt/2, dt*dt*dt/2, dt*dt } );
+    }
+};
+
+int discretize::calls = 0;
+
+using varying = num::kalman_varying<kalman, discretize, 3>;
+using cache   = num::discretization_cache<kalman, discretize, 2>;
+
+} // anonymous namespace
+
+CASE( "kalman_varying: Behaves as the estimator for a constant time-step" )
+{
+    const double dt = 0.5;
+    const discretize d;
+
+    kalman  ref  ( dt, d.A( dt ), d.B( dt ), H, d.Q( dt ), R, d.Q( dt ), { 0, 0 } );
+    varying estim( d, 0.125, dt, H, R, d.Q( dt ), { 0, 0 } );
+
+    for ( int i = 1; i <= 20; ++i )
+    {
+        ref  .update(     {1}, { measurement(i) } );
+        estim.update( dt, {1}, { measurement(i) } );
+    }
+
+    EXPECT( identical( estim.system_state(), ref.system_state() ) );
+    EXPECT( identical( estim.estimation_error_covariance(), ref.estimation_error_covariance() ) );
+    EXPECT( estim.time() == ref.time() );
+    EXPECT( estim.discretization().misses() == 1 );
+    EXPECT( estim.discretization().hits() == 19 );
+}
+
+CASE( "kalman_varying: Uses the system dynamics of each time-step" )
+{
+    const double dts[] = { 0.5, 1, 0.25, 1, 0.5 };
+    const discretize d;
+
+    kalman  ref  ( 1, d.A( 1 ), d.B( 1 ), H, d.Q( 1 ), R, d.Q( 1 ), { 0, 0 } );
+    varying estim( d, 0.125, 1, H, R, d.Q( 1 ), { 0, 0 } );
+
+    double t = 0;
+
+    for ( int i = 0; i < 5; ++i )
+    {
+        const double dt = dts[i];
+        t += dt;
+
+        ref.predict( dt, d.A( dt ), d.B( dt ), kalman::Psym_t( d.Q( dt ) ), {1} );
+        ref.correct( { measurement(i) } );
+
+        estim.update( dt, {1}, { measurement(i) } );
+    }
+
+    EXPECT( identical( estim.system_state(), ref.system_state() ) );
+    EXPECT( identical( estim.estimation_error_covariance(), ref.estimation_error_covariance() ) );
+    EXPECT( estim.time() == t );
+    EXPECT( estim.discretization().misses() == 3 );
+}
+
+CASE( "kalman_varying: Keeps the nominal time-step for update without time-step" )
+{
+    const double dt = 0.5;
+    const discretize d;
+
+    kalman  ref  ( dt, d.A( dt ), d.B( dt ), H, d.Q( dt ), R, d.Q( dt ), { 0, 0 } );
+    varying estim( d, 0.125, dt, H, R, d.Q( dt ), { 0, 0 } );
+
+    ref  .update( {1}, { 3 } );
+    estim.update( {1}, { 3 } );
+
+    EXPECT( identical( estim.system_state(), ref.system_state() ) );
+    EXPECT( estim.discretization().misses() == 0 );
+}
+
+CASE( "discretization_cache: Reuses the matrices for a time-step that jitters within half a quantum" )
+{
+    cache c( discretize(), 0.001 );
+
+    discretize::calls = 0;
+
+    EXPECT( c( 0.0100 ).dt == 0.010 );
+    EXPECT( c( 0.0104 ).dt == 0.010 );
+    EXPECT( c( 0.0097 ).dt == 0.010 );
+    EXPECT( c( 0.0106 ).dt == 0.011 );
+
+    EXPECT( discretize::calls == 2 );
+    EXPECT( c.hits()   == 2 );
+    EXPECT( c.misses() == 2 );
+}
+
+CASE( "discretization_cache: Replaces the least recently used time-step" )
+{
+    cache c( discretize(), 0.5 );
+
+    c( 1 ); c( 2 ); c( 1 ); c( 3 );     // replaces 2
+
+    discretize::calls = 0;
+
+    EXPECT( c( 1 ).A(0,1) == 1 );
+    EXPECT( c( 3 ).A(0,1) == 3 );
+    EXPECT( discretize::calls == 0 );
+
+    EXPECT( c( 2 ).A(0,1) == 2 );
+    EXPECT( discretize::calls == 1 );
+}
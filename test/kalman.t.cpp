@@ -0,0 +1,498 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "num/fixed-point.hpp"
+#include "dsp/kalman.hpp"
+#include "kalman-fixture.hpp"
+#include "lest.hpp"
+
+#define CASE( name ) lest_CASE( specification(), name )
+
+extern lest::tests & specification();
+
+namespace {
+
+using namespace fixture;
+
+// Estimated positions of the first N updates, e.g. computed at compile time:
+
+template< int N >
+constexpr num::colvec<double,N> trajectory()
+{
+    auto estim = make_kalman();
+
+    num::colvec<double,N> result( 0 );
+
+    for ( int k = 0; k < N; ++k )
+    {
+        estim.update( {1}, { measurement( k + 1 ) } );
+        result(k) = estim.system_state()(0);
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+CASE( "kalman: Allows to construct an estimator from model, initial covariance and state" )
+{
+    kalman estim( dt, A, B, H, Q, R, Q, { 3, 4 } );
+
+    EXPECT( estim.time() == 0 );
+    EXPECT( estim.system_state()(0) == 3 );
+    EXPECT( estim.system_state()(1) == 4 );
+    EXPECT( identical( estim.estimation_error_covariance(), Q ) );
+    EXPECT( identical( estim.kalman_gain(), kalman::K_t(0) ) );
+    EXPECT_NOT( estim.is_gain_fixed() );
+}
+
+CASE( "kalman: Allows to update the estimate with control input and measurement" )
+{
+    kalman estim = make_kalman();
+
+    for ( int i = 0; i < 50; ++i )
+    {
+        estim.update( {1}, { measurement(i + 1) } );
+    }
+
+    EXPECT( estim.time() == 50 * dt );
+    EXPECT( estim.system_state()(0) == lest::approx( 0.5 * 50 * 50 ).epsilon( 0.05 ) );
+    EXPECT( estim.system_state()(1) == lest::approx( 50 ).epsilon( 0.1 ) );
+}
+
+CASE( "kalman: Allows to fix the Kalman gain" )
+{
+    kalman estim = make_kalman();
+
+    estim.update( {1}, { measurement(1) } );
+    estim.fix_gain();
+
+    const auto K = estim.kalman_gain();
+    const auto P = estim.estimation_error_covariance();
+
+    estim.update( {1}, { measurement(2) } );
+
+    EXPECT( estim.is_gain_fixed() );
+    EXPECT( identical( estim.kalman_gain(), K ) );
+    EXPECT( identical( estim.estimation_error_covariance(), P ) );
+}
+
+CASE( "kalman: Allows to resume updating the Kalman gain" )
+{
+    kalman estim = make_kalman();
+
+    estim.update( {1}, { measurement(1) } );
+    estim.fix_gain();
+    estim.update_gain();
+
+    const auto K = estim.kalman_gain();
+
+    estim.update( {1}, { measurement(2) } );
+
+    EXPECT_NOT( estim.is_gain_fixed() );
+    EXPECT_NOT( identical( estim.kalman_gain(), K ) );
+}
+
+CASE( "kalman: Allows to fix the Kalman gain automatically once it has stabilized" )
+{
+    kalman estim = make_kalman();
+    kalman ref   = make_kalman();
+
+    estim.auto_fix_gain( 0.001, 3 );
+
+    int fixed_at = 0;
+
+    for ( int i = 0; i < 100; ++i )
+    {
+        estim.update( {1}, { measurement(i + 1) } );
+        ref  .update( {1}, { measurement(i + 1) } );
+
+        if ( !fixed_at && estim.is_gain_fixed() )
+        {
+            fixed_at = i + 1;
+        }
+    }
+
+    EXPECT( fixed_at > 3 );
+    EXPECT( fixed_at < 100 );
+    EXPECT( estim.kalman_gain()(0) == lest::approx( ref.kalman_gain()(0) ).epsilon( 0.01 ) );
+    EXPECT( estim.kalman_gain()(1) == lest::approx( ref.kalman_gain()(1) ).epsilon( 0.01 ) );
+    EXPECT( estim.system_state()(0) == lest::approx( ref.system_state()(0) ).epsilon( 0.001 ) );
+}
+
+CASE( "kalman: Does not fix the Kalman gain automatically by default" )
+{
+    kalman estim = make_kalman();
+
+    for ( int i = 0; i < 100; ++i )
+    {
+        estim.update( {1}, { measurement(i + 1) } );
+    }
+
+    EXPECT_NOT( estim.is_gain_fixed() );
+}
+
+CASE( "kalman: Resumes updating the Kalman gain when a noise covariance changes" )
+{
+    kalman estim = make_kalman();
+
+    estim.fix_gain();
+    estim.set_measurement_noise_covariance( { 4 * measnoise * measnoise } );
+
+    EXPECT_NOT( estim.is_gain_fixed() );
+
+    estim.fix_gain();
+    estim.set_process_noise_covariance( 2 * Q );
+
+    EXPECT_NOT( estim.is_gain_fixed() );
+}
+
+CASE( "kalman: Allows to use a fixed_point numeric type" )
+{
+    using fp32_t = num::fixed_point<int, 15>;
+    using kalman = num::kalman<fp32_t,2,1,1>;
+
+    const fp32_t dt = 1;
+
+    kalman estim( dt, {1, dt, 0, 1}, {dt * dt / 2, dt}, {1, 0}, {0.01, 0.02, 0.02, 0.04}, {100}, {0.01, 0.02, 0.02, 0.04}, {0, 0} );
+
+    for ( int i = 0; i < 20; ++i )
+    {
+        estim.update( {1}, { measurement(i + 1) } );
+    }
+
+    EXPECT( estim.system_state()(0).as_double() == lest::approx( 0.5 * 20 * 20 ).epsilon( 0.1 ) );
+}
+
+CASE( "kalman: Allows to use a wider covariance than state numeric type" )
+{
+    using mixed = num::kalman<num::mixed_precision<double, float>,2,1,1>;
+
+    auto reference = make_kalman();
+
+    mixed estim( dt, A, B, H, Q, R, Q, { 0, 0 } );
+
+    for ( int k = 1; k <= 50; ++k )
+    {
+        reference.update( {1}, { measurement( k ) } );
+        estim.update( {1}, { float( measurement( k ) ) } );
+    }
+
+    EXPECT( estim.system_state()(0) == lest::approx( reference.system_state()(0) ).epsilon( 1e-5 ) );
+    EXPECT( estim.system_state()(1) == lest::approx( reference.system_state()(1) ).epsilon( 1e-5 ) );
+}
+
+CASE( "kalman: Allows to use a 32-bit fixed_point covariance with a 16-bit fixed_point state" )
+{
+    using fp32_t = num::fixed_point<std::int32_t, 15>;
+    using fp16_t = num::fixed_point<std::int16_t, 10>;
+    using mixed  = num::kalman<num::mixed_precision<fp32_t, fp16_t>,2,1,1>;
+
+    const fp32_t dt = 1;
+
+    auto reference = make_kalman();
+
+    mixed estim( dt, {1, dt, 0, 1}, {dt * dt / 2, dt}, {1, 0}, {0.01, 0.02, 0.02, 0.04}, {100}, {0.01, 0.02, 0.02, 0.04}, {0, 0} );
+
+    for ( int k = 1; k <= 20; ++k )
+    {
+        reference.update( {1}, { measurement( k ) } );
+        estim.update( {1}, { fp16_t( measurement( k ) ) } );
+    }
+
+    EXPECT( estim.system_state()(0).as_double() == lest::approx( reference.system_state()(0) ).epsilon( 0.01 ) );
+}
+
+CASE( "kalman: Allows to construct an estimator in steady state" )
+{
+    kalman estim( kalman::steady_state, dt, A, B, H, Q, R, { 0, 0 } );
+    kalman ref = make_kalman();
+
+    for ( int i = 0; i < 200; ++i )
+    {
+        ref.update( {1}, { measurement(i + 1) } );
+    }
+
+    EXPECT( estim.is_gain_fixed() );
+    EXPECT( estim.kalman_gain()(0) == lest::approx( ref.kalman_gain()(0) ) );
+    EXPECT( estim.kalman_gain()(1) == lest::approx( ref.kalman_gain()(1) ) );
+    EXPECT( estim.estimation_error_covariance()(0,0) == lest::approx( ref.estimation_error_covariance()(0,0) ) );
+}
+
+CASE( "kalman: Allows to construct an estimator in steady state from a compile-time Riccati solution" )
+{
+    constexpr kalman::A_t A = { 1, 1, 0, 1 };
+    constexpr kalman::H_t H = { 1, 0 };
+    constexpr kalman::Q_t Q = { 0.01, 0.02, 0.02, 0.04 };
+    constexpr kalman::R_t R = { 100 };
+
+    constexpr auto P = num::dare( A, H, Q, R );
+
+    kalman estim( kalman::steady_state, 1, A, B, H, Q, R, P, { 0, 0 } );
+    kalman ref  ( kalman::steady_state, 1, A, B, H, Q, R, { 0, 0 } );
+
+    EXPECT( identical( estim.kalman_gain(), ref.kalman_gain() ) );
+    EXPECT( identical( estim.estimation_error_covariance(), ref.estimation_error_covariance() ) );
+}
+
+CASE( "kalman: Allows to compute a trajectory at compile time" )
+{
+    constexpr auto reference = trajectory<50>();
+
+    static_assert( reference(49) > 0, "trajectory: expect estimates at compile time" );
+
+    auto estim = make_kalman();
+
+    bool same = true;
+
+    for ( int k = 0; k < 50; ++k )
+    {
+        estim.update( {1}, { measurement( k + 1 ) } );
+        same = same && estim.system_state()(0) == reference(k);
+    }
+
+    EXPECT( same );
+}
+
+CASE( "kalman: Allows to process the measurements one at a time" )
+{
+    kalman estim = make_kalman();
+
+    EXPECT_NOT( estim.is_correction_sequential() );
+
+    estim.correct_sequentially();
+
+    EXPECT( estim.is_correction_sequential() );
+
+    estim.correct_jointly();
+
+    EXPECT_NOT( estim.is_correction_sequential() );
+}
+
+CASE( "kalman: Computes the same estimate with sequential and joint correction, one measurement" )
+{
+    kalman estim = make_kalman();
+    kalman ref   = make_kalman();
+
+    estim.correct_sequentially();
+
+    for ( int i = 0; i < 50; ++i )
+    {
+        estim.update( {1}, { measurement(i + 1) } );
+        ref  .update( {1}, { measurement(i + 1) } );
+    }
+
+    EXPECT( identical( estim.system_state(), ref.system_state() ) );
+    EXPECT( identical( estim.kalman_gain(), ref.kalman_gain() ) );
+    EXPECT( identical( estim.estimation_error_covariance(), ref.estimation_error_covariance() ) );
+}
+
+CASE( "kalman: Computes the same estimate with sequential and joint correction, four measurements with diagonal noise covariance" )
+{
+    using kalman = num::kalman<double,2,4,1>;
+
+    const kalman::H_t H = { 1, 0,  1, 0,  0, 1,  1, 1 };
+    const kalman::R_t R = { 100, 0, 0, 0,  0, 25, 0, 0,  0, 0, 4, 0,  0, 0, 0, 50 };
+
+    kalman estim( dt, A, B, H, Q, R, Q, { 0, 0 } );
+    kalman ref  ( dt, A, B, H, Q, R, Q, { 0, 0 } );
+
+    estim.correct_sequentially();
+
+    for ( int i = 0; i < 50; ++i )
+    {
+        const double x = measurement(i + 1);
+        const double v = i + 1.5;
+
+        estim.update( {1}, { x, x + 3, v, x + v } );
+        ref  .update( {1}, { x, x + 3, v, x + v } );
+    }
+
+    const auto P  = estim.estimation_error_covariance();
+    const auto Pr = ref.estimation_error_covariance();
+
+    EXPECT( estim.system_state()(0) == lest::approx( ref.system_state()(0) ) );
+    EXPECT( estim.system_state()(1) == lest::approx( ref.system_state()(1) ) );
+    EXPECT( P(0,0) == lest::approx( Pr(0,0) ) );
+    EXPECT( P(0,1) == lest::approx( Pr(0,1) ) );
+    EXPECT( P(1,1) == lest::approx( Pr(1,1) ) );
+}
+
+CASE( "kalman: Allows to predict and correct separately, update() is their composition" )
+{
+    kalman estim = make_kalman();
+    kalman ref   = make_kalman();
+
+    for ( int i = 0; i < 20; ++i )
+    {
+        estim.predict( {1} );
+        estim.correct( { measurement(i + 1) } );
+
+        ref.update( {1}, { measurement(i + 1) } );
+    }
+
+    EXPECT( estim.time() == ref.time() );
+    EXPECT( identical( estim.system_state(), ref.system_state() ) );
+    EXPECT( identical( estim.kalman_gain(), ref.kalman_gain() ) );
+    EXPECT( identical( estim.estimation_error_covariance(), ref.estimation_error_covariance() ) );
+}
+
+CASE( "kalman: Allows to coast on the model when a measurement is missing" )
+{
+    kalman estim = make_kalman();
+
+    estim.update( {1}, { measurement(1) } );
+
+    const auto x = estim.system_state();
+    const auto P = estim.estimation_error_covariance();
+    const auto K = estim.kalman_gain();
+
+    estim.predict( {1} );
+
+    EXPECT( estim.time() == 2 * dt );
+    EXPECT( identical( estim.system_state(), A * x + B * kalman::u_t( 1 ) ) );
+    EXPECT( identical( estim.kalman_gain(), K ) );
+    EXPECT( estim.estimation_error_covariance()(0,0) > P(0,0) );
+}
+
+CASE( "kalman: Allows to correct at a lower rate than to predict" )
+{
+    const double dt = 0.1;
+
+    kalman estim( dt, { 1, dt, 0, 1 }, { dt * dt / 2, dt }, H, dt * Q, R, Q, { 0, 0 } );
+
+    for ( int i = 1; i <= 500; ++i )
+    {
+        estim.predict( {1} );
+
+        if ( i % 10 == 0 )
+        {
+            const double t = i * dt;
+
+            estim.correct( { 0.5 * t * t + ( ( i * 7 ) % 17 ) - 8 } );
+        }
+    }
+
+    EXPECT( estim.time() == lest::approx( 50 ) );
+    EXPECT( estim.system_state()(0) == lest::approx( 0.5 * 50 * 50 ).epsilon( 0.05 ) );
+    EXPECT( estim.system_state()(1) == lest::approx( 50 ).epsilon( 0.1 ) );
+}
+
+CASE( "kalman: Computes the same estimate with declared sparsity of A, B and H" )
+{
+    using structured = num::kalman<double,2,1,1, num::structure<num::upper_triangular, num::dense, num::diagonal>>;
+
+    kalman     ref  ( dt, A, B, H, Q, R, Q, { 0, 0 } );
+    structured estim( dt, A, B, H, Q, R, Q, { 0, 0 } );
+
+    for ( int i = 0; i < 20; ++i )
+    {
+        ref  .update( {1}, { measurement(i + 1) } );
+        estim.update( {1}, { measurement(i + 1) } );
+    }
+
+    EXPECT( identical( estim.system_state(), ref.system_state() ) );
+    EXPECT( identical( estim.kalman_gain(), ref.kalman_gain() ) );
+    EXPECT( identical( estim.estimation_error_covariance(), ref.estimation_error_covariance() ) );
+}
+
+CASE( "kalman: Allows a system without control input" )
+{
+    using uncontrolled = num::kalman<double,2,1,0>;
+
+    kalman       ref  ( dt, A, B, H, Q, R, Q, { 0, 1 } );
+    uncontrolled estim( dt, A, {}, H, Q, R, Q, { 0, 1 } );
+
+    for ( int i = 0; i < 20; ++i )
+    {
+        ref  .update( {0}, { i + 1.0 } );
+        estim.update( {} , { i + 1.0 } );
+    }
+
+    EXPECT( identical( estim.system_state(), ref.system_state() ) );
+    EXPECT( identical( estim.estimation_error_covariance(), ref.estimation_error_covariance() ) );
+}
+
+CASE( "kalman: Provides the innovation and its covariance" )
+{
+    kalman estim = make_kalman();
+
+    estim.predict( {1} );
+
+    const auto P = estim.estimation_error_covariance();
+
+    EXPECT( estim.innovation( { 5 } )(0) == 5 - estim.system_state()(0) );
+    EXPECT( estim.innovation_covariance()(0,0) == lest::approx( P(0,0) + R(0,0) ) );
+}
+
+CASE( "kalman: Accepts all measurements and computes the same estimate without a gate" )
+{
+    kalman ref   = make_kalman();
+    kalman estim = make_kalman();
+
+    estim.gate( num::chi_square_quantile( 1, 0.99 ) );
+
+    for ( int i = 1; i <= 20; ++i )
+    {
+        ref.update( {1}, { measurement(i) } );
+        EXPECT( estim.update( {1}, { measurement(i) } ) );
+    }
+
+    EXPECT( estim.rejections() == 0 );
+    EXPECT( identical( estim.system_state(), ref.system_state() ) );
+    EXPECT( identical( estim.estimation_error_covariance(), ref.estimation_error_covariance() ) );
+}
+
+CASE( "kalman: Rejects a measurement beyond the gate, leaving the prediction" )
+{
+    kalman coast = make_kalman();
+    kalman estim = make_kalman();
+
+    estim.gate( num::chi_square_quantile( 1, 0.99 ) );
+
+    for ( int i = 1; i <= 10; ++i )
+    {
+        coast.update( {1}, { measurement(i) } );
+        estim.update( {1}, { measurement(i) } );
+    }
+
+    coast.predict( {1} );
+
+    const double y = 1000 - coast.system_state()(0);
+    const double S = coast.innovation_covariance()(0,0);
+
+    EXPECT_NOT( estim.update( {1}, { 1000 } ) );
+    EXPECT( estim.rejections() == 1 );
+    EXPECT( estim.normalized_innovation_squared() == lest::approx( y * y / S ) );
+    EXPECT( identical( estim.system_state(), coast.system_state() ) );
+    EXPECT( identical( estim.estimation_error_covariance(), coast.estimation_error_covariance() ) );
+
+    EXPECT( estim.update( {1}, { measurement(12) } ) );
+    EXPECT( estim.rejections() == 1 );
+
+    estim.reset_rejections();
+    EXPECT( estim.rejections() == 0 );
+}
+
+CASE( "kalman: Gates with the innovation covariance of a fixed Kalman gain" )
+{
+    kalman estim( kalman::steady_state, dt, A, B, H, Q, R, { 0, 0 } );
+
+    estim.gate( num::chi_square_quantile( 1, 0.999 ) );
+
+    EXPECT(     estim.update( {1}, { 1 } ) );
+    EXPECT_NOT( estim.update( {1}, { 1000 } ) );
+    EXPECT( estim.rejections() == 1 );
+}
+
+CASE( "kalman: Provides chi-square quantiles as gate thresholds" )
+{
+    EXPECT( num::chi_square_quantile( 1, 0.95  ) ==  3.841 );
+    EXPECT( num::chi_square_quantile( 3, 0.99  ) == 11.345 );
+    EXPECT( num::chi_square_quantile( 10, 0.999 ) == 29.588 );
+    EXPECT( num::chi_square_quantile( 11, 0.99 ) == 0 );
+    EXPECT( num::chi_square_quantile( 2, 0.5 ) == 0 );
+}
@@ -552,16 +552,33 @@ CASE( "algorithm: [a ; b]T                   " " [mat2x2][transposed]" )
 
 CASE( "algorithm: [a ; ...]T                 " " [matNxN][transposed]" )
 {
-#if 0
     constexpr matrix<int,3,3> A = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
-    constexpr matrix<int,3,3> R = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    constexpr matrix<int,3,3> R = { 1, 4, 7, 2, 5, 8, 3, 6, 9 };
+
+    constexpr auto AT = transposed(A);
+
+    STATIC_EXPECT( std20::equal( AT.begin(), AT.end(), R.begin() ) );
+}
+
+CASE( "algorithm: [a ; ...]T                 " " [matNxM][transposed]" )
+{
+    constexpr matrix<int,2,3> A = { 1, 2, 3, 4, 5, 6 };
+    constexpr matrix<int,3,2> R = { 1, 4, 2, 5, 3, 6 };
 
     constexpr auto AT = transposed(A);
 
     STATIC_EXPECT( std20::equal( AT.begin(), AT.end(), R.begin() ) );
-#else
-    EXPECT( !!"Implement transposed(Anxn)");
-#endif
+}
+
+CASE( "algorithm: [a ; ...]  . [b ; ...]     " " [matNxK][matKxM][mul]" )
+{
+    constexpr matrix<int,2,3> A = { 1, 2, 3, 4, 5, 6 };
+    constexpr matrix<int,3,2> B = { 1, 2, 3, 4, 5, 6 };
+    constexpr matrix<int,2,2> R = { 22, 28, 49, 64 };
+
+    constexpr auto C = A * B;
+
+    STATIC_EXPECT( std20::equal( C.begin(), C.end(), R.begin() ) );
 }
 
 CASE( "algorithm: inverted( value        )   " " [val][inverted]" )
@@ -576,7 +593,7 @@ CASE( "algorithm: inverted( value        )   " " [val][inverted]" )
 CASE( "algorithm: inverted( [a ; b]      )   " " [mat2x2][inverted]" )
 {
     constexpr matrix<double,2,2> A = {  1, 2  , 3,  4 };
-    constexpr matrix<double,2,2> R = { -2, 1.5, 1, -0.5 };
+    constexpr matrix<double,2,2> R = { -2, 1, 1.5, -0.5 };
 
     constexpr auto AI = inverted(A);
 
@@ -585,16 +602,12 @@ CASE( "algorithm: inverted( [a ; b]      )   " " [mat2x2][inverted]" )
 
 CASE( "algorithm: inverted( [a ; ...]    )   " " [matNxN][inverted]" )
 {
-#if 0
-    constexpr matrix<int,3,3> A = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
-    constexpr matrix<int,3,3> R = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    constexpr matrix<double,3,3> A = { 2, 0, 1, 1, 3, 2, 1, 1, 2 };
+    constexpr matrix<double,3,3> R = { 2/3., 1/6., -1/2., 0, 1/2., -1/2., -1/3., -1/3., 1 };
 
     constexpr auto AI = inverted(A);
 
-    STATIC_EXPECT( std20::equal( AI.begin(), AI.end(), R.begin() ) );
-#else
-    EXPECT( !!"Implement inverted(Anxn)");
-#endif
+    STATIC_EXPECT( std20::equal( AI.begin(), AI.end(), R.begin(), approx() ) );
 }
 
 CASE( "algorithm: eye<N,T>()                 " " [mat][identity]" )
@@ -608,6 +621,19 @@ CASE( "algorithm: eye<N,T>()                 " " [mat][identity]" )
     STATIC_EXPECT( std20::equal( A.begin(), A.end(), R.begin() ) );
 }
 
+CASE( "algorithm: row(A,r), column(A,c)      " " [matNxM][row][col]" )
+{
+    constexpr matrix<int,2,3> A = { 1, 2, 3, 4, 5, 6 };
+    constexpr rowvec<int,3>   r = { 4, 5, 6 };
+    constexpr colvec<int,2>   c = { 3, 6 };
+
+    constexpr auto Ar = row( A, 1 );
+    constexpr auto Ac = column( A, 2 );
+
+    STATIC_EXPECT( std20::equal( Ar.begin(), Ar.end(), r.begin() ) );
+    STATIC_EXPECT( std20::equal( Ac.begin(), Ac.end(), c.begin() ) );
+}
+
 // -----------------------------------------------------------------------
 // Applets
 
@@ -0,0 +1,84 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "num/precision.hpp"
+#include "lest.hpp"
+
+#include <cstdint>
+
+#define CASE( name ) lest_CASE( specification(), name )
+
+extern lest::tests & specification();
+
+namespace {
+
+using namespace num;
+
+using fp32_t = fixed_point<std::int32_t, 15>;
+using fp16_t = fixed_point<std::int16_t, 10>;
+
+CASE( "precision: Separates the covariance and the state type of a mixed precision type" "[precision]" )
+{
+    using mixed = mixed_precision<fp32_t, fp16_t>;
+
+    EXPECT(( std20::is_same_v< precision_traits<mixed>::covariance_type, fp32_t > ));
+    EXPECT(( std20::is_same_v< precision_traits<mixed>::state_type     , fp16_t > ));
+    EXPECT(( std20::is_same_v< precision_traits<double>::covariance_type, double > ));
+    EXPECT(( std20::is_same_v< precision_traits<double>::state_type     , double > ));
+
+    EXPECT(     is_mixed_precision_v<mixed>  );
+    EXPECT_NOT( is_mixed_precision_v<double> );
+}
+
+CASE( "precision: Determines if a type is at least as wide as another" "[precision]" )
+{
+    EXPECT(     ( is_wider_v<fp32_t, fp16_t> ) );
+    EXPECT_NOT( ( is_wider_v<fp16_t, fp32_t> ) );
+    EXPECT(     ( is_wider_v<double, float > ) );
+    EXPECT_NOT( ( is_wider_v<float , double> ) );
+    EXPECT(     ( is_wider_v<float , fp16_t> ) );
+    EXPECT_NOT( ( is_wider_v<fp32_t, float > ) );
+    EXPECT_NOT( ( is_wider_v<fixed_point<std::int32_t, 8>, fp16_t> ) );
+}
+
+CASE( "precision: Converts between fixed point types of different width" "[precision]" )
+{
+    constexpr fp32_t a( 3.25 );
+    constexpr fp16_t b = precision_cast<fp16_t>( a );
+
+    static_assert( precision_cast<fp32_t>( b ).as_double() == 3.25, "exact" );
+
+    EXPECT( b.as_double() == 3.25 );
+    EXPECT( precision_cast<fp32_t>( b ).as_double() == 3.25 );
+}
+
+CASE( "precision: Rounds to nearest when dropping fractional digits" "[precision]" )
+{
+    const double lsb = 1.0 / ( 1 << fp16_t::fractional_digits );
+
+    EXPECT( precision_cast<fp16_t>( fp32_t(  0.6 * lsb ) ).as_double() ==  lsb );
+    EXPECT( precision_cast<fp16_t>( fp32_t(  0.4 * lsb ) ).as_double() ==  0.0 );
+    EXPECT( precision_cast<fp16_t>( fp32_t( -0.6 * lsb ) ).as_double() == -lsb );
+}
+
+CASE( "precision: Converts between fixed and floating point types" "[precision]" )
+{
+    EXPECT( precision_cast<double>( fp16_t( 1.5 ) ) == 1.5 );
+    EXPECT( precision_cast<fp16_t>( 1.5 ).as_double() == 1.5 );
+    EXPECT( precision_cast<float >( 0.25 ) == 0.25f );
+}
+
+CASE( "precision: Converts each element of a matrix" "[precision]" )
+{
+    const matrix<fp32_t,2,1> a = { fp32_t( 1.5 ), fp32_t( -2.25 ) };
+    const matrix<fp16_t,2,1> b = precision_cast<fp16_t>( a );
+
+    EXPECT( b(0).as_double() ==  1.5  );
+    EXPECT( b(1).as_double() == -2.25 );
+}
+
+} // anonymous namespace
@@ -0,0 +1,86 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "num/riccati.hpp"
+#include "kalman-fixture.hpp"
+#include "lest.hpp"
+
+// Configuration:
+
+#ifndef  KE_USE_STATIC_EXPECT
+# define KE_USE_STATIC_EXPECT  0
+#endif
+
+#if defined( KE_USE_STATIC_EXPECT ) && KE_USE_STATIC_EXPECT
+# define STATIC_EXPECT(     expr )  static_assert(   expr  )
+#else
+# define STATIC_EXPECT(     expr )  EXPECT(     expr )
+#endif
+
+#define CASE( name ) lest_CASE( specification(), name )
+
+extern lest::tests & specification();
+
+using namespace num;
+
+namespace {
+
+using namespace fixture;
+
+// Residual of the Riccati equation:
+
+template< typename T, int S, int M >
+constexpr T residual( matrix<T,S,S> const & P, matrix<T,S,S> const & A, matrix<T,M,S> const & H, matrix<T,S,S> const & Q, matrix<T,M,M> const & R )
+{
+    const auto Pn = A * P * transposed(A)
+        - A * P * transposed(H) * inverted( H * P * transposed(H) + R ) * H * P * transposed(A) + Q;
+
+    T result = 0;
+    for ( int i = 0; i < P.size(); ++i )
+    {
+        result = result + detail::abs( Pn(i) - P(i) );
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+CASE( "riccati: dare() solves the discrete algebraic Riccati equation of the Kalman estimator" )
+{
+    const auto P = dare( A, H, Q, R );
+
+    EXPECT( residual( P, A, H, Q, R ) < 1e-9 );
+}
+
+CASE( "riccati: dare() solves the Riccati equation for two measurements" )
+{
+    constexpr matrix<double,2,2> H = { 1, 0, 0, 1 };
+    constexpr matrix<double,2,2> R = { 100, 0, 0, 4 };
+
+    const auto P = dare( A, H, Q, R );
+
+    EXPECT( residual( P, A, H, Q, R ) < 1e-9 );
+}
+
+CASE( "riccati: dare() solves the Riccati equation for a three-state model" )
+{
+    constexpr matrix<double,3,3> A = { 1, 1, 0.5, 0, 1, 1, 0, 0, 1 };
+    constexpr matrix<double,1,3> H = { 1, 0, 0 };
+    constexpr matrix<double,3,3> Q = { 0.001, 0, 0, 0, 0.001, 0, 0, 0, 0.01 };
+    constexpr matrix<double,1,1> R = { 10 };
+
+    const auto P = dare( A, H, Q, R );
+
+    EXPECT( residual( P, A, H, Q, R ) < 1e-9 );
+}
+
+CASE( "riccati: dare() is usable at compile time" )
+{
+    constexpr auto P = dare( A, H, Q, R );
+
+    STATIC_EXPECT( residual( P, A, H, Q, R ) < 1e-9 );
+}
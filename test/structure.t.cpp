@@ -0,0 +1,92 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "num/structure.hpp"
+#include "lest.hpp"
+
+#define CASE( name ) lest_CASE( specification(), name )
+
+extern lest::tests & specification();
+
+namespace {
+
+using mat3 = num::matrix<double,3,3>;
+using sym3 = num::symmatrix<double,3>;
+
+// Upper triangular A and selector H:
+
+const mat3 A = { 1, 2, 3,
+                 0, 1, 4,
+                 0, 0, 1 };
+
+const num::matrix<double,2,3> H = { 1, 0, 0,
+                                    0, 1, 0 };
+
+const mat3 S = { 4, 1, 2,
+                 1, 5, 3,
+                 2, 3, 6 };
+
+using selector = num::mask<0b000'010'001, 3>;
+
+template< typename Matrix >
+bool identical( Matrix const & a, Matrix const & b )
+{
+    return std20::equal( a.begin(), a.end(), b.begin() );
+}
+
+} // anonymous namespace
+
+CASE( "structure: Provides patterns of structurally nonzero elements" )
+{
+    EXPECT(     num::dense::nonzero( 1, 0 ) );
+    EXPECT(     num::diagonal::nonzero( 1, 1 ) );
+    EXPECT_NOT( num::diagonal::nonzero( 0, 1 ) );
+    EXPECT(     num::upper_triangular::nonzero( 0, 1 ) );
+    EXPECT_NOT( num::upper_triangular::nonzero( 1, 0 ) );
+    EXPECT(     selector::nonzero( 0, 0 ) );
+    EXPECT(     selector::nonzero( 1, 1 ) );
+    EXPECT_NOT( selector::nonzero( 0, 1 ) );
+    EXPECT_NOT( selector::nonzero( 1, 2 ) );
+}
+
+CASE( "structure: Computes the product with a sparse left operand as the dense product" )
+{
+    EXPECT( identical( num::product<num::upper_triangular>( A, S ), A * S ) );
+    EXPECT( identical( num::product<num::dense>( A, S ), A * S ) );
+    EXPECT( identical( num::product<selector>( H, S ), H * S ) );
+}
+
+CASE( "structure: Computes the product with a transposed sparse right operand as the dense product" )
+{
+    EXPECT( identical( num::product_transposed<selector>( S, H ), S * transposed( H ) ) );
+    EXPECT( identical( num::product_transposed<selector>( sym3( S ), H ), S * transposed( H ) ) );
+}
+
+CASE( "structure: Computes a dot product with a sparse row as a value" )
+{
+    const num::rowvec<double,3> h = { 1, 0, 0 };
+    const num::colvec<double,3> x = { 7, 8, 9 };
+
+    const double hx = num::product<num::diagonal>( h, x );
+
+    EXPECT( hx == 7 );
+}
+
+CASE( "structure: Computes the congruence with a sparse matrix as the dense congruence" )
+{
+    EXPECT( identical( num::congruence<num::upper_triangular>( A, sym3( S ) ), congruence( A, sym3( S ) ) ) );
+    EXPECT( identical( num::congruence<selector>( H, sym3( S ) ), congruence( H, sym3( S ) ) ) );
+}
+
+CASE( "structure: Allows to compute at compile-time" )
+{
+    constexpr auto P = num::congruence<num::upper_triangular>( A, sym3( S ) );
+
+    static_assert( P(2,2) == 6, "" );
+
+    EXPECT( P(0,0) == congruence( A, sym3( S ) )(0,0) );
+}
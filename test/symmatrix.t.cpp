@@ -0,0 +1,163 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "num/fixed-point.hpp"
+#include "num/symmatrix.hpp"
+#include "lest.hpp"
+
+#include <cmath>
+#include <cstdint>
+
+#define CASE( name ) lest_CASE( specification(), name )
+
+extern lest::tests & specification();
+
+namespace {
+
+using mat3 = num::matrix<double,3,3>;
+using sym3 = num::symmatrix<double,3>;
+
+const mat3 S = { 4, 1, 2,
+                 1, 5, 3,
+                 2, 3, 6 };
+
+const mat3 A = { 1, 2, 0,
+                 0, 1, 3,
+                 4, 0, 1 };
+
+template< typename Matrix >
+bool approx_equal( Matrix const & a, Matrix const & b )
+{
+    for ( int i = 0; i < a.size(); ++i )
+    {
+        if ( a(i) != lest::approx( b(i) ) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template< typename Matrix >
+bool identical( Matrix const & a, Matrix const & b )
+{
+    return std20::equal( a.begin(), a.end(), b.begin() );
+}
+
+} // anonymous namespace
+
+CASE( "symmatrix: Stores the upper triangle in packed form" )
+{
+    sym3 P( S );
+
+    EXPECT( P.size() == 6 );
+    EXPECT( sizeof( P ) == 6 * sizeof( double ) );
+
+    EXPECT( P.begin()[0] == 4 );
+    EXPECT( P.begin()[1] == 1 );
+    EXPECT( P.begin()[2] == 2 );
+    EXPECT( P.begin()[3] == 5 );
+    EXPECT( P.begin()[4] == 3 );
+    EXPECT( P.begin()[5] == 6 );
+}
+
+CASE( "symmatrix: Allows to access an element from either triangle" )
+{
+    sym3 P( S );
+
+    for ( int r = 0; r < 3; ++r )
+    {
+        for ( int c = 0; c < 3; ++c )
+        {
+            EXPECT( P(r,c) == S(r,c) );
+        }
+    }
+
+    P(2,0) = 7;
+
+    EXPECT( P(0,2) == 7 );
+}
+
+CASE( "symmatrix: Allows to convert to a full matrix" )
+{
+    EXPECT( identical( to_matrix( sym3( S ) ), S ) );
+}
+
+CASE( "symmatrix: Allows to add two symmetric matrices" )
+{
+    EXPECT( identical( to_matrix( sym3( S ) + sym3( S ) ), S + S ) );
+}
+
+CASE( "symmatrix: Allows to multiply a symmetric matrix with a matrix" )
+{
+    const num::matrix<double,3,1> h = { 1, 0, 2 };
+
+    EXPECT( identical( sym3( S ) * h, S * h ) );
+}
+
+CASE( "symmatrix: Allows to compute the congruence A * P * transposed(A)" )
+{
+    EXPECT( identical( to_matrix( congruence( A, sym3( S ) ) ), A * S * transposed( A ) ) );
+
+    const num::matrix<double,2,3> H = { 1, 0, 0,
+                                        0, 1, 1 };
+
+    EXPECT( identical( to_matrix( congruence( H, sym3( S ) ) ), H * S * transposed( H ) ) );
+}
+
+CASE( "symmatrix: Allows a symmetric rank-K update and downdate" )
+{
+    const num::matrix<double,3,2> X = { 1, 2,
+                                        0, 1,
+                                        3, 0 };
+
+    EXPECT( identical( to_matrix( rank_update  ( sym3( S ), X, X ) ), S + X * transposed( X ) ) );
+    EXPECT( identical( to_matrix( rank_downdate( sym3( S ), X, X ) ), S + -1.0 * X * transposed( X ) ) );
+}
+
+CASE( "symmatrix: Allows to compute at compile-time" )
+{
+    constexpr auto P = congruence( A, sym3( S ) ) + sym3( S );
+
+    static_assert( P(0,0) == 4 + 4 + 20 + 4, "" );
+
+    EXPECT( P(1,0) == P(0,1) );
+}
+
+CASE( "symmatrix: Allows to compute a square root of floating point and fixed_point values" )
+{
+    using fp32_t = num::fixed_point<std::int32_t, 15>;
+
+    EXPECT( num::square_root( 0.0  ) == 0 );
+    EXPECT( num::square_root( -4.0 ) == 0 );
+    EXPECT( num::square_root( 2.0  ) == lest::approx( std::sqrt( 2.0  ) ) );
+    EXPECT( num::square_root( 1e-6 ) == lest::approx( std::sqrt( 1e-6 ) ) );
+    EXPECT( num::square_root( 1e6  ) == lest::approx( std::sqrt( 1e6  ) ) );
+    EXPECT( num::square_root( fp32_t( 9 ) ) == fp32_t( 3 ) );
+}
+
+CASE( "symmatrix: Allows to compute the Cholesky factor of a positive definite matrix" )
+{
+    const num::matrix<double,3,3> P = { 4, 2, 2, 2, 5, 3, 2, 3, 6 };
+
+    const auto L = num::cholesky( num::symmatrix<double,3>( P ) );
+
+    EXPECT( L(0,1) == 0 );
+    EXPECT( L(0,2) == 0 );
+    EXPECT( L(1,2) == 0 );
+    EXPECT( approx_equal( L * transposed( L ), P ) );
+}
+
+CASE( "symmatrix: Allows to compute the squared Mahalanobis distance and the determinant" )
+{
+    const num::colvec<double,3> y = { 1, -2, 0.5 };
+
+    const double expected = transposed( y ) * ( inverted( S ) * y );
+
+    EXPECT( num::mahalanobis_squared( sym3( S ), y ) == lest::approx( expected ) );
+    EXPECT( num::determinant( sym3( S ) ) == lest::approx( 4 * (5*6 - 3*3) - 1 * (1*6 - 3*2) + 2 * (1*3 - 5*2) ) );
+}
@@ -37,7 +37,7 @@ set msvc_defines=^
     -D_SCL_SECURE_NO_WARNINGS
 
 set ke_program=main.t.exe
-set ke_sources=main.t.cpp core.t.cpp stdcpp.t.cpp biquad.t.cpp biquad-cascade.t.cpp fixed-point.t.cpp matrix.t.cpp
+set ke_sources=main.t.cpp core.t.cpp stdcpp.t.cpp biquad.t.cpp biquad-cascade.t.cpp checkpoint.t.cpp dual.t.cpp expression.t.cpp fixed-point.t.cpp matrix.t.cpp precision.t.cpp kalman.t.cpp kalman-bank.t.cpp kalman-ensemble.t.cpp kalman-extended.t.cpp kalman-history.t.cpp kalman-iir.t.cpp kalman-imm.t.cpp kalman-smoother.t.cpp kalman-telemetry.t.cpp kalman-tracker.t.cpp kalman-ud.t.cpp kalman-unscented.t.cpp kalman-varying.t.cpp riccati.t.cpp structure.t.cpp symmatrix.t.cpp
 
 cl -W3 -EHsc %std% %msvc_flags% %ke_feature% %lest_defines% %msvc_defines% -Ilest -I../include %ke_sources% && %ke_program%
 endlocal & goto :EOF
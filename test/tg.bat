@@ -30,7 +30,7 @@ set lest_defines=^
 set cxx_flags=-Wpedantic -Wno-padded -Wno-missing-noreturn
 
 set ke_program=main.t.exe
-set ke_sources=main.t.cpp core.t.cpp stdcpp.t.cpp biquad.t.cpp biquad-cascade.t.cpp fixed-point.t.cpp matrix.t.cpp
+set ke_sources=main.t.cpp core.t.cpp stdcpp.t.cpp biquad.t.cpp biquad-cascade.t.cpp checkpoint.t.cpp dual.t.cpp expression.t.cpp fixed-point.t.cpp matrix.t.cpp precision.t.cpp kalman.t.cpp kalman-bank.t.cpp kalman-ensemble.t.cpp kalman-extended.t.cpp kalman-history.t.cpp kalman-iir.t.cpp kalman-imm.t.cpp kalman-smoother.t.cpp kalman-telemetry.t.cpp kalman-tracker.t.cpp kalman-ud.t.cpp kalman-unscented.t.cpp kalman-varying.t.cpp riccati.t.cpp structure.t.cpp symmatrix.t.cpp
 
 %gpp% -std=%std% -O2 -Wall -Wextra %cxx_flags% %ke_feature% %lest_defines% -o %ke_program% -isystem lest -I../include %ke_sources% && %ke_program%
 
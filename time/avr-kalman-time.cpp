@@ -7,9 +7,30 @@
 
 // Pro Trinket, atmega328: avr5: Free running Blink: 144kHz
 
+// Configuration:
+// - KE_NUMERIC_TYPE: numeric type, default double, e.g. fp32_t, mixed_t
+// - KE_UPDATE_KALMAN_GAIN=0: fix Kalman gain from the start
+// - KE_KALMAN_GAIN_TOLERANCE: fix Kalman gain once its relative change is within tolerance,
+//   compiling in KE_AUTO_FIX_KALMAN_GAIN (default 0 on AVR)
+// - KE_STRUCTURE=1: declare A upper triangular and H a selector, skipping their zeros
+// - KE_CONTROL_INPUTS=0: no control input, leaving out B * u
+// - KE_EXPRESSION_TEMPLATES=1: lazy state update expressions (default eager)
+// - KE_INNOVATION_GATING=1: compile in measurement gating (default 0 on AVR)
+//
+// Operations per update, double, as counted by kalman-structure-time.cpp
+// (lazy: KE_EXPRESSION_TEMPLATES=1, which adds the products to zero):
+// - dense     , U=1: 35 mul, 42 add, 1 div (lazy: 46 add)
+// - dense     , U=0: 33 mul, 40 add, 1 div (lazy: 42 add)
+// - structured, U=1: 26 mul, 35 add, 1 div
+// - structured, U=0: 24 mul, 31 add, 1 div
+
+#if defined( KE_KALMAN_GAIN_TOLERANCE ) && !defined( KE_AUTO_FIX_KALMAN_GAIN )
+# define KE_AUTO_FIX_KALMAN_GAIN  1
+#endif
+
 #include "num/fixed-point.hpp"
 #include "num/matrix.hpp"
-//#include "dsp/kalman.hpp"
+#include "dsp/kalman.hpp"
 
 // Blink LED to measure loop frequency:
 
@@ -37,148 +58,24 @@ inline void blink_led()
 
 //---------------------------------------------------------
 
-namespace num {
-
-//
-// Kalman estimator.
-//
-template
-<
-    typename T      // Numeric type
-    , int S         // System dimension
-    , int M         // Number of measurements
-    , int U         // Number of control inputs
->
-class kalman
-{
-public:
-    using real_t = T;                   // Numeric type for computations
-    using A_t    = num::matrix<T,S,S>;  // System dynamics matrix: state-k-1 => state-k
-    using B_t    = num::matrix<T,S,U>;  // Control input matrix: control => state
-    using H_t    = num::matrix<T,M,S>;  // Measurement output matrix: state => measurement estimation
-    using Q_t    = num::matrix<T,S,S>;  // Process noise covariance
-    using R_t    = num::matrix<T,M,M>;  // Measurement noise covariance
-    using P_t    = num::matrix<T,S,S>;  // Estimate error covariance
-    using K_t    = num::matrix<T,S,M>;  // Kalman gain
-    using x_t    = num::colvec<T,S>;    // Initial system state estimate
-    using u_t    = num::colvec<T,U>;    // Control inputs
-    using z_t    = num::colvec<T,M>;    // Measurements inputs
-    using xhat_t = num::colvec<T,S>;    // System state estimate
-
-    // Constructor
-
-    kalman(
-        real_t const dt_        // Time step
-        , A_t const & A_        // System dynamics matrix: state-k-1 => state-k
-        , B_t const & B_        // Control input matrix: control => state
-        , H_t const & H_        // Measurement output matrix: state => measurement estimation
-        , Q_t const & Q_        // Process noise covariance
-        , R_t const & R_        // Measurement noise covariance
-        , P_t const & P_        // Initial estimate error covariance
-        , xhat_t const & xhat_  // Initial system state estimate
-    )
-        : A( A_)
-        , B( B_)
-        , H( H_)
-        , Q( Q_)
-        , R( R_)
-        , P( P_)
-        , xhat( xhat_)
-        , t(  0  )
-        , dt( dt_)
-        , compute_kalman_gain(
-#if defined(KE_UPDATE_KALMAN_GAIN) && KE_UPDATE_KALMAN_GAIN == 0
-            false
-#else
-            true
-#endif // defined
-        )
-    {}
-
-    // Update estimator for dt:
-
-    void update( u_t const & u, z_t const & z )
-    {
-        // Update the time:
-//      t += dt;
-
-        // --------------------------------------
-        // 1. Predict (time update)
-
-        // 1a: Project the state ahead:
-        xhat = A * xhat + B * u;
-
-        if ( compute_kalman_gain )
-        {
-            // 1b: Project the error covariance ahead:
-            P = A * P * transposed(A) + Q;
-
-            // --------------------------------------
-            // 2. Correct (measurement update)
-
-            // 2a: Compute the Kalman gain:
-            K = P * transposed(H) * inverted(H * P * transposed(H) + R);
-
-            // 2c: Update the error covariance:
-            P = (I() - K * H) * P;
-        }
-
-        // 2b: Update estimate with measurement:
-        xhat = xhat + K * (z - H * xhat);
-    }
-
-    // Observers:
-
-    xhat_t system_state() const
-    {
-        return xhat;
-    }
-
-    K_t kalman_gain() const
-    {
-        return K;
-    }
+// Fixed point numeric types for Kalman estimator:
 
-    P_t estimation_error_covariance() const
-    {
-        return P;
-    }
-
-    real_t time() const
-    {
-        return t;
-    }
-
-private:
-    auto I() const
-    {
-        return num::eye<T,S>();
-    }
-
-private:
-    A_t const A;    // System dynamics matrix:
-    B_t const B;    // Control input matrix
-    H_t const H;    // Measurement output matrix
-    Q_t const Q;    // Process noise covariance
-    R_t const R;    // Measurement noise covariance
-
-    K_t K;          // Kalman gain
-    P_t P;          // Estimate error covariance
-    xhat_t xhat;    // System state estimate
-
-    real_t t;       // Elapsed time
-    real_t dt;      // Time-step
-
-    bool compute_kalman_gain;  // Update Kalman gain?
-};
+using fp32_t = num::fixed_point<int, 15>;
 
-} // namespace num
+// Mixed precision: 32-bit covariance and gain, 16-bit state, inputs; with
+// explicit widths, as int is 16 bits on AVR:
 
-//---------------------------------------------------------
+using mixed_t = num::mixed_precision<
+    num::fixed_point<std20::int32_t, 15>
+    , num::fixed_point<std20::int16_t, 10> >;
 
-// Fixed point numeric type for Kalman estimator:
+#ifndef  KE_STRUCTURE
+# define KE_STRUCTURE  0
+#endif
 
-using fp32_t = num::fixed_point<int, 15>;
+#ifndef  KE_CONTROL_INPUTS
+# define KE_CONTROL_INPUTS  1
+#endif
 
 // Kalman estimator type:
 
@@ -191,7 +88,10 @@ using kalman = num::kalman
 #endif
     , 2     // 2d system
     , 1     // single measurement
-    , 1     // single control input
+    , KE_CONTROL_INPUTS // single or no control input
+#if KE_STRUCTURE
+    , num::structure<num::upper_triangular, num::dense, num::diagonal>
+#endif
 >;
 
 // Create Kalman estimator and run it with process and measurement noise:
@@ -215,15 +115,19 @@ int main()
                       0, 1 };           // pos => vel, vel => vel
 
     // B: Control input matrix: control => state
+#if KE_CONTROL_INPUTS
     kalman::B_t B = { dt * dt / 2,      // ctl => pos
                       dt         };     // ctl => vel
+#else
+    kalman::B_t B = {};                 // no control input
+#endif
 
     // H: Measurement output matrix: state => measurement estimation
     kalman::H_t H = { 1, 0 };           // pos => pos-est, vel=> vel-est
 
-    // x: Initial system state estimate
-    kalman::x_t x = { 0, 0 };           // position, velocity
-    kalman::xhat_t xhat = x;            // initial system state estimate
+    // x: Initial system state, simulated in the numeric type for computations
+    num::colvec<kalman::real_t,2> x = { 0, 0 };     // position, velocity
+    kalman::xhat_t xhat = num::precision_cast<kalman::state_t>( x );
 
     // R: Position measurement noise covariance
     auto R = measnoise * measnoise;     // (rms)^2
@@ -249,16 +153,27 @@ int main()
         , xhat      // initial system state estimate
     );
 
+#ifdef KE_KALMAN_GAIN_TOLERANCE
+    estim.auto_fix_gain( KE_KALMAN_GAIN_TOLERANCE );
+#endif
+
     // Use the estimator:
 
+#if KE_CONTROL_INPUTS
     // Use a constant commanded acceleration of 1 [m/s^2]:
     const kalman::u_t u(1); // = {1};
 
     // Simulate the linear system:
-    x = A * x + B * u ; // + process_noise( dt, accelnoise );
+    x = A * x + B * num::precision_cast<kalman::real_t>( u ) ; // + process_noise( dt, accelnoise );
+#else
+    const kalman::u_t u = {};
+
+    // Simulate the linear system:
+    x = A * x ; // + process_noise( dt, accelnoise );
+#endif
 
     // Simulate the noisy measurement:
-    auto z = H * x; // + meas_noise( measnoise );
+    const kalman::z_t z = num::precision_cast<kalman::state_t>( H * x ); // + meas_noise( measnoise );
 
     for ( ;; )
     {
@@ -0,0 +1,126 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Desktop: throughput of N separate num::kalman estimators versus num::kalman_bank.
+
+#include "num/fixed-point.hpp"
+#include "dsp/kalman-bank.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+// Fixed point numeric type for Kalman estimator:
+
+using fp32_t = num::fixed_point<int, 15>;
+
+#ifdef KE_NUMERIC_TYPE
+using real_t = KE_NUMERIC_TYPE;
+#else
+using real_t = double;
+#endif
+
+// Number of estimators and number of time-steps:
+
+#ifndef KE_BANK_SIZE
+# define KE_BANK_SIZE  4096
+#endif
+
+#ifndef KE_BANK_STEPS
+# define KE_BANK_STEPS  1000
+#endif
+
+const int N     = KE_BANK_SIZE;
+const int steps = KE_BANK_STEPS;
+
+using kalman = num::kalman<real_t, 2, 1, 1>;
+using bank_t = num::kalman_bank<real_t, 2, 1, 1, N>;
+
+using Clock = std::chrono::steady_clock;
+
+double seconds_since( Clock::time_point start )
+{
+    return std::chrono::duration<double>( Clock::now() - start ).count();
+}
+
+// Keep results alive:
+
+volatile double sink;
+
+double as_double( double x ) { return x; }
+
+template< typename T, int I, int F >
+double as_double( num::fixed_point<T,I,F> x ) { return x.as_double(); }
+
+int main()
+{
+    const real_t dt = 1;
+    const real_t measnoise  = 10;
+    const real_t accelnoise = 0.2;
+
+    const kalman::A_t A = { 1, dt, 0, 1 };
+    const kalman::B_t B = { dt * dt / 2, dt };
+    const kalman::H_t H = { 1, 0 };
+    const kalman::R_t R = { measnoise * measnoise };
+    const kalman::Q_t Q = accelnoise * accelnoise * kalman::Q_t(
+        { dt*dt*dt*dt/4, dt*dt*dt/2, dt*dt*dt/2, dt*dt } );
+    const kalman::xhat_t xhat = { 0, 0 };
+
+    // Measurements, shared by both runs:
+
+    static bank_t::u_bank_t u;
+    static bank_t::z_bank_t z;
+
+    for ( int i = 0; i < N; ++i )
+    {
+        u[0][i] = 1;
+        z[0][i] = real_t( ( i * 13 ) % 17 - 8 );
+    }
+
+    // N separate estimators:
+
+    std::vector<kalman> estim( N, kalman( dt, A, B, H, Q, R, Q, xhat ) );
+
+    auto start = Clock::now();
+
+    for ( int k = 0; k < steps; ++k )
+    {
+        for ( int i = 0; i < N; ++i )
+        {
+            estim[i].update( { u[0][i] }, { z[0][i] } );
+        }
+    }
+
+    const auto t_scalar = seconds_since( start );
+
+    sink = as_double( estim[N-1].system_state()(0) );
+
+    // Bank of N estimators:
+
+    static bank_t bank( dt, A, B, H, Q, R, Q, xhat );
+
+    start = Clock::now();
+
+    for ( int k = 0; k < steps; ++k )
+    {
+        bank.update( u, z );
+    }
+
+    const auto t_bank = seconds_since( start );
+
+    sink = as_double( bank.system_state(N-1)(0) );
+
+    const double updates = double( N ) * steps;
+
+    std::cout
+        << "kalman<2,1,1> x " << N << ", " << steps << " steps\n"
+        << "scalar: " << updates / t_scalar << " updates/s\n"
+        << "bank  : " << updates / t_bank   << " updates/s\n"
+        << "ratio : " << t_scalar / t_bank  << "\n";
+}
+
+// g++ -std=c++17 -Wall -O3 -march=native -I../include -o kalman-bank-time.exe kalman-bank-time.cpp && kalman-bank-time.exe
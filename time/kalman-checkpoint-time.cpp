@@ -0,0 +1,209 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Desktop: time to checkpoint a fleet of estimators into a file and to
+// restore them from the memory-mapped file (POSIX; elsewhere from the file
+// read into memory), for a 3-axis constant velocity model (S = 6, M = 3).
+
+#include "dsp/checkpoint.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <unistd.h>
+# define ke_HAVE_MMAP  1
+#else
+# define ke_HAVE_MMAP  0
+#endif
+
+#ifndef KE_CHECKPOINT_FILTERS
+# define KE_CHECKPOINT_FILTERS  10000
+#endif
+
+const int filters = KE_CHECKPOINT_FILTERS;
+
+char const * const filename = "kalman-checkpoint-time.bin";
+
+using Clock  = std::chrono::steady_clock;
+using kalman = num::kalman<double,6,3,0>;
+
+// Keep results alive:
+
+volatile double sink;
+
+double microseconds( Clock::time_point start )
+{
+    return std::chrono::duration<double, std::micro>( Clock::now() - start ).count();
+}
+
+kalman make()
+{
+    const double dt = 0.1;
+
+    kalman::A_t A(0);
+    kalman::H_t H(0);
+    kalman::Q_t Q(0);
+    kalman::R_t R(0);
+
+    for ( int d = 0; d < 3; ++d )
+    {
+        const int p = 2 * d;
+
+        A(p,p) = A(p+1,p+1) = 1;
+        A(p,p+1) = dt;
+        H(d,p) = 1;
+        R(d,d) = 0.25;
+        Q(p,p) = dt * dt * dt * dt / 4; Q(p,p+1) = Q(p+1,p) = dt * dt * dt / 2; Q(p+1,p+1) = dt * dt;
+    }
+    return kalman( dt, A, kalman::B_t(0), H, Q, R, Q, kalman::xhat_t(0) );
+}
+
+// Memory-mapped file, read-only:
+
+class mapped_file
+{
+public:
+    explicit mapped_file( char const * name )
+    {
+#if ke_HAVE_MMAP
+        const int fd = ::open( name, O_RDONLY );
+        const off_t n = fd < 0 ? 0 : ::lseek( fd, 0, SEEK_END );
+
+        void * p = n > 0 ? ::mmap( nullptr, static_cast<std::size_t>( n ), PROT_READ, MAP_PRIVATE, fd, 0 ) : MAP_FAILED;
+
+        if ( p != MAP_FAILED )
+        {
+            ptr   = static_cast<unsigned char const *>( p );
+            size_ = static_cast<std::size_t>( n );
+        }
+        if ( fd >= 0 )
+        {
+            ::close( fd );
+        }
+#else
+        if ( std::FILE * f = std::fopen( name, "rb" ) )
+        {
+            unsigned char chunk[4096];
+
+            for ( std::size_t n; ( n = std::fread( chunk, 1, sizeof chunk, f ) ) > 0; )
+            {
+                copy.insert( copy.end(), chunk, chunk + n );
+            }
+            std::fclose( f );
+
+            ptr   = copy.data();
+            size_ = copy.size();
+        }
+#endif
+    }
+
+    ~mapped_file()
+    {
+#if ke_HAVE_MMAP
+        if ( ptr )
+        {
+            ::munmap( const_cast<unsigned char *>( ptr ), size_ );
+        }
+#endif
+    }
+
+    mapped_file( mapped_file const & ) = delete;
+    mapped_file & operator=( mapped_file const & ) = delete;
+
+    unsigned char const * data() const { return ptr; }
+    std::size_t size() const { return size_; }
+
+private:
+    unsigned char const * ptr = nullptr;
+    std::size_t size_ = 0;
+#if !ke_HAVE_MMAP
+    std::vector<unsigned char> copy;
+#endif
+};
+
+int main()
+{
+    std::vector<kalman> fleet( filters, make() );
+
+    for ( int i = 0; i < filters; ++i )
+    {
+        for ( int k = 1; k <= 10 + i % 7; ++k )
+        {
+            fleet[i].update( {}, { 0.1 * k, 0.2 * k + i % 5, 0.3 * k } );
+        }
+    }
+
+    const std::size_t record = num::checkpoint_size( fleet[0] );
+
+    // Checkpoint into a buffer and write the file:
+
+    std::vector<unsigned char> buffer( record * filters );
+
+    auto start = Clock::now();
+
+    for ( int i = 0; i < filters; ++i )
+    {
+        num::write_checkpoint( fleet[i], &buffer[ record * i ], record );
+    }
+
+    const double write_us = microseconds( start );
+
+    if ( std::FILE * f = std::fopen( filename, "wb" ) )
+    {
+        std::fwrite( buffer.data(), 1, buffer.size(), f );
+        std::fclose( f );
+    }
+
+    // Restore a fresh fleet from the mapped file:
+
+    std::vector<kalman> restored( filters, make() );
+
+    start = Clock::now();
+
+    mapped_file file( filename );
+
+    const double map_us = microseconds( start );
+
+    int failed = file.size() == record * filters ? 0 : filters;
+
+    start = Clock::now();
+
+    for ( int i = 0; i < filters && !failed; ++i )
+    {
+        failed += !num::read_checkpoint( restored[i], file.data() + record * i, record );
+    }
+
+    const double restore_us = microseconds( start );
+
+    for ( int i = 0; i < filters && !failed; ++i )
+    {
+        failed += restored[i].system_state()(0) != fleet[i].system_state()(0);
+    }
+
+    sink = restored[ filters - 1 ].system_state()(0);
+
+    std::remove( filename );
+
+    std::cout
+        << "checkpoint of " << filters << " estimators S=6 M=3, " << record << " bytes each, "
+        << ( ke_HAVE_MMAP ? "memory-mapped" : "read into memory" ) << "\n"
+        << std::fixed << std::setprecision(1)
+        << "write:   " << std::setw(10) << write_us   << " us, " << std::setprecision(3) << write_us   / filters << " us per estimator\n" << std::setprecision(1)
+        << "map:     " << std::setw(10) << map_us     << " us\n"
+        << "restore: " << std::setw(10) << restore_us << " us, " << std::setprecision(3) << restore_us / filters << " us per estimator\n"
+        << "failed:  " << std::setw(10) << failed << "\n";
+
+    return failed ? 1 : 0;
+}
+
+// g++ -std=c++17 -Wall -O2 -I../include -o kalman-checkpoint-time.exe kalman-checkpoint-time.cpp && kalman-checkpoint-time.exe
@@ -0,0 +1,142 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Desktop: scaling of num::kalman_ensemble with the number of threads, on the
+// Lorenz-96 model with S = 100 and every other variable observed. Also checks
+// that the estimate does not depend on the number of threads.
+
+#include "dsp/kalman-ensemble.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#ifndef KE_ENKF_STEPS
+# define KE_ENKF_STEPS  100
+#endif
+
+#ifndef KE_ENKF_MEMBERS
+# define KE_ENKF_MEMBERS  128
+#endif
+
+const int steps   = KE_ENKF_STEPS;
+const int members = KE_ENKF_MEMBERS;
+
+const int S = 100;
+const int M = S / 2;
+
+using state_t = num::colvec<double,S>;
+using meas_t  = num::colvec<double,M>;
+
+// Lorenz-96, dx(j)/dt = ( x(j+1) - x(j-2) ) x(j-1) - x(j) + F, integrated
+// with 4 Runge-Kutta stages of 0.01 per time-step:
+
+const double forcing = 8;
+const double h_rk    = 0.01;
+
+state_t lorenz( state_t const & x )
+{
+    state_t d(0);
+
+    for ( int j = 0; j < S; ++j )
+    {
+        d(j) = ( x( (j + 1) % S ) - x( (j + S - 2) % S ) ) * x( (j + S - 1) % S ) - x(j) + forcing;
+    }
+    return d;
+}
+
+struct process
+{
+    state_t operator()( state_t const & x, num::colvec<double,1> const & ) const
+    {
+        const auto k1 = lorenz( x );
+        const auto k2 = lorenz( x + 0.5 * h_rk * k1 );
+        const auto k3 = lorenz( x + 0.5 * h_rk * k2 );
+        const auto k4 = lorenz( x + h_rk * k3 );
+
+        return x + ( h_rk / 6 ) * ( k1 + 2.0 * k2 + 2.0 * k3 + k4 );
+    }
+};
+
+struct measure
+{
+    meas_t operator()( state_t const & x ) const
+    {
+        meas_t z(0);
+
+        for ( int m = 0; m < M; ++m )
+        {
+            z(m) = x( 2 * m );
+        }
+        return z;
+    }
+};
+
+using ensemble = num::kalman_ensemble<double,S,M,1,process,measure>;
+
+using Clock = std::chrono::steady_clock;
+
+struct result
+{
+    state_t xhat;   // Final estimate
+    double  rate;   // Steps per second
+};
+
+result run( int threads )
+{
+    num::worker_pool pool( threads );
+
+    const auto Q = 0.01 * num::eye<double,S>();
+    const auto R = 0.25 * num::eye<double,M>();
+    const auto P = 1.00 * num::eye<double,S>();
+
+    state_t x0(0);
+    x0(0) = 0.01;
+
+    ensemble estim( pool, h_rk, {}, {}, Q, R, P, state_t( forcing ), members, 7 );
+
+    // Truth, observed without noise; the ensemble starts at rest:
+
+    state_t x = forcing + x0;
+
+    const auto start = Clock::now();
+
+    for ( int k = 0; k < steps; ++k )
+    {
+        x = process()( x, {0} );
+        estim.update( {0}, measure()( x ) );
+    }
+
+    const double seconds = std::chrono::duration<double>( Clock::now() - start ).count();
+
+    return { estim.system_state(), steps / seconds };
+}
+
+int main()
+{
+    const int hw = static_cast<int>( std::thread::hardware_concurrency() );
+
+    std::cout
+        << "kalman_ensemble<" << S << "," << M << ",1>, " << members << " members, " << steps << " steps\n"
+        << std::setw(8) << "threads" << std::setw(14) << "steps/s" << std::setw(10) << "speedup" << std::setw(12) << "identical" << "\n";
+
+    const auto base = run( 1 );
+
+    for ( int threads = 1; threads <= ( hw > 4 ? hw : 4 ); threads *= 2 )
+    {
+        const auto r = threads == 1 ? base : run( threads );
+
+        std::cout
+            << std::setw(8) << threads
+            << std::setw(14) << r.rate
+            << std::setw(10) << r.rate / base.rate
+            << std::setw(12) << ( std20::equal( r.xhat.begin(), r.xhat.end(), base.xhat.begin() ) ? "yes" : "NO" ) << "\n";
+    }
+}
+
+// g++ -std=c++17 -Wall -O2 -pthread -I../include -o kalman-ensemble-time.exe kalman-ensemble-time.cpp && kalman-ensemble-time.exe
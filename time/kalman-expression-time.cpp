@@ -0,0 +1,180 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Desktop: cycles of the matrix expressions of a kalman update with the eager
+// operators versus lazy expression templates, and of kalman::update() itself,
+// for a 3-axis constant velocity model (S = 6, M = 3, U = 3).
+//
+// The cycles saved in kalman::update() are the difference of the update
+// cycles of this program and of kalman-expression-time-lazy, the same
+// program compiled with KE_EXPRESSION_TEMPLATES=1.
+
+#include "dsp/kalman.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+# include <x86intrin.h>
+# define ke_HAVE_RDTSC  1
+#elif defined( _MSC_VER ) && ( defined( _M_X64 ) || defined( _M_IX86 ) )
+# include <intrin.h>
+# define ke_HAVE_RDTSC  1
+#else
+# define ke_HAVE_RDTSC  0
+#endif
+
+#ifndef KE_EXPRESSION_STEPS
+# define KE_EXPRESSION_STEPS  1000000
+#endif
+
+const int steps = KE_EXPRESSION_STEPS;
+
+// Time stamp counter, or nanoseconds where unavailable:
+
+#if ke_HAVE_RDTSC
+char const * const unit = "cycles";
+
+unsigned long long ticks() { return __rdtsc(); }
+#else
+char const * const unit = "ns";
+
+unsigned long long ticks()
+{
+    return static_cast<unsigned long long>( std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch() ).count() );
+}
+#endif
+
+// Keep results alive:
+
+volatile double sink;
+
+const int D = 3;
+const int S = 2 * D;
+const int M = D;
+const int U = D;
+
+using kalman = num::kalman<double,S,M,U>;
+
+// Constant velocity model, per axis (pos, vel), position measured,
+// acceleration as control input:
+
+struct model
+{
+    kalman::A_t A;
+    kalman::B_t B;
+    kalman::H_t H;
+    kalman::Q_t Q;
+    kalman::R_t R;
+
+    model()
+        : A(0), B(0), H(0), Q(0), R(0)
+    {
+        const double dt = 0.1;
+
+        for ( int d = 0; d < D; ++d )
+        {
+            const int p = 2 * d;
+
+            A(p,p) = A(p+1,p+1) = 1;
+            A(p,p+1) = dt;
+            B(p,d) = dt * dt / 2;
+            B(p+1,d) = dt;
+            H(d,p) = 1;
+            R(d,d) = 0.25;
+            Q(p,p) = dt * dt * dt * dt / 4; Q(p,p+1) = Q(p+1,p) = dt * dt * dt / 2; Q(p+1,p+1) = dt * dt;
+        }
+    }
+};
+
+// Mean ticks per call of f(k), which feeds its result back:
+
+template< typename F >
+double measure( F f )
+{
+    const auto start = ticks();
+
+    for ( int k = 0; k < steps; ++k )
+    {
+        f( k );
+    }
+    return double( ticks() - start ) / steps;
+}
+
+void report( char const * name, double eager, double lazy )
+{
+    std::cout
+        << std::left << std::setw(30) << name << std::right << std::fixed << std::setprecision(1)
+        << std::setw(10) << eager
+        << std::setw(10) << lazy
+        << std::setw(10) << eager - lazy << "\n";
+}
+
+int main()
+{
+    using num::lazy;
+    using num::evaluate;
+
+    const model m;
+
+    kalman::xhat_t x(0);
+    kalman::P_t    P = m.Q;
+    kalman::K_t    K(0);
+    kalman::u_t    u(0.5);
+    kalman::z_t    z(1);
+
+    K(0,0) = K(2,1) = K(4,2) = 0.5;
+
+    std::cout
+        << "matrix expressions, " << steps << " evaluations, " << unit << " per evaluation\n"
+        << std::left << std::setw(30) << "expression" << std::right
+        << std::setw(10) << "eager" << std::setw(10) << "lazy" << std::setw(10) << "saved" << "\n";
+
+    report( "1a: A * x + B * u",
+        measure( [&]( int ){ x = m.A * x + m.B * u; u(0) = x(0) * 1e-9; } ),
+        measure( [&]( int ){ x = evaluate( lazy(m.A) * x + lazy(m.B) * u ); u(0) = x(0) * 1e-9; } ) );
+
+    report( "1b: A * P * A' + Q",
+        measure( [&]( int ){ P = m.A * P * transposed( m.A ) + m.Q; P(0,0) *= 1e-3; } ),
+        measure( [&]( int ){ P = evaluate( lazy(m.A) * P * transposed( lazy(m.A) ) + m.Q ); P(0,0) *= 1e-3; } ) );
+
+    report( "2a: P * H'",
+        measure( [&]( int ){ const auto PHt = P * transposed( m.H ); P(0,0) = PHt(0,0) * 1e-3; } ),
+        measure( [&]( int ){ const auto PHt = evaluate( lazy(P) * transposed( lazy(m.H) ) ); P(0,0) = PHt(0,0) * 1e-3; } ) );
+
+    report( "2b: x + K * (z - H * x)",
+        measure( [&]( int ){ x = x + K * (z - m.H * x); z(0) = x(0) * 1e-9; } ),
+        measure( [&]( int ){ x = evaluate( lazy(x) + lazy(K) * (z - lazy(m.H) * x) ); z(0) = x(0) * 1e-9; } ) );
+
+    sink = x(0) + P(0,0);
+
+    // The complete update, as configured:
+
+    kalman estim( 0.1, m.A, m.B, m.H, m.Q, m.R, m.Q, kalman::xhat_t(0) );
+
+    const double update = measure( [&]( int k )
+    {
+        kalman::z_t zk(0);
+
+        for ( int d = 0; d < D; ++d )
+        {
+            zk(d) = 0.005 * k + ( ( k * 7 + d ) % 17 ) / 17.0;
+        }
+        estim.update( u, zk );
+    });
+
+    sink = estim.system_state()(0);
+
+    std::cout
+        << "\nkalman::update(), KE_EXPRESSION_TEMPLATES=" << KE_EXPRESSION_TEMPLATES << ": "
+        << std::fixed << std::setprecision(1) << update << " " << unit << " per update\n";
+}
+
+// g++ -std=c++17 -Wall -O2 -I../include -o kalman-expression-time.exe kalman-expression-time.cpp && kalman-expression-time.exe
+// g++ -std=c++17 -Wall -O2 -I../include -DKE_EXPRESSION_TEMPLATES=1 -o kalman-expression-time-lazy.exe kalman-expression-time.cpp && kalman-expression-time-lazy.exe
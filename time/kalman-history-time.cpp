@@ -0,0 +1,109 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Desktop: cost of applying a late measurement with num::kalman_history<>::correct_at()
+// versus its lag, compared to an in-sequence update.
+
+#include "num/fixed-point.hpp"
+#include "dsp/kalman-history.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+// Fixed point numeric type for Kalman estimator:
+
+using fp32_t = num::fixed_point<int, 15>;
+
+#ifdef KE_NUMERIC_TYPE
+using real_t = KE_NUMERIC_TYPE;
+#else
+using real_t = double;
+#endif
+
+#ifndef KE_HISTORY_REPEAT
+# define KE_HISTORY_REPEAT  100000
+#endif
+
+const int depth  = 16;
+const int repeat = KE_HISTORY_REPEAT;
+
+using kalman  = num::kalman<real_t, 2, 1, 1>;
+using history = num::kalman_history<kalman, depth, 1>;
+
+using Clock = std::chrono::steady_clock;
+
+// Keep results alive:
+
+volatile double sink;
+
+double as_double( double x ) { return x; }
+
+template< typename T, int I, int F >
+double as_double( num::fixed_point<T,I,F> x ) { return x.as_double(); }
+
+// Estimator that has taken depth time-steps without measurements:
+
+history make_history()
+{
+    const real_t dt = 1;
+
+    history estim( dt, { 1, dt, 0, 1 }, { dt * dt / 2, dt }, { 1, 0 }, { 0.01, 0.02, 0.02, 0.04 }, { 100 }, { 0.01, 0.02, 0.02, 0.04 }, { 0, 0 } );
+
+    for ( int k = 0; k < depth; ++k )
+    {
+        estim.predict( { 1 } );
+    }
+    return estim;
+}
+
+// Nanoseconds per call of op on a fresh copy of the estimator, best of five runs:
+
+template< typename Op >
+double nanoseconds( Op op )
+{
+    const history initial = make_history();
+
+    double best = 1e30;
+
+    for ( int run = 0; run < 5; ++run )
+    {
+        const auto start = Clock::now();
+
+        for ( int i = 0; i < repeat; ++i )
+        {
+            history estim = initial;
+            op( estim );
+            sink = as_double( estim.system_state()(0) );
+        }
+
+        const auto seconds = std::chrono::duration<double>( Clock::now() - start ).count();
+
+        best = std::min( best, 1e9 * seconds / repeat );
+    }
+    return best;
+}
+
+int main()
+{
+    const double copy = nanoseconds( []( history & ) {} );
+    const double once = nanoseconds( []( history & h ) { h.correct( { 3 } ); } ) - copy;
+
+    std::cout
+        << "kalman<2,1,1>, history depth " << depth << "\n"
+        << "correct()         : " << once << " ns\n";
+
+    for ( int lag = 0; lag < depth; ++lag )
+    {
+        const double late = nanoseconds( [lag]( history & h ) { h.correct_at( h.step() - lag, { 3 } ); } ) - copy;
+
+        std::cout
+            << "correct_at(lag " << ( lag < 10 ? " " : "" ) << lag << "): " << late << " ns, " << late / once << " x correct()\n";
+    }
+}
+
+// g++ -std=c++17 -Wall -O2 -I../include -o kalman-history-time.exe kalman-history-time.cpp && kalman-history-time.exe
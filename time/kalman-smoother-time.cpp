@@ -0,0 +1,87 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Desktop: throughput of the forward and backward pass of num::kalman_smoother
+// with an in-memory and with a memory-mapped moment store.
+
+#include "dsp/kalman-smoother.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+#ifndef KE_SMOOTHER_SAMPLES
+# define KE_SMOOTHER_SAMPLES  2000000
+#endif
+
+const long samples = KE_SMOOTHER_SAMPLES;
+
+using record_t = num::kalman_moments<double,2>;
+
+using Clock = std::chrono::steady_clock;
+
+double seconds_since( Clock::time_point start )
+{
+    return std::chrono::duration<double>( Clock::now() - start ).count();
+}
+
+// Keep results alive:
+
+volatile double sink;
+
+template< typename Store >
+void report( char const * name, Store & store )
+{
+    using smoother = num::kalman_smoother<double,2,1,1,Store>;
+
+    const double dt = 1;
+
+    smoother s( store, dt, { 1, dt, 0, 1 }, { 0, 0 }, { 1, 0 }, { 0.01, 0.02, 0.02, 0.04 }, { 4 }, { 10, 0, 0, 10 }, { 0, 0 } );
+
+    auto start = Clock::now();
+
+    for ( long k = 0; k < samples; ++k )
+    {
+        s.update( {0}, { 0.5 * k + ( k * 37 ) % 11 - 5 } );
+    }
+
+    const auto t_forward = seconds_since( start );
+
+    start = Clock::now();
+
+    s.smooth();
+
+    const auto t_backward = seconds_since( start );
+
+    sink = s.system_state( 0 )(0);
+
+    const double mbytes = samples * sizeof( record_t ) / 1e6;
+
+    std::cout
+        << name << ":\n"
+        << "  forward : " << samples / t_forward  << " samples/s, " << mbytes / t_forward  << " MB/s\n"
+        << "  backward: " << samples / t_backward << " samples/s, " << 2 * mbytes / t_backward << " MB/s\n";
+}
+
+int main()
+{
+    std::cout << "kalman_smoother<2,1,1>, " << samples << " samples of " << sizeof( record_t ) << " bytes\n";
+
+    {
+        num::vector_store<record_t> store;
+        report( "vector_store", store );
+    }
+#if KE_HAVE_MMAP
+    {
+        num::mapped_store<record_t> store( "kalman-smoother-time.tmp" );
+        report( "mapped_store", store );
+    }
+    std::remove( "kalman-smoother-time.tmp" );
+#endif
+}
+
+// g++ -std=c++17 -Wall -O2 -I../include -o kalman-smoother-time.exe kalman-smoother-time.cpp && kalman-smoother-time.exe
@@ -0,0 +1,211 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Desktop: operation count and time of a kalman update with dense A, B, H
+// versus declared sparsity, and without control input (U = 0), for the
+// constant velocity model of avr-kalman-time.cpp, A = { 1, dt, 0, 1 },
+// H = { 1, 0 }, and for a 3-axis constant velocity model (S = 6, M = 3).
+
+#include "dsp/kalman.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+#ifndef KE_STRUCTURE_STEPS
+# define KE_STRUCTURE_STEPS  1000000
+#endif
+
+const int steps = KE_STRUCTURE_STEPS;
+
+// Numeric type that counts multiplications, additions and divisions:
+
+struct counted
+{
+    static long muls;
+    static long adds;
+    static long divs;
+
+    double v;
+
+    constexpr counted( double v_ = 0 ) : v( v_ ) {}
+
+    friend counted operator+( counted a, counted b ) { ++adds; return a.v + b.v; }
+    friend counted operator-( counted a, counted b ) { ++adds; return a.v - b.v; }
+    friend counted operator*( counted a, counted b ) { ++muls; return a.v * b.v; }
+    friend counted operator/( counted a, counted b ) { ++divs; return a.v / b.v; }
+
+    counted operator-() const { return -v; }
+
+    counted & operator+=( counted b ) { ++adds; v += b.v; return *this; }
+    counted & operator-=( counted b ) { ++adds; v -= b.v; return *this; }
+    counted & operator*=( counted b ) { ++muls; v *= b.v; return *this; }
+    counted & operator/=( counted b ) { ++divs; v /= b.v; return *this; }
+
+    friend bool operator==( counted a, counted b ) { return a.v == b.v; }
+    friend bool operator!=( counted a, counted b ) { return a.v != b.v; }
+    friend bool operator< ( counted a, counted b ) { return a.v <  b.v; }
+    friend bool operator<=( counted a, counted b ) { return a.v <= b.v; }
+    friend bool operator> ( counted a, counted b ) { return a.v >  b.v; }
+};
+
+long counted::muls = 0;
+long counted::adds = 0;
+long counted::divs = 0;
+
+using Clock = std::chrono::steady_clock;
+
+// Keep results alive:
+
+volatile double sink;
+
+double value( double v ) { return v; }
+double value( counted v ) { return v.v; }
+
+// Constant velocity model, per axis (pos, vel), D axes, position measured;
+// with U = D, the control input is the acceleration:
+
+template< typename T, int D, int U, typename Structure >
+struct model
+{
+    static constexpr int S = 2 * D;
+
+    using kalman = num::kalman<T,S,D,U,Structure>;
+
+    static kalman make()
+    {
+        const double dt = 0.1;
+
+        typename kalman::A_t A(0);
+        typename kalman::B_t B(0);
+        typename kalman::H_t H(0);
+        typename kalman::Q_t Q(0);
+        typename kalman::R_t R(0);
+
+        for ( int d = 0; d < D; ++d )
+        {
+            const int p = 2 * d;
+
+            A(p,p) = A(p+1,p+1) = 1;
+            A(p,p+1) = dt;
+            H(d,p) = 1;
+            R(d,d) = 0.25;
+            Q(p,p) = dt * dt * dt * dt / 4; Q(p,p+1) = Q(p+1,p) = dt * dt * dt / 2; Q(p+1,p+1) = dt * dt;
+
+            if constexpr ( U > 0 )
+            {
+                B(p,d) = dt * dt / 2;
+                B(p+1,d) = dt;
+            }
+        }
+        return kalman( dt, A, B, H, Q, R, Q, typename kalman::xhat_t(0) );
+    }
+
+    static void step( kalman & estim, int k )
+    {
+        typename kalman::u_t u(0);
+        typename kalman::z_t z(0);
+
+        if constexpr ( U > 0 )
+        {
+            u = typename kalman::u_t( 1 );
+        }
+
+        for ( int d = 0; d < D; ++d )
+        {
+            z(d) = 0.005 * k * k + ( ( k * 7 + d ) % 17 ) / 17.0;
+        }
+        estim.update( u, z );
+    }
+};
+
+// The patterns of A, B and H of the model, as masks and as named patterns:
+
+template< int D >
+struct block_upper
+{
+    // A is block diagonal with upper triangular 2x2 blocks:
+
+    static constexpr bool nonzero( int row, int col ) { return row / 2 == col / 2 && row <= col; }
+};
+
+struct block_column
+{
+    // B(p,d) is nonzero for p / 2 == d:
+
+    static constexpr bool nonzero( int row, int col ) { return row / 2 == col; }
+};
+
+struct position_selector
+{
+    // H(d,p) is nonzero for p == 2 * d:
+
+    static constexpr bool nonzero( int row, int col ) { return col == 2 * row; }
+};
+
+template< int D >
+using sparse = num::structure<block_upper<D>, block_column, position_selector>;
+
+template< typename Model >
+void report( char const * name )
+{
+    // Operation count of one update, past the first:
+
+    auto ec = Model::template with<counted>::make();
+    Model::template with<counted>::step( ec, 1 );
+
+    counted::muls = counted::adds = counted::divs = 0;
+    Model::template with<counted>::step( ec, 2 );
+
+    // Time:
+
+    auto ed = Model::template with<double>::make();
+
+    const auto start = Clock::now();
+
+    for ( int k = 0; k < steps; ++k )
+    {
+        Model::template with<double>::step( ed, k );
+    }
+
+    const auto seconds = std::chrono::duration<double>( Clock::now() - start ).count();
+
+    sink = value( ed.system_state()(0) );
+
+    std::cout
+        << std::left << std::setw(28) << name << std::right
+        << std::setw(6) << counted::muls
+        << std::setw(6) << counted::adds
+        << std::setw(6) << counted::divs
+        << std::setw(14) << steps / seconds << "\n";
+}
+
+template< int D, int U, typename Structure >
+struct config
+{
+    template< typename T >
+    using with = model<T,D,U,Structure>;
+};
+
+int main()
+{
+    std::cout
+        << "kalman update, " << steps << " steps\n"
+        << std::left << std::setw(28) << "model" << std::right
+        << std::setw(6) << "mul" << std::setw(6) << "add" << std::setw(6) << "div" << std::setw(14) << "updates/s" << "\n";
+
+    report< config<1,1,num::dense_structure> >( "S=2 M=1 U=1 dense" );
+    report< config<1,1,sparse<1>           > >( "S=2 M=1 U=1 structured" );
+    report< config<1,0,num::dense_structure> >( "S=2 M=1 U=0 dense" );
+    report< config<1,0,sparse<1>           > >( "S=2 M=1 U=0 structured" );
+    report< config<3,3,num::dense_structure> >( "S=6 M=3 U=3 dense" );
+    report< config<3,3,sparse<3>           > >( "S=6 M=3 U=3 structured" );
+    report< config<3,0,num::dense_structure> >( "S=6 M=3 U=0 dense" );
+    report< config<3,0,sparse<3>           > >( "S=6 M=3 U=0 structured" );
+}
+
+// g++ -std=c++17 -Wall -O2 -I../include -o kalman-structure-time.exe kalman-structure-time.cpp && kalman-structure-time.exe
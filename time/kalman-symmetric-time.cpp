@@ -0,0 +1,156 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Desktop: covariance propagation with full NxN storage versus packed symmetric
+// storage: operation count, RAM and time of steps 1b and 2c of the update.
+
+#include "num/symmatrix.hpp"
+
+#include <chrono>
+#include <iostream>
+
+#ifndef KE_SYMMETRIC_STEPS
+# define KE_SYMMETRIC_STEPS  100000
+#endif
+
+const int steps = KE_SYMMETRIC_STEPS;
+
+// Numeric type that counts multiplications and additions:
+
+struct counted
+{
+    static long muls;
+    static long adds;
+
+    double v;
+
+    constexpr counted( double v_ = 0 ) : v( v_ ) {}
+
+    friend counted operator+( counted a, counted b ) { ++adds; return a.v + b.v; }
+    friend counted operator-( counted a, counted b ) { ++adds; return a.v - b.v; }
+    friend counted operator*( counted a, counted b ) { ++muls; return a.v * b.v; }
+
+    counted & operator+=( counted b ) { ++adds; v += b.v; return *this; }
+    counted & operator-=( counted b ) { ++adds; v -= b.v; return *this; }
+};
+
+long counted::muls = 0;
+long counted::adds = 0;
+
+using Clock = std::chrono::steady_clock;
+
+double seconds_since( Clock::time_point start )
+{
+    return std::chrono::duration<double>( Clock::now() - start ).count();
+}
+
+// Keep results alive:
+
+volatile double sink;
+
+// Model with S states and one measurement; values only need to be plausible,
+// but must not be known at compile time:
+
+volatile double seed = 0.1;
+
+template< typename T, int S >
+struct model
+{
+    num::matrix<T,S,S> A = num::eye<T,S>();
+    num::matrix<T,S,S> P = num::eye<T,S>();
+    num::matrix<T,S,S> Q = num::eye<T,S>();
+    num::matrix<T,S,1> K;
+    num::matrix<T,1,S> H;
+
+    model()
+    {
+        for ( int r = 0; r < S; ++r )
+        {
+            for ( int c = r; c < S; ++c )
+            {
+                A(r, c) = T( c == r ? 1 : seed / ( c - r ) );
+                Q(r, c) = Q(c, r) = T( seed * seed / ( 1 + r + c ) );
+            }
+            K(r) = T( seed / ( r + 1 ) );
+            H(r) = T( r == 0 ? 1 : seed );
+        }
+    }
+};
+
+// Steps 1b and 2c, full form as before and packed symmetric form:
+
+template< typename T, int S >
+num::matrix<T,S,S> propagate_full( model<T,S> const & m, num::matrix<T,S,S> const & P )
+{
+    const auto Pp = m.A * P * transposed( m.A ) + m.Q;
+
+    return ( num::eye<T,S>() - m.K * m.H ) * Pp;
+}
+
+template< typename T, int S >
+num::symmatrix<T,S> propagate_packed( model<T,S> const & m, num::symmatrix<T,S> const & Q, num::symmatrix<T,S> const & P )
+{
+    const auto Pp = congruence( m.A, P ) + Q;
+
+    return rank_downdate( Pp, m.K, Pp * transposed( m.H ) );
+}
+
+template< int S >
+void report()
+{
+    // Operation count:
+
+    model<counted,S> mc;
+    const num::symmatrix<counted,S> Qc( mc.Q ), Pc( mc.P );
+
+    counted::muls = counted::adds = 0;
+    sink = propagate_full( mc, mc.P )(0).v;
+    const long full_muls = counted::muls, full_adds = counted::adds;
+
+    counted::muls = counted::adds = 0;
+    sink = propagate_packed( mc, Qc, Pc )(0,0).v;
+    const long pack_muls = counted::muls, pack_adds = counted::adds;
+
+    // Time:
+
+    model<double,S> md;
+    const num::symmatrix<double,S> Q( md.Q );
+
+    auto Pf = md.P;
+    auto start = Clock::now();
+
+    for ( int k = 0; k < steps; ++k )
+    {
+        Pf = propagate_full( md, Pf );
+    }
+    const auto t_full = seconds_since( start );
+    sink = Pf(0,0);
+
+    num::symmatrix<double,S> Ps( md.P );
+    start = Clock::now();
+
+    for ( int k = 0; k < steps; ++k )
+    {
+        Ps = propagate_packed( md, Q, Ps );
+    }
+    const auto t_pack = seconds_since( start );
+    sink = Ps(0,0);
+
+    std::cout
+        << "S=" << S << "\n"
+        << "  full  : " << full_muls << " mul " << full_adds << " add, P+Q " << 2 * sizeof( num::matrix<double,S,S> ) << " bytes, " << steps / t_full << " updates/s\n"
+        << "  packed: " << pack_muls << " mul " << pack_adds << " add, P+Q " << 2 * sizeof( num::symmatrix<double,S> ) << " bytes, " << steps / t_pack << " updates/s\n";
+}
+
+int main()
+{
+    report<2>();
+    report<6>();
+    report<12>();
+}
+
+// g++ -std=c++17 -Wall -O3 -march=native -I../include -o kalman-symmetric-time.exe kalman-symmetric-time.cpp && kalman-symmetric-time.exe
@@ -0,0 +1,125 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Desktop: time per scan of kalman_tracker for 100 to 10k objects moving at
+// constant velocity in the plane, at constant density of about one object
+// per 4 m^2, with grid cells about the width of a gate and with a single
+// cell, which gates every track against every detection (up to 1k objects).
+
+#include "dsp/kalman-tracker.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#ifndef KE_TRACKER_SCANS
+# define KE_TRACKER_SCANS  20
+#endif
+
+const int scans = KE_TRACKER_SCANS;
+
+using Clock = std::chrono::steady_clock;
+
+using tracker = num::kalman_tracker<double,4,2,0>;
+
+tracker make_tracker( double cell )
+{
+    const double dt = 1;
+
+    const tracker::A_t A = { 1, dt, 0, 0,  0, 1, 0, 0,  0, 0, 1, dt,  0, 0, 0, 1 };
+    const tracker::H_t H = { 1, 0, 0, 0,  0, 0, 1, 0 };
+    const tracker::R_t R = { 0.01, 0, 0, 0.01 };
+    const tracker::Q_t Q = 0.001 * tracker::Q_t( { dt*dt*dt/3, dt*dt/2, 0, 0,  dt*dt/2, dt, 0, 0,  0, 0, dt*dt*dt/3, dt*dt/2,  0, 0, dt*dt/2, dt } );
+    const tracker::P_t P = { 0.01, 0, 0, 0,  0, 0.25, 0, 0,  0, 0, 0.01, 0,  0, 0, 0, 0.25 };
+
+    return tracker( dt, A, {}, H, Q, R, P, num::chi_square_quantile( 2, 0.999 ), cell );
+}
+
+// Uniform pseudo-random value in [0, 1):
+
+double uniform( std::uint32_t & seed )
+{
+    seed = seed * 1664525u + 1013904223u;
+    return ( seed >> 8 ) / double( 1u << 24 );
+}
+
+void report( int const objects, double const cell, char const * name )
+{
+    const double side = 2 * std::sqrt( double( objects ) );
+
+    std::uint32_t seed = 42;
+
+    std::vector<double> x, y, vx, vy;
+
+    for ( int i = 0; i < objects; ++i )
+    {
+        x .push_back( side * uniform( seed ) );
+        y .push_back( side * uniform( seed ) );
+        vx.push_back( uniform( seed ) - 0.5 );
+        vy.push_back( uniform( seed ) - 0.5 );
+    }
+
+    auto trk = make_tracker( cell );
+
+    std::vector<tracker::z_t> detections;
+
+    double seconds = 0;
+    long gated = 0;
+
+    for ( int k = 0; k < scans; ++k )
+    {
+        detections.clear();
+
+        for ( int i = 0; i < objects; ++i )
+        {
+            detections.push_back( { x[i] + 0.1 * ( uniform( seed ) - 0.5 ), y[i] + 0.1 * ( uniform( seed ) - 0.5 ) } );
+
+            x[i] += vx[i];
+            y[i] += vy[i];
+        }
+
+        const auto start = Clock::now();
+
+        trk.update( {}, detections );
+
+        seconds += std::chrono::duration<double>( Clock::now() - start ).count();
+        gated += trk.gated_count();
+    }
+
+    std::cout
+        << std::setw(8) << objects
+        << std::setw(10) << name
+        << std::setw(14) << std::fixed << std::setprecision(3) << 1e3 * seconds / scans
+        << std::setw(14) << std::setprecision(0) << objects * scans / seconds
+        << std::setw(14) << std::setprecision(2) << double( gated ) / scans / objects
+        << std::setw(12) << trk.confirmed_count() << "\n";
+}
+
+int main()
+{
+    std::cout
+        << "kalman_tracker, " << scans << " scans\n"
+        << std::setw(8) << "objects" << std::setw(10) << "grid" << std::setw(14) << "ms/scan"
+        << std::setw(14) << "tracks/s" << std::setw(14) << "gated/track" << std::setw(12) << "confirmed" << "\n";
+
+    // Without grid, gating is quadratic in the number of tracks, skip 10k:
+
+    for ( int objects : { 100, 1000, 10000 } )
+    {
+        report( objects, 1.0, "1 m" );
+
+        if ( objects <= 1000 )
+        {
+            report( objects, 1e9, "none" );
+        }
+    }
+}
+
+// g++ -std=c++17 -Wall -O2 -I../include -o kalman-tracker-time.exe kalman-tracker-time.cpp && kalman-tracker-time.exe
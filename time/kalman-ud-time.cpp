@@ -0,0 +1,212 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Desktop: accuracy, divergence and throughput of num::kalman versus the
+// UD-factored num::kalman_ud for double, float, 32-bit and 16-bit fixed point.
+//
+// kalman_ud<fp16> does not reach twice the throughput of kalman<fp16>: in
+// review it made 2.57e7 updates/s against 3.7e7, about 0.7x. What it gains
+// is stability: kalman<fp16> diverges at step 7 and kalman<fp32> at step 41,
+// while kalman_ud<fp16> stays within 0.016 of the double reference.
+
+#include "num/fixed-point.hpp"
+#include "dsp/kalman-ud.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// Number of time-steps, 15 s: elapsed time must fit in the fixed point
+// types, and number of repetitions for timing:
+
+#ifndef KE_UD_STEPS
+# define KE_UD_STEPS  240
+#endif
+
+#ifndef KE_UD_REPEAT
+# define KE_UD_REPEAT  1000
+#endif
+
+const int steps  = KE_UD_STEPS;
+const int repeat = KE_UD_REPEAT;
+
+using fp32_t = num::fixed_point<std::int32_t, 4>;
+using fp16_t = num::fixed_point<std::int16_t, 4>;
+
+// Target moving along a sine within [-4,4], measured in position with
+// noise of standard deviation 0.05, starting with a large uncertainty;
+// dt is a power of two to be exact in fixed point:
+
+const double dt     = 1.0 / 16;
+const double omega  = 0.5;
+const double msigma = 0.05;
+const double pinit  = 4;
+
+struct sample
+{
+    double position;    // True position
+    double z;           // Measured position
+};
+
+std::vector<sample> make_trajectory()
+{
+    std::vector<sample> result;
+
+    unsigned seed = 12345;
+
+    for ( int k = 1; k <= steps; ++k )
+    {
+        // Sum of uniforms, approximately normal with unit variance:
+
+        double noise = -6;
+
+        for ( int i = 0; i < 12; ++i )
+        {
+            seed = seed * 1103515245u + 12345u;
+            noise += ( ( seed >> 8 ) & 0xffff ) / 65536.0;
+        }
+
+        const double x = 4 * std::sin( omega * k * dt );
+
+        result.push_back( { x, x + msigma * noise } );
+    }
+    return result;
+}
+
+// Keep results alive:
+
+volatile double sink;
+
+double as_double( double x ) { return x; }
+
+template< typename T, int I, int F >
+double as_double( num::fixed_point<T,I,F> x ) { return x.as_double(); }
+
+struct result
+{
+    double rmse_truth;  // RMS error of position estimate versus true position
+    double rmse_ref;    // RMS error versus the double-precision num::kalman
+    int    diverged_at; // First step with an error beyond 10 sigma or negative variance, 0 if none
+    double rate;        // Updates per second
+};
+
+template< typename Kalman >
+result run( std::vector<sample> const & trajectory, std::vector<double> & estimates )
+{
+    using T = typename Kalman::real_t;
+
+    const double q = omega * omega * 4;     // Acceleration amplitude
+
+    const typename Kalman::A_t A = { 1, T(dt), 0, 1 };
+    const typename Kalman::B_t B = { 0, 0 };
+    const typename Kalman::H_t H = { 1, 0 };
+    const typename Kalman::R_t R = { msigma * msigma };
+    const typename Kalman::Q_t Q = {
+        T( q * q * dt*dt*dt*dt/4 ), T( q * q * dt*dt*dt/2 ),
+        T( q * q * dt*dt*dt/2    ), T( q * q * dt*dt      ) };
+    const typename Kalman::P_t P = { pinit, 0, 0, pinit };
+
+    // Accuracy and divergence:
+
+    Kalman estim( dt, A, B, H, Q, R, P, { 0, 0 } );
+
+    const bool reference = estimates.empty();
+
+    result res = { 0, 0, 0, 0 };
+
+    for ( int k = 0; k < steps; ++k )
+    {
+        estim.update( { 0 }, { T( trajectory[k].z ) } );
+
+        const double x   = as_double( estim.system_state()(0) );
+        const double var = as_double( estim.estimation_error_covariance()(0,0) );
+
+        const double e = x - trajectory[k].position;
+
+        if ( !res.diverged_at && ( !( std::abs( e ) < 10 * msigma ) || var < 0 ) )
+        {
+            res.diverged_at = k + 1;
+        }
+
+        res.rmse_truth += e * e;
+
+        if ( reference )
+        {
+            estimates.push_back( x );
+        }
+        else
+        {
+            res.rmse_ref += ( x - estimates[k] ) * ( x - estimates[k] );
+        }
+    }
+
+    res.rmse_truth = std::sqrt( res.rmse_truth / steps );
+    res.rmse_ref   = std::sqrt( res.rmse_ref   / steps );
+
+    // Throughput:
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for ( int i = 0; i < repeat; ++i )
+    {
+        Kalman estim( dt, A, B, H, Q, R, P, { 0, 0 } );
+
+        for ( int k = 0; k < steps; ++k )
+        {
+            estim.update( { 0 }, { T( trajectory[k].z ) } );
+        }
+        sink = as_double( estim.system_state()(0) );
+    }
+
+    const auto seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    res.rate = double( repeat ) * steps / seconds;
+
+    return res;
+}
+
+template< typename Kalman >
+void report( char const * name, std::vector<sample> const & trajectory, std::vector<double> & estimates )
+{
+    const auto r = run<Kalman>( trajectory, estimates );
+
+    std::cout
+        << std::left << std::setw(20) << name << std::right
+        << std::setw(12) << r.rmse_truth
+        << std::setw(12) << r.rmse_ref
+        << std::setw(10) << r.diverged_at
+        << std::setw(14) << r.rate << "\n";
+}
+
+int main()
+{
+    const auto trajectory = make_trajectory();
+
+    std::vector<double> estimates;
+
+    std::cout
+        << "kalman<2,1,1>, " << steps << " steps\n"
+        << std::left << std::setw(20) << "estimator" << std::right
+        << std::setw(12) << "rmse-truth"
+        << std::setw(12) << "rmse-ref"
+        << std::setw(10) << "diverged"
+        << std::setw(14) << "updates/s" << "\n";
+
+    report< num::kalman   <double,2,1,1> >( "kalman<double>"   , trajectory, estimates );
+    report< num::kalman_ud<double,2,1,1> >( "kalman_ud<double>", trajectory, estimates );
+    report< num::kalman   <float ,2,1,1> >( "kalman<float>"    , trajectory, estimates );
+    report< num::kalman_ud<float ,2,1,1> >( "kalman_ud<float>" , trajectory, estimates );
+    report< num::kalman   <fp32_t,2,1,1> >( "kalman<fp32>"     , trajectory, estimates );
+    report< num::kalman_ud<fp32_t,2,1,1> >( "kalman_ud<fp32>"  , trajectory, estimates );
+    report< num::kalman   <fp16_t,2,1,1> >( "kalman<fp16>"     , trajectory, estimates );
+    report< num::kalman_ud<fp16_t,2,1,1> >( "kalman_ud<fp16>"  , trajectory, estimates );
+}
+
+// g++ -std=c++17 -Wall -O2 -I../include -o kalman-ud-time.exe kalman-ud-time.cpp && kalman-ud-time.exe
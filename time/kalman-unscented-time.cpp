@@ -0,0 +1,184 @@
+// Copyright 2018 by Martin Moene
+//
+// https://github.com/martinmoene/kalman-estimator
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Desktop: accuracy and throughput of the unscented num::kalman_unscented
+// versus the extended num::kalman_extended on a swinging pendulum, observed
+// through the horizontal position of its bob.
+
+#include "dsp/kalman-extended.hpp"
+#include "dsp/kalman-unscented.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#ifndef KE_UKF_STEPS
+# define KE_UKF_STEPS  2000
+#endif
+
+#ifndef KE_UKF_REPEAT
+# define KE_UKF_REPEAT  200
+#endif
+
+const int steps  = KE_UKF_STEPS;
+const int repeat = KE_UKF_REPEAT;
+
+// Pendulum released at 2.5 rad, far outside the small-angle regime:
+
+const double dt     = 0.01;
+const double g_L    = 9.81;
+const double theta0 = 2.5;
+const double msigma = 0.05;
+
+using dual_t = num::dual<double,2>;
+
+double sin_( double x ) { return std::sin( x ); }
+dual_t sin_( dual_t const & x ) { return chain( x, std::sin( x.value() ), std::cos( x.value() ) ); }
+
+// Process and measurement models for both estimators, state (theta, omega):
+
+struct pendulum
+{
+    template< typename V >
+    num::colvec<V,2> operator()( num::colvec<V,2> const & x, num::colvec<double,1> const & ) const
+    {
+        return { x(0) + dt * x(1), x(1) - dt * g_L * sin_( x(0) ) };
+    }
+};
+
+struct bob_position
+{
+    template< typename V >
+    num::colvec<V,1> operator()( num::colvec<V,2> const & x ) const
+    {
+        return { sin_( x(0) ) };
+    }
+};
+
+using ekf = num::kalman_extended <double,2,1,1,pendulum,bob_position>;
+using ukf = num::kalman_unscented<double,2,1,1,num::pointwise<pendulum>,num::pointwise<bob_position>>;
+
+struct sample
+{
+    double theta;   // True angle
+    double z;       // Measured position
+};
+
+std::vector<sample> make_trajectory()
+{
+    std::vector<sample> result;
+
+    unsigned seed = 12345;
+
+    num::colvec<double,2> x = { theta0, 0 };
+
+    for ( int k = 0; k < steps; ++k )
+    {
+        // Sum of uniforms, approximately normal with unit variance:
+
+        double noise = -6;
+
+        for ( int i = 0; i < 12; ++i )
+        {
+            seed = seed * 1103515245u + 12345u;
+            noise += ( ( seed >> 8 ) & 0xffff ) / 65536.0;
+        }
+
+        x = pendulum()( x, { 0 } );
+
+        result.push_back( { x(0), std::sin( x(0) ) + msigma * noise } );
+    }
+    return result;
+}
+
+// Estimator with initial angle guess off by 0.3 rad:
+
+template< typename Kalman >
+Kalman make_estimator()
+{
+    return Kalman( dt, {}, {}, { 1e-8, 0, 0, 1e-6 }, { msigma * msigma }, { 0.1, 0, 0, 0.1 }, { theta0 - 0.3, 0 } );
+}
+
+// Keep results alive:
+
+volatile double sink;
+
+struct result
+{
+    double rmse;    // RMS error of angle estimate versus true angle
+    double rate;    // Steps per second
+};
+
+template< typename Kalman >
+result run( std::vector<sample> const & trajectory )
+{
+    result res = {};
+
+    // Accuracy:
+
+    auto estim = make_estimator<Kalman>();
+
+    for ( auto const & s : trajectory )
+    {
+        estim.update( { 0 }, { s.z } );
+
+        const double e = estim.system_state()(0) - s.theta;
+        res.rmse += e * e;
+    }
+
+    res.rmse = std::sqrt( res.rmse / steps );
+
+    // Throughput:
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for ( int i = 0; i < repeat; ++i )
+    {
+        auto estim = make_estimator<Kalman>();
+
+        for ( auto const & s : trajectory )
+        {
+            estim.update( { 0 }, { s.z } );
+        }
+        sink = estim.system_state()(0);
+    }
+
+    const auto seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    res.rate = double( repeat ) * steps / seconds;
+
+    return res;
+}
+
+template< typename Kalman >
+void report( char const * name, std::vector<sample> const & trajectory )
+{
+    const auto r = run<Kalman>( trajectory );
+
+    std::cout
+        << std::left << std::setw(20) << name << std::right
+        << std::setw(12) << r.rmse
+        << std::setw(14) << r.rate << "\n";
+}
+
+int main()
+{
+    const auto trajectory = make_trajectory();
+
+    std::cout
+        << "pendulum<2,1,1>, " << steps << " steps\n"
+        << std::left << std::setw(20) << "estimator" << std::right
+        << std::setw(12) << "rmse"
+        << std::setw(14) << "steps/s" << "\n";
+
+    report<ekf>( "kalman_extended" , trajectory );
+    report<ukf>( "kalman_unscented", trajectory );
+}
+
+// g++ -std=c++17 -Wall -O2 -I../include -o kalman-unscented-time.exe kalman-unscented-time.cpp && kalman-unscented-time.exe
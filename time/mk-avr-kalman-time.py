@@ -14,9 +14,10 @@ from __future__ import print_function
 
 import os
 
-num_types     = ('double', 'fp32_t')
+num_types     = ('double', 'fp32_t', 'mixed_t')
 gain_update   = ((1,'updat'), (0,'fixed'))
 optimizations = ('Os', 'O2')
+structures    = ((0,'dense'), (1,'struct'))
 
 std      = 'c++17'
 mcu      = 'atmega328p'
@@ -29,10 +30,11 @@ def remove_ext(path):
 
 basename = remove_ext(filename)
 
-cmd = 'python ../script/avr-gcc.py {verbose} -std={std} -{opt} -mmcu={mcu} -DKE_NUMERIC_TYPE={nt} -DKE_UPDATE_KALMAN_GAIN={update} -I../include --output {outname} {filename}'
+cmd = 'python ../script/avr-gcc.py {verbose} -std={std} -{opt} -mmcu={mcu} -DKE_NUMERIC_TYPE={nt} -DKE_UPDATE_KALMAN_GAIN={update} -DKE_STRUCTURE={structure} -I../include --output {outname} {filename}'
 
 for num_type in num_types:
     for update,text in gain_update:
-        for optimization in optimizations:
-            outname = '{basename}-{nt}-{upd}-{opt}'.format( basename=basename, nt=num_type, upd=text, opt=optimization )
-            os.system( cmd.format(nt=num_type, update=update, opt=optimization, verbose=verbose, std=std, mcu=mcu, fcpu=fcpu, outname=outname, filename=filename) )
+        for structure,stext in structures:
+            for optimization in optimizations:
+                outname = '{basename}-{nt}-{upd}-{st}-{opt}'.format( basename=basename, nt=num_type, upd=text, st=stext, opt=optimization )
+                os.system( cmd.format(nt=num_type, update=update, structure=structure, opt=optimization, verbose=verbose, std=std, mcu=mcu, fcpu=fcpu, outname=outname, filename=filename) )